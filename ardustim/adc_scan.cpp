@@ -0,0 +1,93 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Timer triggered, oversampled ADC scan
+ *
+ * See adc_scan.h
+ */
+
+#include "adc_scan.h"
+#include <Arduino.h>
+#include <avr/interrupt.h>
+
+static uint16_t adcSum[ADC_CHANNELS];
+static uint8_t adcSamples[ADC_CHANNELS];
+static volatile uint16_t adcValue[ADC_CHANNELS];
+static volatile uint8_t adcFresh = 0;     /* Bit per channel, published and not yet taken */
+static uint8_t adcChannel = 0;            /* Channel the conversion in progress is for */
+
+/* ADMUX input of each channel */
+static const uint8_t adc_pins[ADC_CHANNELS] = {
+  0,
+#if ENABLE_WHEEL_SELECT_POT
+  1,
+#endif
+#if ENABLE_CAM_PHASE_POT
+  2,
+#endif
+};
+
+void adc_init()
+{
+  /* Out of range, so the first result is always published */
+  for (uint8_t ch = 0; ch < ADC_CHANNELS; ch++) { adcValue[ch] = 0xFFFF; }
+
+  /* AVcc reference, right adjusted, A0 first */
+  ADMUX = (1 << REFS0);
+
+  /* Digital input buffers off on the scanned pins */
+  for (uint8_t ch = 0; ch < ADC_CHANNELS; ch++) { DIDR0 |= 1 << adc_pins[ch]; }
+
+  /* Auto trigger on Timer0 overflow (ADTS = 100). TIMER0_OVF_vect clears TOV0
+   * for millis(), so every overflow is a fresh rising edge */
+  ADCSRB = (ADCSRB & ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0))) | (1 << ADTS2);
+
+  /* 16MHz / 128 = 125kHz, above 200kHz 10-bit results are not reliable */
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+}
+
+bool adc_take(uint8_t channel, uint16_t *value)
+{
+  uint8_t bit = 1 << channel;
+  bool fresh;
+
+  noInterrupts();
+  fresh = adcFresh & bit;
+  if (fresh)
+  {
+    *value = adcValue[channel];
+    adcFresh &= ~bit;
+  }
+  interrupts();
+  return fresh;
+}
+
+//! Accumulates one conversion and points the multiplexer at the next channel
+/*!
+ * The next conversion starts on the next Timer0 overflow, a millisecond
+ * away, so the channel switch has long settled by then
+ */
+ISR(ADC_vect)
+{
+  uint8_t ch = adcChannel;
+
+  adcSum[ch] += ADC;
+  if (++adcSamples[ch] >= ADC_OVERSAMPLE)
+  {
+    uint16_t result = adcSum[ch] >> 2;
+    uint16_t last = adcValue[ch];
+
+    if ((result >= last + ADC_HYSTERESIS) || (result + ADC_HYSTERESIS <= last))
+    {
+      adcValue[ch] = result;
+      adcFresh |= 1 << ch;
+    }
+    adcSum[ch] = 0;
+    adcSamples[ch] = 0;
+  }
+
+#if ADC_CHANNELS > 1
+  if (++ch >= ADC_CHANNELS) { ch = 0; }
+  adcChannel = ch;
+  ADMUX = (ADMUX & 0xF0) | adc_pins[ch];
+#endif
+}
@@ -0,0 +1,57 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Timer triggered, oversampled ADC scan
+ *
+ * The ADC is auto-triggered by the Timer0 overflow that already runs millis(),
+ * one conversion every 1.024ms (~977/s instead of 9600/s free running). Each
+ * conversion interrupt adds the sample to its channel's sum and moves the
+ * multiplexer on to the next channel, round robin, ready for the next trigger.
+ *
+ * ADC_OVERSAMPLE samples per channel are summed and shifted down to one
+ * ADC_BITS value (oversampling and decimation; pot wiper noise provides the
+ * dither). A value is only published when it has moved ADC_HYSTERESIS or
+ * more from the last one, so loop() sees a handful of updates a second from
+ * a pot that isn't being turned, and none of the filtering.
+ */
+#ifndef __ADC_SCAN_H__
+#define __ADC_SCAN_H__
+
+#include <stdint.h>
+
+#ifndef ENABLE_WHEEL_SELECT_POT
+#define ENABLE_WHEEL_SELECT_POT 0  // Default to disabled, a pot on A1 selects the wheel
+#endif
+
+#ifndef ENABLE_CAM_PHASE_POT
+#define ENABLE_CAM_PHASE_POT 0  // Default to disabled, a pot on A2 sets the cam phase
+#endif
+
+/* Scanned channels, in scan order, each on its own pin (adc_pins[]) */
+enum {
+  ADC_RPM_POT,          /* A0, RPM in POT mode */
+#if ENABLE_WHEEL_SELECT_POT
+  ADC_WHEEL_POT,        /* A1, wheel select */
+#endif
+#if ENABLE_CAM_PHASE_POT
+  ADC_CAM_POT,          /* A2, cam phase */
+#endif
+  ADC_CHANNELS
+};
+
+#define ADC_OVERSAMPLE  16    /* Samples per result, 4^2 for 2 extra bits */
+#define ADC_BITS        12
+#define ADC_FULL_SCALE  (1023 * (ADC_OVERSAMPLE >> 2))  /* Sum of 16 10-bit samples >> 2 */
+#define ADC_HYSTERESIS  4     /* Counts of ADC_FULL_SCALE a result must move to be published */
+
+//! Sets up the ADC for Timer0 overflow triggering, conversions start by themselves
+void adc_init();
+
+//! Takes channel's latest result if it changed since the last call
+/*!
+ * @param channel ADC_RPM_POT etc
+ * @param value Set to the result, 0..ADC_FULL_SCALE
+ * @return false if nothing new was published
+ */
+bool adc_take(uint8_t channel, uint16_t *value);
+
+#endif
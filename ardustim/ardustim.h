@@ -23,12 +23,16 @@
 
 #include <stdint.h>
 #include <Arduino.h>
+#include "timer_math.h"
 
 /* Prototypes */
 void reset_new_OCR1A(uint32_t);
 uint8_t get_bitshift_from_prescaler(uint8_t *);
-void get_prescaler_bits(uint32_t *, uint8_t *, uint8_t *);
 void setRPM(uint16_t);
+void updateMaxRPM();
+void load_wheel();
+uint16_t getISRCycles();
+void resetISRCycles();
 uint16_t calculateCompressionModifier();
 uint16_t calculateCurrentCrankAngle();
 
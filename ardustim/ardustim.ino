@@ -25,6 +25,21 @@
 #include "comms.h"
 #include "storage.h"
 #include "wheel_defs.h"
+#include "wheel_table.h"
+#include "wheel_gen.h"
+#include "cam_phase.h"
+#include "direction.h"
+#include "fault.h"
+#include "knock.h"
+#include "aux_out.h"
+#include "capture.h"
+#include "learn.h"
+#include "timer_math.h"
+#include "isr_jitter.h"
+#include "loop_profiler.h"
+#include "scheduler.h"
+#include "string_pool.h"
+#include "adc_scan.h"
 #include <avr/pgmspace.h>
 #include <EEPROM.h>
 
@@ -36,28 +51,33 @@
 #include "ui_controller.h"
 #include "lcd_manager.h"
 #include "button_manager.h"
+#if LCD_DRIVER == LCD_DRIVER_TWI
+#include "twi_lcd_display.h"
+#else
 #include "lcd_display.h"
 #endif
+#endif
 
 struct configTable config;
 struct status currentStatus;
+struct boot_status bootStatus;
+wheels activeWheel;
 
 #if ENABLE_LCD_INTERFACE
 /* LCD Interface Components */
+#if LCD_DRIVER == LCD_DRIVER_TWI
+TwiLcdDisplay lcdDisplay;
+#else
 LCDDisplay lcdDisplay;
+#endif
 LCDManager lcdManager;
 ButtonManager buttonManager;
 UIController uiController;
 #endif
 
 /* Sensistive stuff used in ISR's */
-volatile uint16_t adc0; /* POT RPM */
-volatile uint16_t adc1; /* Pot Wheel select */
 /* Setting rpm to any value over 0 will enabled sweeping by default */
 /* Stuff for handling prescaler changes (small tooth wheels are low RPM) */
-volatile uint8_t analog_port = 0;
-volatile bool adc0_read_complete = false;
-volatile bool adc1_read_complete = false;
 volatile bool reset_prescaler = false;
 volatile uint8_t output_invert_mask = 0x00; /* Don't invert anything */
 volatile uint8_t prescaler_bits = 0;
@@ -66,12 +86,48 @@ volatile uint16_t new_OCR1A = 5000; /* sane default */
 volatile uint16_t edge_counter = 0;
 volatile uint32_t cycleStartTime = micros();
 volatile uint32_t cycleDuration = 0;
+volatile uint16_t isr_cycles_max = 0; /* Worst pattern ISR cost seen at prescaler 1, 0 = not measured yet */
+uint16_t isr_cycles_used = 0; /* ISR cost currentStatus.max_rpm was derived from */
 uint32_t sweep_time_counter = 0;
 uint8_t sweep_direction = ASCENDING;
 
 /* Less sensitive globals */
 uint8_t bitshift = 0;
 
+/* loop() tasks, highest priority first, see scheduler.h */
+const char rpm_task_label[] PROGMEM = "rpm";
+const char serial_task_label[] PROGMEM = "serial";
+const char cam_task_label[] PROGMEM = "cam";
+const char fault_task_label[] PROGMEM = "fault";
+const char aux_task_label[] PROGMEM = "aux";
+#if ENABLE_CAPTURE
+const char capture_task_label[] PROGMEM = "capture";
+#endif
+#if ENABLE_LEARN
+const char learn_task_label[] PROGMEM = "learn";
+#endif
+#if ENABLE_LCD_INTERFACE
+const char ui_task_label[] PROGMEM = "ui";
+const char lcd_task_label[] PROGMEM = "lcd";
+#endif
+struct task tasks[] = {
+  TASK(rpmTask, rpm_task_label, 0, 200),
+  TASK(serialTask, serial_task_label, 0, 1000),
+  TASK(cam_phase_task, cam_task_label, 1, 200),
+  TASK(fault_task, fault_task_label, 1, 300),
+  TASK(aux_task, aux_task_label, AUX_TASK_MS, 200),
+#if ENABLE_CAPTURE
+  TASK(capture_task, capture_task_label, 0, 500),
+#endif
+#if ENABLE_LEARN
+  TASK(learn_task, learn_task_label, 0, 500), /* Overruns once per learned wheel, the analysis */
+#endif
+#if ENABLE_LCD_INTERFACE
+  TASK(uiTask, ui_task_label, 5, 300),
+  TASK(lcdTask, lcd_task_label, 0, 5000),
+#endif
+};
+
 #if ENABLE_LCD_INTERFACE
 /* Startup sequence variables */
 bool startupSequenceActive = false;
@@ -80,71 +136,18 @@ uint32_t startupSequenceTimer = 0;
 uint8_t loadingDots = 0;  // For animated loading dots
 #endif
 
-
-
-
-wheels Wheels[MAX_WHEELS] = {
-   /* Pointer to friendly name string, pointer to edge array, RPM Scaler, Number of edges in the array, whether the number of edges covers 360 or 720 degrees */
-  { dizzy_four_cylinder_friendly_name, dizzy_four_cylinder, 0.03333, 4, 360 },
-  { dizzy_six_cylinder_friendly_name, dizzy_six_cylinder, 0.05, 6, 360 },
-  { dizzy_eight_cylinder_friendly_name, dizzy_eight_cylinder, 0.06667, 8, 360 },
-  { sixty_minus_two_friendly_name, sixty_minus_two, 1.0, 120, 360 },
-  { sixty_minus_two_with_cam_friendly_name, sixty_minus_two_with_cam, 1.0, 240, 720 },
-  { sixty_minus_two_with_halfmoon_cam_friendly_name, sixty_minus_two_with_halfmoon_cam, 1.0, 240, 720 },
-  { thirty_six_minus_one_friendly_name, thirty_six_minus_one, 0.6, 72, 360 },
-  { twenty_four_minus_one_friendly_name, twenty_four_minus_one, 0.5, 48, 360 },
-  { four_minus_one_with_cam_friendly_name, four_minus_one_with_cam, 0.06667, 16, 720 },
-  { eight_minus_one_friendly_name, eight_minus_one, 0.13333, 16, 360 },
-  { six_minus_one_with_cam_friendly_name, six_minus_one_with_cam, 0.15, 36, 720 },
-  { twelve_minus_one_with_cam_friendly_name, twelve_minus_one_with_cam, 0.6, 144, 720 },
-  { fourty_minus_one_friendly_name, fourty_minus_one, 0.66667, 80, 360 },
-  { dizzy_four_trigger_return_friendly_name, dizzy_four_trigger_return, 0.03333, 4, 360 },
-  { oddfire_vr_friendly_name, oddfire_vr, 0.03333, 4, 360 },
-  { optispark_lt1_friendly_name, optispark_lt1, 3.0, 720, 720 },
-  { twelve_minus_three_friendly_name, twelve_minus_three, 0.15, 18, 360 },
-  { thirty_six_minus_two_two_two_friendly_name, thirty_six_minus_two_two_two, 0.6, 72, 360 },
-  { thirty_six_minus_two_two_two_h6_friendly_name, thirty_six_minus_two_two_two_h6, 0.6, 72, 360 },
-  { thirty_six_minus_two_two_two_with_cam_friendly_name, thirty_six_minus_two_two_two_with_cam, 0.6, 144, 720 },
-  { fourty_two_hundred_wheel_friendly_name, fourty_two_hundred_wheel, 0.66667, 80, 360 },
-  { thirty_six_minus_one_with_cam_fe3_friendly_name, thirty_six_minus_one_with_cam_fe3, 0.6, 144, 720 },
-  { six_g_seventy_two_with_cam_friendly_name, six_g_seventy_two_with_cam, 1.0, 240, 720 },
-  { buell_oddfire_cam_friendly_name, buell_oddfire_cam, 0.03333, 4, 360 },
-  { gm_ls1_crank_and_cam_friendly_name, gm_ls1_crank_and_cam, 6.0, 720, 720 },
-  { gm_ls_58X_crank_and_4x_cam_friendly_name, GM_LS_58X_crank_and_4x_cam, 1.0, 240, 720},
-  { lotus_thirty_six_minus_one_one_one_one_friendly_name, lotus_thirty_six_minus_one_one_one_one, 0.6, 144, 720 },
-  { honda_rc51_with_cam_friendly_name, honda_rc51_with_cam, 0.6, 144, 720 },
-  { thirty_six_minus_one_with_second_trigger_friendly_name, thirty_six_minus_one_with_second_trigger, 0.6, 144, 720 },
-  { weber_iaw_with_cam_friendly_name, weber_iaw_with_cam, 0.6, 144, 720 },
-  { fiat_one_point_eight_sixteen_valve_with_cam_friendly_name, fiat_one_point_eight_sixteen_valve_with_cam, 0.6, 144, 720 },
-  { three_sixty_nissan_cas_friendly_name, three_sixty_nissan_cas, 3.0, 720, 720 },
-  { twenty_four_minus_two_with_second_trigger_friendly_name, twenty_four_minus_two_with_second_trigger, 0.5, 120, 720 },
-  { yamaha_eight_tooth_with_cam_friendly_name, yamaha_eight_tooth_with_cam, 0.13333, 32, 720 },
-  { mitsubishi_4g63_4_2_friendly_name, mitsubishi_4g63_4_2, 0.6, 144, 720 },
-  { audi_135_with_cam_friendly_name, audi_135_with_cam, 2.25, 540, 720 },
-  { honda_d17_no_cam_friendly_name, honda_d17_no_cam, 0.6, 144, 720 },
-  { daihatsu_3cyl_friendly_name, daihatsu_3cyl, 0.03333, 4, 360 },
-  { miata_9905_friendly_name, miata_9905, 0.6, 144, 720 },
-  { twelve_with_cam_friendly_name, twelve_with_cam, 0.2, 48, 720 },
-  { twenty_four_with_cam_friendly_name, twenty_four_with_cam, 0.4, 96, 720 },
-  { subaru_six_seven_name_friendly_name, subaru_six_seven, 3.0, 720, 720 },
-  { gm_seven_x_friendly_name, gm_seven_x, 1.502, 180, 720 },
-  { four_twenty_a_friendly_name, four_twenty_a, 0.6, 144, 720 },
-  { ford_st170_friendly_name, ford_st170, 3.0, 720, 720 },
-  { mitsubishi_3A92_friendly_name, mitsubishi_3A92, 0.05, 12, 720 },
-  { Toyota_4AGE_CAS_friendly_name, toyota_4AGE_CAS, 0.333, 144, 720 },
-  { Toyota_4AGZE_friendly_name, toyota_4AGZE, 0.4, 96, 720 },
-  { Suzuki_DRZ400_friendly_name, suzuki_DRZ400, 0.6, 72, 360},
-  { Jeep_2000_4cyl_friendly_name, jeep_2000_4cyl, 1.5, 360, 720},
-  { VIPER9602_friendly_name, viper9602wheel, 1.0, 240, 720},
-  { thirty_six_minus_two_with_second_trigger_friendly_name, thirty_six_minus_two_with_second_trigger, 0.6, 144, 720 },
-  { GM_40_Tooth_Trans_OSS_friendly_name, GM40toothOSS, 0.66667, 80, 360 },
-};
-
 /* Initialization */
 void setup() {
   loadConfig();
+  load_wheel();
   serialSetup();
 
+  /* Work out the configured RPM's compare value first so the very first
+   * edges are already at the right speed */
+  updateMaxRPM();
+  reset_new_OCR1A(currentStatus.rpm);
+  reset_prescaler = false;
+
   cli(); // stop interrupts
 
   /* Configuring TIMER1 (pattern generator) */
@@ -153,77 +156,42 @@ void setup() {
   TCCR1B = 0;
   TCNT1 = 0;
 
-  // Set compare register to sane default
-  OCR1A = 1000;  /* 8000 RPM (60-2) */
+  // Set compare register for the configured RPM
+  OCR1A = new_OCR1A;
 
   // Turn on CTC mode
   TCCR1B |= (1 << WGM12); // Normal mode (not PWM)
-  // Set prescaler to 1
-  TCCR1B |= (1 << CS10); /* Prescaler of 1 */
+  // Set the prescaler that goes with it
+  TCCR1B |= prescaler_bits;
   // Enable output compare interrupt for timer channel 1 (16 bit)
   TIMSK1 |= (1 << OCIE1A);
+  // One shot COMPB on the same compare timestamps the first edge
+  OCR1B = OCR1A;
+  TIFR1 = (1 << OCF1B);
+  TIMSK1 |= (1 << OCIE1B);
 
-  // Set timer2 to run sweeper routine
-  TCCR2A = 0;
-  TCCR2B = 0;
-  TCNT2 = 0;
-
-  // Set compare register to sane default
-  OCR2A = 249;  /* With prescale of x64 gives 1ms tick */
+  /* Timer2 makes the knock tone on OC2A (pin 11), see knock.h */
+  knock_init();
 
-  // Turn on CTC mode
-  TCCR2A |= (1 << WGM21); // Normal mode (not PWM)
-  // Set prescaler to x64
-  TCCR2B |= (1 << CS22); /* Prescaler of 64 */
-  // Enable output compare interrupt for timer channel 2
-  //TIMSK2 |= (1 << OCIE2A); //Disabled as no longer using TIMER2 for sweep
+  /* Pots, sampled on every Timer0 overflow, see adc_scan.h */
+  adc_init();
 
+#if ENABLE_CAPTURE
+  /* Spark and injector inputs on A3 and D7, off until 'E', see capture.h */
+  capture_init();
+#endif
 
-  /* Configure ADC as per http://www.glennsweeney.com/tutorials/interrupt-driven-analog-conversion-with-an-atmega328p */
-  // clear ADLAR in ADMUX (0x7C) to right-adjust the result
-  // ADCL will contain lower 8 bits, ADCH upper 2 (in last two bits)
-  ADMUX &= B11011111;
-  
-  // Set REFS1..0 in ADMUX (0x7C) to change reference voltage to the
-  // proper source (01)
-  ADMUX |= B01000000;
-  
-  // Clear MUX3..0 in ADMUX (0x7C) in preparation for setting the analog
-  // input
-  ADMUX &= B11110000;
-  
-  // Set MUX3..0 in ADMUX (0x7C) to read from AD8 (Internal temp)
-  // Do not set above 15! You will overrun other parts of ADMUX. A full
-  // list of possible inputs is available in Table 24-4 of the ATMega328
-  // datasheet
-  // ADMUX |= 8;
-  // ADMUX |= B00001000; // Binary equivalent
-  
-  // Set ADEN in ADCSRA (0x7A) to enable the ADC.
-  // Note, this instruction takes 12 ADC clocks to execute
-  ADCSRA |= B10000000;
-  
-  // Set ADATE in ADCSRA (0x7A) to enable auto-triggering.
-  ADCSRA |= B00100000;
-  
-  // Clear ADTS2..0 in ADCSRB (0x7B) to set trigger mode to free running.
-  // This means that as soon as an ADC has finished, the next will be
-  // immediately started.
-  ADCSRB &= B11111000;
-  
-  // Set the Prescaler to 128 (16000KHz/128 = 125KHz)
-  // Above 200KHz 10-bit results are not reliable.
-  ADCSRA |= B00000111;
-  
-  // Set ADIE in ADCSRA (0x7A) to enable the ADC interrupt.
-  // Without this, the internal interrupt will not trigger.
-  ADCSRA |= B00001000;
+#if ENABLE_LEARN
+  /* Crank and cam learn inputs on D7 and A3, off until 'U', see learn.h */
+  learn_init();
+#endif
 
 //  pinMode(7, OUTPUT); /* Debug pin for Saleae to track sweep ISR execution speed */
   pinMode(8, OUTPUT); /* Primary (crank usually) output */
   pinMode(9, OUTPUT); /* Secondary (cam1 usually) output */
   pinMode(10, OUTPUT); /* Tertiary (cam2 usually) output */
-  pinMode(11, OUTPUT); /* Knock signal for seank, ony on LS1 pattern, NOT IMPL YET */
+  pinMode(11, OUTPUT); /* Knock signal, Timer2 tone gated into crank angle windows, or VSS */
+  pinMode(12, OUTPUT); /* Tach, see aux_out.h */
 #if defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
   pinMode(53, OUTPUT); /* crank */
   pinMode(52, OUTPUT); /* cam 1 */
@@ -238,61 +206,56 @@ void setup() {
   buttonManager.init();
   
   // Initialize LCD display with error handling
-  bool lcdInitialized = lcdDisplay.init();
+  bool lcdInitialized = false;
+  if (bootStatus.mode == BOOT_FAST) {
+    // Don't wait for the LCD's power up and init, it comes up in the background
+    lcdDisplay.start();
+  } else {
+    lcdInitialized = lcdDisplay.init();
+  }
+  
+  // Managers run either way, a missing LCD is re-probed in the background
+  // and picks up the main screen when it's plugged in
+  lcdManager.init(&lcdDisplay);
+  uiController.init(&buttonManager, &lcdManager);
   if (lcdInitialized) {
-    // LCD hardware is available, initialize managers
-    lcdManager.init(&lcdDisplay);
-    uiController.init(&buttonManager, &lcdManager);
-    
     // Start non-blocking startup sequence
     lcdManager.enterStartupMode();
     startupSequenceState = 0;
     startupSequenceTimer = millis();
     startupSequenceActive = true;
   } else {
-    // LCD initialization failed - system continues with serial interface only
-    // Log error to serial (will be available after serialSetup())
-    // Note: Serial output will show this after setup() completes
+    // Fast boot, or LCD not answering - buttons and serial still work
     startupSequenceActive = false;
   }
 #endif
-  // Set ADSC in ADCSRA (0x7A) to start the ADC conversion
-  ADCSRA |= B01000000;
-  /* Make sure we are using the DEFAULT RPM on startup */
-  reset_new_OCR1A(currentStatus.rpm); 
+  scheduler_init(tasks, sizeof(tasks) / sizeof(tasks[0]));
+  bootStatus.setup_us = micros();
 
 } // End setup
 
 
-//! ADC ISR for alternating between ADC pins 0 and 1
+//! Writes a delayed cam transition, or timestamps the first pattern edge
 /*!
- * Reads ADC ports 0 and 1 alternately. Port 0 is RPM, Port 1 is for
- * future fun (possible wheel selection)
+ * Armed by cam_phase_edge() a fraction of an edge after TIMER1_COMPA_vect
+ * for an offset cam, one shot either way.
+ * At boot OCR1B is set equal to OCR1A so this fires on the same compare
+ * match, straight after TIMER1_COMPA_vect (higher priority) has written the
+ * edge.
  */
-ISR(ADC_vect){
-  if (analog_port == 0)
+ISR(TIMER1_COMPB_vect)
+{
+  TIMSK1 &= ~(1 << OCIE1B);
+  if (cam_pending)
   {
-    adc0 = ADCL | (ADCH << 8);
-	  adc0_read_complete = true;
-    /* Flip to channel 1 */
-    //ADMUX |= B00000001;
-    //analog_port = 1;
-    /* Trigger another conversion */
-    //ADCSRA |= B01000000;
+    uint8_t cam = cam_next;
+    if (GPIOR0 & (1 << FAULT_BIT)) { cam &= fault_play->states_mask; } /* Blanked cam, see fault.h */
+    PORTB = (PORTB & ~CAM_PINS) | ((output_invert_mask ^ cam) & CAM_PINS);
+    cam_out = cam_next;
+    cam_pending = false;
     return;
-  } 
-//  if (analog_port == 1)
-//  {
-//    adc1 = ADCL | (ADCH << 8);
-//	adc1_read_complete = true;
-//    /* Flip to channel 0 */
-//    /* Tell it to read ADC0, clear MUX0..3 */
-//    ADMUX &= B11110000;
-//    analog_port = 0;
-//    /* Trigger another conversion */
-//    ADCSRA |= B01000000;
-//    return;
-//  }
+  }
+  if (!bootStatus.first_edge_us) { bootStatus.first_edge_us = micros(); }
 }
 
 /* Pumps the pattern out of flash to the port 
@@ -300,17 +263,40 @@ ISR(ADC_vect){
  */
 ISR(TIMER1_COMPA_vect) 
 {
+  uint16_t isr_entry = TCNT1; /* Before anything else, the entry lateness and the start of the self timing */
+#if ENABLE_ISR_JITTER
+  jitter_record(isr_entry);
+#endif
   /* This is VERY simple, just walk the array and wrap when we hit the limit */
-  PORTB = output_invert_mask ^ pgm_read_byte(&Wheels[config.wheel].edge_states_ptr[edge_counter]);   /* Write it to the port */
+  uint16_t ocr = new_OCR1A;
+  uint8_t states = active_edge_state(edge_counter);
+  if (GPIOR0 & (1 << CAM_PHASE_BIT)) /* Offset cam, see cam_phase.h */
+  {
+    states = (GPIOR0 & (1 << DIRECTION_BIT)) ? cam_phase_edge_reverse(states, ocr) : cam_phase_edge(states, ocr);
+  }
+  if (GPIOR0 & (1 << FAULT_BIT)) /* Injected faults, see fault.h */
+  {
+    states = fault_edge(states);
+    ocr = fault_period(ocr);
+  }
+  if (GPIOR0 & (1 << TACH_BIT)) { states |= tach_edge(); } /* Tach on PB4, see aux_out.h */
+  PORTB = output_invert_mask ^ states;   /* Write it to the port */
+  if (GPIOR0 & (1 << KNOCK_BIT)) { knock_edge(); } /* Knock window gate, see knock.h */
   
-  edge_counter++;
-  if (edge_counter == Wheels[config.wheel].wheel_max_edges) 
+  if (GPIOR0 & (1 << DIRECTION_BIT)) { direction_edge(states); } /* Backwards, see direction.h */
+  else
   {
-    edge_counter = 0;
-    cycleDuration = micros() - cycleStartTime;
-    cycleStartTime = micros();
+    edge_counter++;
+    if (edge_counter == activeWheel.wheel_max_edges) 
+    {
+      edge_counter = 0;
+      cycleDuration = micros() - cycleStartTime;
+      cycleStartTime = micros();
+      if (GPIOR0 & (1 << FAULT_BIT)) { fault_cycle(); }
+    }
   }
-  /* The tables are in flash so we need pgm_read_byte() */
+  /* The tables are packed in flash, wheel_edge_state() unpacks with pgm_read_byte().
+   * GENERATED_WHEEL is a plain RAM read instead, see wheel_gen.h */
 
   /* Reset Prescaler only if flag is set */
   if (reset_prescaler)
@@ -319,8 +305,26 @@ ISR(TIMER1_COMPA_vect)
     TCCR1B |= prescaler_bits;
     reset_prescaler = false;
   }
+  else if ((TCCR1B & ((1 << CS10) | (1 << CS11) | (1 << CS12))) == PRESCALE_1)
+  {
+    /* Reset next compare value for RPM changes */
+    OCR1A = ocr;
+    /* Self timing: at prescaler 1 TCNT1 counts CPU cycles, the body is the
+     * count since the read at entry. The fixed entry and exit costs are added
+     * rather than the entry lateness, another ISR holding this one off once
+     * would otherwise lower every wheel's limit for good. Skipped when the
+     * prescaler was just changed, or if the body ran past the next match.
+     */
+    uint16_t isr_now = TCNT1;
+    if (isr_now >= isr_entry)
+    {
+      uint16_t isr_cycles = (isr_now - isr_entry) + ISR_ENTRY_CYCLES + ISR_EXIT_CYCLES;
+      if (isr_cycles > isr_cycles_max) { isr_cycles_max = isr_cycles; }
+    }
+    return;
+  }
   /* Reset next compare value for RPM changes */
-  OCR1A = new_OCR1A;  /* Apply new "RPM" from Timer2 ISR, i.e. speed up/down the virtual "wheel" */
+  OCR1A = ocr;  /* Apply new "RPM" from Timer2 ISR, i.e. speed up/down the virtual "wheel" */
 }
 
 #if ENABLE_LCD_INTERFACE
@@ -397,15 +401,12 @@ void handleStartupSequence() {
  * Show animated welcome screen
  */
 void showWelcomeScreen() {
-  lcdManager.showStartupMessage("* ARDU-STIM v3.0 *");
+  lcdManager.showStartupMessage(STR_TITLE);
   
   // Add decorative elements on other lines
-  lcdDisplay.setCursor(0, 0);
-  lcdDisplay.print("====================");
-  lcdDisplay.setCursor(0, 2);
-  lcdDisplay.print("  Engine Simulator   ");
-  lcdDisplay.setCursor(0, 3);
-  lcdDisplay.print("====================");
+  lcdManager.drawString(0, 0, STR_RULE);
+  lcdManager.drawString(0, 2, STR_SUBTITLE);
+  lcdManager.drawString(0, 3, STR_RULE);
 }
 
 /**
@@ -413,6 +414,7 @@ void showWelcomeScreen() {
  */
 void showLoadingProgress(uint32_t elapsed) {
   static uint8_t lastProgress = 0;
+  char buffer[21];
   
   // Calculate progress (0-18 characters to fit in brackets)
   uint8_t progress = (elapsed * 18) / 2500;
@@ -422,27 +424,19 @@ void showLoadingProgress(uint32_t elapsed) {
   if (progress != lastProgress) {
     lastProgress = progress;
     
-    lcdDisplay.clear();
-    lcdDisplay.setCursor(0, 0);
-    lcdDisplay.print("   Loading System    ");
+    lcdManager.clearScreen();
+    lcdManager.drawString(0, 0, STR_LOADING);
     
     // Progress bar on line 2
-    lcdDisplay.setCursor(0, 2);
-    lcdDisplay.print("[");
+    lcdManager.drawText(0, 2, "[");
     for (uint8_t i = 0; i < 18; i++) {
-      if (i < progress) {
-        lcdDisplay.print("=");
-      } else {
-        lcdDisplay.print(" ");
-      }
+      lcdManager.drawText(i + 1, 2, (i < progress) ? "=" : " ");
     }
-    lcdDisplay.print("]");
+    lcdManager.drawText(19, 2, "]");
     
     // Percentage and static "Complete" text on line 3
-    lcdDisplay.setCursor(0, 3);
-    lcdDisplay.print("     ");
-    lcdDisplay.print((progress * 100) / 18);
-    lcdDisplay.print("% Complete");
+    snprintf_P(buffer, sizeof(buffer), PSTR("     %u%% Complete"), (progress * 100) / 18);
+    lcdManager.drawText(0, 3, buffer);
   }
 }
 
@@ -459,24 +453,22 @@ void showSystemChecks(uint32_t elapsed) {
   if (currentCheck != lastCheck) {
     lastCheck = currentCheck;
     
-    lcdDisplay.clear();
-    lcdDisplay.setCursor(0, 0);
-    lcdDisplay.print("  System Checks     ");
+    lcdManager.clearScreen();
+    lcdManager.drawString(0, 0, STR_CHECKS);
     
     // Check items
-    const char* checks[] = {
-      "Timer Hardware",
-      "ADC System",
-      "Pattern Memory",
-      "LCD Display",
-      "User Interface"
+    static const uint8_t checks[] PROGMEM = {
+      STR_CHECK_TIMER,
+      STR_CHECK_ADC,
+      STR_CHECK_PATTERN,
+      STR_CHECK_LCD,
+      STR_CHECK_UI
     };
     
     for (uint8_t i = 0; i < 5 && i <= currentCheck; i++) {
       if (i < 3) {  // Only show 3 checks to fit on screen
-        lcdDisplay.setCursor(0, i + 1);
-        lcdDisplay.print(checks[i]);
-        lcdDisplay.print(" [OK]");
+        uint8_t len = lcdManager.drawString(0, i + 1, (StringId)pgm_read_byte(&checks[i]));
+        lcdManager.drawString(len, i + 1, STR_CHECK_OK);
       }
     }
   }
@@ -495,20 +487,11 @@ void showFeatureShowcase(uint32_t elapsed) {
   if (currentFeature != lastFeature) {
     lastFeature = currentFeature;
     
-    lcdDisplay.clear();
-    lcdDisplay.setCursor(0, 0);
-    lcdDisplay.print("    Features        ");
+    lcdManager.clearScreen();
+    lcdManager.drawString(0, 0, STR_FEATURES);
     
-    const char* features[] = {
-      "30+ Wheel Patterns",
-      "RPM: 0-9000",
-      "3 Control Modes",
-      "LCD + Serial UI"
-    };
-    
-    lcdDisplay.setCursor(0, 2);
-    lcdDisplay.print("* ");
-    lcdDisplay.print(features[currentFeature]);
+    lcdManager.drawText(0, 2, "* ");
+    lcdManager.drawString(2, 2, (StringId)(STR_FEATURE_WHEELS + currentFeature));
   }
 }
 
@@ -516,64 +499,77 @@ void showFeatureShowcase(uint32_t elapsed) {
  * Show ready screen
  */
 void showReadyScreen() {
-  lcdDisplay.clear();
-  lcdDisplay.setCursor(0, 0);
-  lcdDisplay.print("********************");
-  lcdDisplay.setCursor(0, 1);
-  lcdDisplay.print("*  SYSTEM READY!   *");
-  lcdDisplay.setCursor(0, 2);
-  lcdDisplay.print("*   Let's Start!   *");
-  lcdDisplay.setCursor(0, 3);
-  lcdDisplay.print("********************");
+  lcdManager.clearScreen();
+  lcdManager.drawString(0, 0, STR_READY_BORDER);
+  lcdManager.drawString(0, 1, STR_READY_LINE1);
+  lcdManager.drawString(0, 2, STR_READY_LINE2);
+  lcdManager.drawString(0, 3, STR_READY_BORDER);
 }
 #endif
 
 void loop() 
+{
+  PROF_PASS_BEGIN();
+  scheduler_run();
+  PROF_PASS_END();
+}
+
+//! RPM task: pot/sweep/fixed RPM, compression and the Timer1 reload
+/*!
+ * Highest priority, runs every pass and is never deferred. Each run charges
+ * all four of its profiler stages, the pots to AD and the mode's RPM step to SW
+ */
+bool rpmTask()
 {
   uint16_t tmp_rpm = currentStatus.base_rpm;
-  /* Just handle the Serial UI, everything else is in 
-   * interrupt handlers or callbacks from SerialUI.
-   */
-  if(Serial.available() > 0) { commandParser(); }
 
-#if ENABLE_LCD_INTERFACE
-  /* Handle startup sequence first */
-  handleStartupSequence();
-  
-  /* Update LCD Interface - non-blocking operations only */
-  uiController.update();
-  lcdManager.update();
+#if ENABLE_WHEEL_SELECT_POT
+  uint16_t wheel_pot;
+  if (adc_take(ADC_WHEEL_POT, &wheel_pot))
+  {
+    /* The pot is split into MAX_WHEELS bands and only moving into another
+     * band changes the wheel, so a wheel picked over serial or with the
+     * buttons stays until the pot is turned */
+    static uint8_t pot_wheel = 0xFF;
+    uint8_t wheel = ((uint32_t)wheel_pot * MAX_WHEELS) / (ADC_FULL_SCALE + 1);
+    if (wheel != pot_wheel)
+    {
+      pot_wheel = wheel;
+      if (wheel != config.wheel)
+      {
+        config.wheel = wheel;
+        display_new_wheel();
+      }
+    }
+  }
+#endif
+
+#if ENABLE_CAM_PHASE_POT
+  uint16_t cam_pot;
+  if (adc_take(ADC_CAM_POT, &cam_pot))
+  {
+    /* Centred is no offset, the ends +-CAM_POT_RANGE, reached at the current slew rate */
+    cam_phase_set(((int32_t)cam_pot * 2 * CAM_POT_RANGE) / ADC_FULL_SCALE - CAM_POT_RANGE, cam_phase_slew());
+  }
 #endif
 
   if(config.mode == POT_RPM)
   {
-    if (adc0_read_complete == true)
+    uint16_t pot;
+    if (adc_take(ADC_RPM_POT, &pot))
     {
-      adc0_read_complete = false;
-      
-      // More aggressive exponential moving average for better noise reduction
-      static uint16_t smoothedADC = 0;
-      static bool firstRead = true;
-      
-      // Initialize on first read
-      if (firstRead) {
-        smoothedADC = adc0;
-        firstRead = false;
-      } else {
-        // More aggressive exponential moving average (alpha = 0.1 for much smoother filtering)
-        // This gives 90% weight to previous value, 10% to new reading
-        smoothedADC = (smoothedADC * 9 + adc0) / 10;
-      }
-      
-      // Improved potentiometer scaling with deadband at low end
-      if (smoothedADC < 10) {
-        tmp_rpm = 0;  // Allow 0 RPM for very low pot values
+      // Already oversampled and held steady by the hysteresis in the ADC ISR
+      // Deadband at the low end allows 0 RPM
+      if (pot < ADC_FULL_SCALE / 100) {
+        tmp_rpm = 0;
       } else {
-        tmp_rpm = ((uint32_t)smoothedADC * TMP_RPM_CAP) / 1023;  // Linear scaling 0-9000 RPM
+        tmp_rpm = ((uint32_t)pot * TMP_RPM_CAP) / ADC_FULL_SCALE;  // Linear scaling 0-9000 RPM
       }
     }
   }
-  else if (config.mode == LINEAR_SWEPT_RPM)
+  PROF_MARK(PROF_ADC);
+
+  if (config.mode == LINEAR_SWEPT_RPM)
   {
     
     if(micros() > (sweep_time_counter + config.sweep_interval))
@@ -581,10 +577,11 @@ void loop()
       sweep_time_counter = micros();
       if(sweep_direction == ASCENDING)
       {
+        uint16_t sweep_top = (currentStatus.max_rpm < TMP_RPM_CAP) ? currentStatus.max_rpm : TMP_RPM_CAP;
         tmp_rpm = currentStatus.base_rpm + 50;  // Larger step size for visible changes
-        if(tmp_rpm >= 9000) { // Use maximum RPM cap instead of config value
+        if(tmp_rpm >= sweep_top) { // Use maximum RPM cap instead of config value
           sweep_direction = DESCENDING;
-          tmp_rpm = 9000; // Clamp to max value
+          tmp_rpm = sweep_top; // Clamp to max value
         }
       }
       else
@@ -606,13 +603,53 @@ void loop()
     tmp_rpm = config.fixed_rpm;
   }
   currentStatus.base_rpm = tmp_rpm;
+  PROF_MARK(PROF_SWEEP);
 
   currentStatus.compressionModifier = calculateCompressionModifier();
   if(currentStatus.compressionModifier >= currentStatus.base_rpm ) { currentStatus.compressionModifier = 0; }
+  PROF_MARK(PROF_COMPRESSION);
 
   setRPM( (currentStatus.base_rpm - currentStatus.compressionModifier) );
+  PROF_MARK(PROF_SETRPM);
+  return false;
 }
 
+//! Serial task: command parser, a pattern dump is sent a slice per pass
+bool serialTask()
+{
+  bool more = false;
+  /* Just handle the Serial UI, everything else is in 
+   * interrupt handlers or callbacks from SerialUI.
+   */
+  if ((Serial.available() > 0) || cmdPending) { more = commandParser(); PROF_MARK(PROF_SERIAL); }
+
+  /* Re-derive the RPM limit whenever the ISR has timed itself slower */
+  if (isr_cycles_max > isr_cycles_used) { updateMaxRPM(); }
+  return more;
+}
+
+#if ENABLE_LCD_INTERFACE
+//! Button scan and UI state machine
+bool uiTask()
+{
+  uiController.update();
+  PROF_MARK(PROF_UI);
+  return false;
+}
+
+//! Startup screens and LCD redraws, cosmetic so only run in the slack
+bool lcdTask()
+{
+  bool more;
+  handleStartupSequence();
+  PROF_MARK(PROF_STARTUP);
+  more = lcdManager.update();
+  PROF_MARK(PROF_LCD);
+  if (!bootStatus.ready_us && !startupSequenceActive && lcdManager.isIdle()) { bootStatus.ready_us = micros(); }
+  return more;
+}
+#endif
+
 uint16_t calculateCompressionModifier()
 {
   if( (currentStatus.base_rpm > config.compressionRPM) || (config.useCompression != true) ) { return 0; }
@@ -662,9 +699,9 @@ uint16_t calculateCurrentCrankAngle()
   if(cycleDuration == 0) { return 0; }
 
   uint32_t cycleTime = micros() - cycleStartTime;
-  if( Wheels[config.wheel].wheel_degrees == 720 ) { cycleTime = cycleTime * 2; } 
   
-  uint16_t tmpCrankAngle = ((cycleTime * 360U) / cycleDuration);
+  /* One table pass is wheel_degrees of crank, 180, 360 or 720 */
+  uint16_t tmpCrankAngle = ((cycleTime * activeWheel.wheel_degrees) / cycleDuration) % 360;
   tmpCrankAngle += config.compressionOffset;
   while(tmpCrankAngle > 360) { tmpCrankAngle -= 360; }
 
@@ -678,20 +715,85 @@ void setRPM(uint16_t newRPM)
 {
   // Allow 0 RPM for potentiometer mode, but minimum 10 for other modes
   if (newRPM < 10 && config.mode != POT_RPM) { return; }
+  // Past the wheel's limit the ISR can't keep up and the output frequency is wrong
+  if (newRPM > currentStatus.max_rpm) { newRPM = currentStatus.max_rpm; }
 
   if(currentStatus.rpm != newRPM) { reset_new_OCR1A( newRPM ); }
   currentStatus.rpm = newRPM;
 }
 
 
+//! Derives the highest RPM the current wheel can be driven at
+/*!
+ * Uses the worst pattern ISR cost measured so far, or ISR_CYCLES_ESTIMATE
+ * until the ISR has run at prescaler 1 and timed itself.
+ */
+void updateMaxRPM()
+{
+  uint16_t cycles;
+  noInterrupts();
+  cycles = isr_cycles_max;
+  interrupts();
+  isr_cycles_used = cycles;
+  if (cycles == 0) { cycles = ISR_CYCLES_ESTIMATE; }
+  currentStatus.max_rpm = max_rpm_for_isr_cycles(activeWheel.rpm_scaler, cycles);
+  if (currentStatus.rpm > currentStatus.max_rpm) { setRPM(currentStatus.max_rpm); }
+}
+
+//! Copies the selected wheel out of the flash table for the pattern ISR
+/*!
+ * Restarts the pattern at its first edge in the same critical section, the
+ * ISR would otherwise run past the end of a shorter edge array.
+ * GENERATED_WHEEL is rendered into RAM here too, a few hundred microseconds
+ * with the pattern stopped, which restarts anyway
+ */
+void load_wheel()
+{
+  noInterrupts();
+  memcpy_P(&activeWheel, &Wheels[config.wheel], sizeof(activeWheel));
+  if (config.wheel == GENERATED_WHEEL)
+  {
+    gen_render(&activeWheel);
+    GPIOR0 |= (1 << GEN_ACTIVE_BIT);
+  }
+  else
+  {
+    GPIOR0 &= ~(1 << GEN_ACTIVE_BIT);
+  }
+  cam_phase_reload();
+  direction_reload();
+  fault_reload();
+  edge_counter = 0;
+  knock_reload();
+  aux_reload();
+  interrupts();
+}
+
+//! Returns the pattern ISR cost in CPU cycles used for the RPM limits
+uint16_t getISRCycles()
+{
+  uint16_t cycles;
+  noInterrupts();
+  cycles = isr_cycles_max;
+  interrupts();
+  return (cycles == 0) ? ISR_CYCLES_ESTIMATE : cycles;
+}
+
+//! Forgets the measured pattern ISR cost, the RPM limits start over from ISR_CYCLES_ESTIMATE
+void resetISRCycles()
+{
+  noInterrupts();
+  isr_cycles_max = 0;
+  interrupts();
+  updateMaxRPM();
+}
+
 void reset_new_OCR1A(uint32_t new_rpm)
 {
   uint32_t tmp;
   uint8_t bitshift;
   uint8_t tmp_prescaler_bits;
-  tmp = (uint32_t)(8000000.0/(Wheels[config.wheel].rpm_scaler * (float)(new_rpm < 10 ? 10:new_rpm)));
-  //tmp = (uint32_t)(8000000/(Wheels[config.wheel].rpm_scaler * (new_rpm < 10 ? 10:new_rpm)));
-  //uint64_t x = 800000000000ULL;
+  tmp = rpm_to_timer_ticks(activeWheel.rpm_scaler, new_rpm);
 
   get_prescaler_bits(&tmp,&tmp_prescaler_bits,&bitshift);
 
@@ -718,33 +820,3 @@ uint8_t get_bitshift_from_prescaler(uint8_t *prescaler_bits)
   }
   return 0;
 }
-
-//! Gets prescaler enum and bitshift based on OC value
-void get_prescaler_bits(uint32_t *potential_oc_value, uint8_t *prescaler, uint8_t *bitshift)
-{
-  if (*potential_oc_value >= 16777216)
-  {
-    *prescaler = PRESCALE_1024;
-    *bitshift = 10;
-  }
-  else if (*potential_oc_value >= 4194304)
-  {
-    *prescaler = PRESCALE_256;
-    *bitshift = 8;
-  }
-  else if (*potential_oc_value >= 524288)
-  {
-    *prescaler = PRESCALE_64;
-    *bitshift = 6;
-  }
-  else if (*potential_oc_value >= 65536)
-  {
-    *prescaler = PRESCALE_8;
-    *bitshift = 3;
-  }
-  else
-  {
-    *prescaler = PRESCALE_1;
-    *bitshift = 0;
-  }
-}
@@ -0,0 +1,167 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Tach and vehicle speed outputs
+ *
+ * See aux_out.h
+ */
+
+#include "aux_out.h"
+#include "knock.h"
+#include <Arduino.h>
+
+struct aux_params auxParams = { 0, VSS_OFF, 100, 4, 350 };
+
+volatile uint16_t tach_at = 0;
+volatile uint16_t tach_acc = 0;
+volatile uint8_t tach_out = 0;
+uint16_t tach_step;
+uint16_t tach_rem;
+uint16_t tach_toggles;
+
+static uint16_t vssHz = 0;              /* On the pin now */
+
+/* Timer2 clock selects and their prescalers */
+static const uint16_t timer2_div[] PROGMEM = { 1, 8, 32, 64, 128, 256, 1024 };
+
+//! Toggles per wheel cycle for ppr tach pulses per revolution, 0 if they don't fit the active wheel
+static uint16_t tach_toggles_for(uint8_t ppr)
+{
+  uint32_t toggles = (uint32_t)ppr * activeWheel.wheel_degrees;
+
+  /* Whole pulses per cycle, at most a toggle per edge */
+  if ((toggles % 180) != 0) { return 0; }
+  toggles /= 180;
+  return (toggles <= activeWheel.wheel_max_edges) ? toggles : 0;
+}
+
+//! Hands the tach toggles to the ISR from edge_counter on, interrupts off
+static void tach_apply()
+{
+  uint16_t toggles = tach_toggles_for(auxParams.tach_ppr);
+
+  if (toggles == 0)
+  {
+    GPIOR0 &= ~(1 << TACH_BIT);
+    tach_out = 0;
+    return;
+  }
+  tach_toggles = toggles;
+  tach_step = activeWheel.wheel_max_edges / toggles;
+  tach_rem = activeWheel.wheel_max_edges % toggles;
+
+  /* The toggle at or after edge_counter, t(i) = i * edges / toggles */
+  uint16_t i = ((uint32_t)edge_counter * toggles + activeWheel.wheel_max_edges - 1) / activeWheel.wheel_max_edges;
+  uint32_t at = (uint32_t)i * activeWheel.wheel_max_edges;
+  if (i >= toggles)
+  {
+    i = 0;
+    at = 0;
+  }
+  tach_at = at / toggles;
+  tach_acc = at % toggles;
+  /* Toggles before it, the first one sets the pin */
+  tach_out = (i & 1) ? TACH_PIN : 0;
+  GPIOR0 |= (1 << TACH_BIT);
+}
+
+//! Sets Timer2 to hz on OC2A, or holds the pin low
+static void vss_timer(uint16_t hz)
+{
+  if (hz < AUX_VSS_HZ_MIN)
+  {
+    TCCR2A = KNOCK_TCCR2A_OFF;
+    vssHz = 0;
+    return;
+  }
+  if (hz > AUX_VSS_HZ_MAX) { hz = AUX_VSS_HZ_MAX; }
+
+  /* The smallest prescaler the compare value fits 8 bits with */
+  uint8_t cs = 1;
+  uint32_t top = F_CPU / (2UL * hz);
+  while ((top > 256) && (cs < 7))
+  {
+    cs++;
+    top = F_CPU / (2UL * pgm_read_word(&timer2_div[cs - 1]) * hz);
+  }
+  if (top > 256) { top = 256; }
+  uint8_t ocr = top - 1;
+
+  noInterrupts();
+  TCCR2B = cs;
+  OCR2A = ocr;
+  /* Past the new compare value the count would run to 255 first */
+  if (TCNT2 >= ocr) { TCNT2 = ocr ? ocr - 1 : 0; }
+  TCCR2A = KNOCK_TCCR2A_ON;
+  interrupts();
+  vssHz = F_CPU / (2UL * pgm_read_word(&timer2_div[cs - 1]) * (ocr + 1));
+}
+
+//! VSS frequency the settings and the RPM call for
+static uint16_t vss_target()
+{
+  switch (auxParams.vss_mode)
+  {
+    case VSS_FIXED:
+      return auxParams.vss_hz;
+
+    case VSS_FOLLOW_RPM:
+    {
+      uint32_t hz = (uint32_t)currentStatus.rpm * auxParams.vss_teeth * 100 / (60UL * auxParams.gear_ratio);
+      return (hz > AUX_VSS_HZ_MAX) ? AUX_VSS_HZ_MAX : hz;
+    }
+  }
+  return 0;
+}
+
+bool aux_set(const struct aux_params *params)
+{
+  if ((params->vss_mode >= MAX_VSS_MODES) || (params->vss_hz > AUX_VSS_HZ_MAX)) { return false; }
+  if ((params->vss_mode == VSS_FOLLOW_RPM) && ((params->gear_ratio == 0) || (params->vss_teeth == 0))) { return false; }
+  if ((params->vss_mode != VSS_OFF) && knockParams.enabled) { return false; }
+  if (params->tach_ppr && (tach_toggles_for(params->tach_ppr) == 0)) { return false; }
+
+  bool vss_was_on = aux_vss_active();
+  auxParams = *params;
+
+  noInterrupts();
+  tach_apply();
+  interrupts();
+
+  if (aux_vss_active()) { vss_timer(vss_target()); }
+  else if (vss_was_on)
+  {
+    TCCR2A = KNOCK_TCCR2A_OFF;
+    vssHz = 0;
+  }
+  return true;
+}
+
+bool aux_vss_active()
+{
+  return auxParams.vss_mode != VSS_OFF;
+}
+
+uint16_t aux_vss_hz()
+{
+  return vssHz;
+}
+
+void aux_reload()
+{
+  /* A wheel the tach doesn't fit just has no tach */
+  tach_apply();
+}
+
+bool aux_task()
+{
+  static uint16_t last = 0;
+
+  if (auxParams.vss_mode != VSS_FOLLOW_RPM) { return false; }
+  uint16_t hz = vss_target();
+  if (hz != last)
+  {
+    last = hz;
+    vss_timer(hz);
+  }
+  return false;
+}
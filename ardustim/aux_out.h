@@ -0,0 +1,102 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Tach and vehicle speed outputs
+ *
+ * Tach, pin 12 (PB4): tach_ppr pulses per engine revolution, 50% duty,
+ * locked to the crank. The toggles fall on edges of the wheel, evenly
+ * spread with a Bresenham step so the ISR never divides, and go out in the
+ * pattern ISR's own PORTB write, the same instruction as the crank edge, so
+ * there is no extra port write and no drift. Off, the ISR pays a single
+ * GPIOR0 bit test.
+ *
+ * VSS, pin 11 (OC2A): a square wave made by Timer2 in CTC mode, no
+ * interrupts at all, either at a set frequency or following the engine as
+ * RPM x sensor teeth / gear ratio. Timer2 and pin 11 are shared with the
+ * knock signal (knock.h), one or the other. Timer2 is 8 bit, below
+ * AUX_VSS_HZ_MIN the output holds low, which reads as stopped.
+ */
+#ifndef __AUX_OUT_H__
+#define __AUX_OUT_H__
+
+#include <stdint.h>
+#include <avr/io.h>
+#include "globals.h"
+
+#define TACH_BIT          5       /* GPIOR0 bit, set while the tach runs (see knock.h) */
+#define TACH_PIN          0x10    /* PB4, pin 12 */
+#define AUX_VSS_HZ_MIN    31      /* Timer2 prescaler 1024, compare 255 */
+#define AUX_VSS_HZ_MAX    20000
+#define AUX_TASK_MS       20      /* VSS follows the RPM this often */
+
+enum {
+  VSS_OFF,
+  VSS_FIXED,          //vss_hz
+  VSS_FOLLOW_RPM,     //RPM / 60 * vss_teeth / (gear_ratio / 100)
+  MAX_VSS_MODES
+};
+
+struct aux_params {
+  uint8_t tach_ppr;       //Tach pulses per engine revolution, 0 = off
+  uint8_t vss_mode;       //VSS_x
+  uint16_t vss_hz;        //VSS_FIXED frequency
+  uint8_t vss_teeth;      //VSS pulses per output shaft revolution
+  uint16_t gear_ratio;    //Engine revolutions per output shaft revolution, x100
+};
+
+extern struct aux_params auxParams;
+
+/* Pattern ISR state, see tach_edge() */
+extern volatile uint16_t tach_at;     /* Edge of the next toggle */
+extern volatile uint16_t tach_acc;    /* Bresenham remainder, /tach_toggles */
+extern volatile uint8_t tach_out;     /* TACH_PIN or 0 */
+extern uint16_t tach_step;            /* Whole edges between toggles */
+extern uint16_t tach_rem;             /* And the remainder, /tach_toggles */
+extern uint16_t tach_toggles;         /* Toggles per wheel cycle */
+extern volatile uint16_t edge_counter;
+
+//! Checks and applies the tach and VSS settings
+/*!
+ * @return false, nothing changed, if they are out of range, the tach has
+ * more toggles than the wheel has edges or the knock signal has Timer2
+ */
+bool aux_set(const struct aux_params *params);
+
+//! True while the VSS owns Timer2 and pin 11
+bool aux_vss_active();
+
+//! VSS frequency on the pin now, Hz, 0 when off or held low
+uint16_t aux_vss_hz();
+
+//! Re-spreads the tach toggles over the active wheel, called by load_wheel() with interrupts off
+void aux_reload();
+
+//! Follows the RPM with the VSS
+bool aux_task();
+
+//! Tach bit for the edge being written, pattern ISR context
+static inline uint8_t tach_edge()
+{
+  if (edge_counter == tach_at)
+  {
+    uint16_t at = tach_at + tach_step;
+    uint16_t acc = tach_acc + tach_rem;
+
+    tach_out ^= TACH_PIN;
+    if (acc >= tach_toggles)
+    {
+      acc -= tach_toggles;
+      at++;
+    }
+    /* The last toggle's step lands exactly on the end of the table */
+    if (at >= activeWheel.wheel_max_edges)
+    {
+      at = 0;
+      acc = 0;
+    }
+    tach_at = at;
+    tach_acc = acc;
+  }
+  return tach_out;
+}
+
+#endif
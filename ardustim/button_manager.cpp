@@ -1,163 +1,198 @@
 /* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
 /*
  * Button Input Manager Implementation
- * 
+ *
  * Handles button debouncing, repeat actions, and state management
- * Non-blocking implementation for Arduino Nano
+ * The buttons are scanned from a Timer0 interrupt and debounced in parallel
+ * with vertical counters, events are published as bitmasks
  *
  * Part of Ardu-Stim LCD Interface Enhancement
  */
 
 #include "button_manager.h"
 #include "pin_config.h"
+#include <avr/interrupt.h>
+
+// One PIND read covers every button, in ButtonIndex order
+static_assert(PIN_BUTTON_PREV == BUTTON_PIN_SHIFT + BUTTON_PREV &&
+              PIN_BUTTON_NEXT == BUTTON_PIN_SHIFT + BUTTON_NEXT &&
+              PIN_BUTTON_SAVE == BUTTON_PIN_SHIFT + BUTTON_SAVE &&
+              PIN_BUTTON_ABT == BUTTON_PIN_SHIFT + BUTTON_ABT &&
+              PIN_BUTTON_HELP == BUTTON_PIN_SHIFT + BUTTON_HELP,
+              "the scanner needs the buttons on D2-D6 in ButtonIndex order");
+static_assert(BUTTON_DELAY_SCANS <= 255 && BUTTON_REPEAT_SCANS <= 255, "repeat countdown is 8 bits");
+static_assert((BUTTON_EVENT_QUEUE & (BUTTON_EVENT_QUEUE - 1)) == 0, "BUTTON_EVENT_QUEUE must be a power of two");
 
-// Static pin mapping array
-const uint8_t ButtonManager::BUTTON_PINS[BUTTON_COUNT] = {
-    PIN_BUTTON_PREV,    // BUTTON_PREV = 0
-    PIN_BUTTON_NEXT,    // BUTTON_NEXT = 1  
-    PIN_BUTTON_SAVE,    // BUTTON_SAVE = 2
-    PIN_BUTTON_ABT,     // BUTTON_ABT = 3
-    PIN_BUTTON_HELP     // BUTTON_HELP = 4
+#define BUTTON_EVENT_MASK (BUTTON_EVENT_QUEUE - 1)
+
+/**
+ * Hold timing of one button, from its press event
+ */
+struct ButtonHold {
+    uint16_t scans;         // Since the press, stops at BUTTON_LONG_SCANS
+    uint8_t wait;           // Scans to the next repeat
+    uint8_t count;          // Repeats so far
 };
 
 /**
- * Constructor - initializes button states to default values
+ * Scanner state, shared with TIMER0_COMPA_vect
+ * Bit n of each byte is ButtonIndex n. ct0-ct2 are a 3-bit down counter per
+ * button, running while the pin disagrees with keyState and reset while it
+ * agrees; keyState only flips when a counter wraps after 8 scans in a row
  */
-ButtonManager::ButtonManager() {
-    // Initialize all button states
-    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
-        buttons[i].debounceState = BUTTON_IDLE;
-        buttons[i].currentReading = HIGH;  // Buttons are active low
-        buttons[i].stableState = false;
-        buttons[i].pressedThisLoop = false;
-        buttons[i].stateChangeTime = 0;
-        buttons[i].pressTime = 0;
-        buttons[i].lastRepeat = 0;
-    }
-}
+static volatile uint8_t keyState;       // Debounced, 1 = held
+static uint8_t ct0 = 0xFF, ct1 = 0xFF, ct2 = 0xFF;
+static uint8_t scanTick;
+static uint8_t pending;                 // Pressed, waiting out the chord window
+static uint8_t pendingScans;
+static uint8_t chorded;                 // Pressed as part of a chord, until released
+static ButtonHold holds[BUTTON_COUNT];
+static volatile uint8_t keyPress;       // Events collected until the next update()
+static volatile uint8_t keyRelease;
+static volatile uint8_t keyLong;
+static volatile uint8_t keyRepeat;
 
 /**
- * Initialize button pins and internal state
- * Call once during setup()
+ * Event ring, written only by the ISR at eventHead and read only by
+ * nextEvent() at eventTail
  */
-void ButtonManager::init() {
-    // Configure all button pins as inputs with internal pull-up resistors
-    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
-        pinMode(BUTTON_PINS[i], INPUT_PULLUP);
-        
-        // Initialize state machine
-        buttons[i].debounceState = BUTTON_IDLE;
-        buttons[i].currentReading = digitalRead(BUTTON_PINS[i]);
-        buttons[i].stableState = false;
-        buttons[i].pressedThisLoop = false;
-        buttons[i].stateChangeTime = millis();
-        buttons[i].pressTime = 0;
-        buttons[i].lastRepeat = 0;
+static volatile ButtonEvent eventQueue[BUTTON_EVENT_QUEUE];
+static volatile uint8_t eventHead = 0;
+static volatile uint8_t eventTail = 0;
+static volatile uint8_t eventsDropped = 0;
+
+//! Queues an event and marks it in the masks, ISR context
+static void emit(uint8_t type, uint8_t mask, uint8_t count)
+{
+    switch (type) {
+        case BUTTON_EVENT_PRESS:    keyPress |= mask; break;
+        case BUTTON_EVENT_RELEASE:  keyRelease |= mask; break;
+        case BUTTON_EVENT_LONG:     keyLong |= mask; break;
+        case BUTTON_EVENT_REPEAT:   keyRepeat |= mask; break;
+    }
+
+    uint8_t head = eventHead;
+    uint8_t next = (head + 1) & BUTTON_EVENT_MASK;
+    if (next == eventTail) {
+        if (eventsDropped < 255) eventsDropped++;
+        return;
+    }
+    eventQueue[head].type = type;
+    eventQueue[head].mask = mask;
+    eventQueue[head].count = count;
+    eventHead = next;
+}
+
+// NOBLOCK: the wheel ISR may cut in, the scan can wait a few microseconds
+ISR(TIMER0_COMPA_vect, ISR_NOBLOCK)
+{
+    if (++scanTick < BUTTON_SCAN_TICKS) {
+        return;
+    }
+    scanTick = 0;
+
+    // Active low, so a set bit is a pressed button
+    uint8_t sample = (uint8_t)(~PIND & BUTTON_PIN_MASK) >> BUTTON_PIN_SHIFT;
+    uint8_t changed = keyState ^ sample;
+
+    ct0 = ~(ct0 & changed);
+    ct1 = ct0 ^ (ct1 & changed);
+    ct2 = (ct0 & ct1) ^ (ct2 & changed);
+    changed &= ct0 & ct1 & ct2;
+
+    uint8_t state = keyState ^ changed;
+    uint8_t down = state & changed;
+    uint8_t up = ~state & changed;
+    keyState = state;
+
+    // A press waits out the chord window, a second one inside it makes a chord
+    if (down) {
+        uint8_t keys = pending | down;
+        if (keys & (keys - 1)) {
+            emit(BUTTON_EVENT_CHORD, keys, 0);
+            chorded |= keys;
+            pending = 0;
+        } else {
+            pending = down;
+            pendingScans = BUTTON_CHORD_SCANS;
+        }
+    }
+    if (pending && (--pendingScans == 0 || (pending & up))) {
+        emit(BUTTON_EVENT_PRESS, pending, 0);
+        pending = 0;
+    }
+
+    // Releases, then long press and repeats counted from the press event
+    for (uint8_t i = 0, bit = 1; i < BUTTON_COUNT; i++, bit <<= 1) {
+        ButtonHold *hold = &holds[i];
+
+        if (up & bit) {
+            emit(BUTTON_EVENT_RELEASE, bit, 0);
+            chorded &= ~bit;
+        }
+        if (!(state & bit) || ((pending | chorded) & bit)) {
+            hold->scans = 0;
+            hold->wait = BUTTON_DELAY_SCANS;
+            hold->count = 0;
+            continue;
+        }
+        if (hold->scans < BUTTON_LONG_SCANS && ++hold->scans == BUTTON_LONG_SCANS) {
+            emit(BUTTON_EVENT_LONG, bit, 0);
+        }
+        if (--hold->wait == 0) {
+            if (hold->count < 255) hold->count++;
+            emit(BUTTON_EVENT_REPEAT, bit, hold->count);
+            hold->wait = BUTTON_REPEAT_SCANS;
+        }
     }
 }
 
 /**
- * Read raw button state from pin
- * @param buttonIndex Index of button to read
- * @return true if button is physically pressed
+ * Constructor - initializes button states to default values
  */
-bool ButtonManager::readButtonPin(uint8_t buttonIndex) {
-    if (buttonIndex >= BUTTON_COUNT) return false;
-    
-    // Buttons are active low (pressed = LOW reading)
-    return (digitalRead(BUTTON_PINS[buttonIndex]) == LOW);
+ButtonManager::ButtonManager() : pressed(0), released(0), longPressed(0), repeated(0) {
 }
 
 /**
- * Update debounce state for a single button using proper state machine
- * @param buttonIndex Index of button to update
+ * Initialize button pins and start the scanner
+ * Call once during setup()
  */
-void ButtonManager::updateButtonDebounce(uint8_t buttonIndex) {
-    if (buttonIndex >= BUTTON_COUNT) return;
-    
-    ButtonState* btn = &buttons[buttonIndex];
-    uint32_t currentTime = millis();
-    bool currentReading = readButtonPin(buttonIndex);
-    
-    // Reset pressed flag for this loop
-    btn->pressedThisLoop = false;
-    
-    // State machine for proper debouncing
-    switch (btn->debounceState) {
-        case BUTTON_IDLE:
-            if (currentReading) {  // Button pressed
-                btn->debounceState = BUTTON_PRESSED_DEBOUNCE;
-                btn->stateChangeTime = currentTime;
-            }
-            break;
-            
-        case BUTTON_PRESSED_DEBOUNCE:
-            if (!currentReading) {  // Button released during debounce
-                btn->debounceState = BUTTON_IDLE;
-            } else if ((currentTime - btn->stateChangeTime) >= BUTTON_DEBOUNCE_TIME) {
-                // Debounce period passed, button is stable pressed
-                btn->debounceState = BUTTON_PRESSED_STABLE;
-                btn->stableState = true;
-                btn->pressedThisLoop = true;  // Signal a clean press
-                btn->pressTime = currentTime;
-            }
-            break;
-            
-        case BUTTON_PRESSED_STABLE:
-            if (!currentReading) {  // Button released
-                btn->debounceState = BUTTON_RELEASED_DEBOUNCE;
-                btn->stateChangeTime = currentTime;
-            }
-            break;
-            
-        case BUTTON_RELEASED_DEBOUNCE:
-            if (currentReading) {  // Button pressed again during debounce
-                btn->debounceState = BUTTON_PRESSED_STABLE;
-            } else if ((currentTime - btn->stateChangeTime) >= BUTTON_DEBOUNCE_TIME) {
-                // Debounce period passed, button is stable released
-                btn->debounceState = BUTTON_IDLE;
-                btn->stableState = false;
-            }
-            break;
-    }
-    
-    btn->currentReading = currentReading;
+void ButtonManager::init() {
+    // Configure all button pins as inputs with internal pull-up resistors
+    DDRD &= ~BUTTON_PIN_MASK;
+    PORTD |= BUTTON_PIN_MASK;
+
+    // Compare A at half count, between the millis() overflows. OC0A stays
+    // disconnected, TCCR0A/B are left as the core set them
+    OCR0A = 128;
+    TIFR0 = (1 << OCF0A);
+    TIMSK0 |= (1 << OCIE0A);
 }
 
 /**
- * Update repeat state for a single button
- * @param buttonIndex Index of button to update
+ * Take the events the scanner collected since the last call
  */
-void ButtonManager::updateButtonRepeat(uint8_t buttonIndex) {
-    if (buttonIndex >= BUTTON_COUNT) return;
-    
-    ButtonState* btn = &buttons[buttonIndex];
-    uint32_t currentTime = millis();
-    
-    // Only process repeat for stable pressed buttons
-    if (!btn->stableState) {
-        btn->lastRepeat = 0;
-        return;
-    }
-    
-    // Check if button has been held long enough to start repeating
-    if (btn->lastRepeat == 0 && (currentTime - btn->pressTime) >= BUTTON_REPEAT_DELAY) {
-        btn->lastRepeat = currentTime;
-    }
+void ButtonManager::update() {
+    noInterrupts();
+    pressed = keyPress;
+    released = keyRelease;
+    longPressed = keyLong;
+    repeated |= keyRepeat;
+    keyPress = 0;
+    keyRelease = 0;
+    keyLong = 0;
+    keyRepeat = 0;
+    interrupts();
+
+    // A repeat not taken by isRepeating() is dropped once the button is let go
+    repeated &= keyState;
 }
 
 /**
- * Update all button states - call regularly in main loop
- * Non-blocking operation using millis() timing
+ * Debounced state of all buttons
  */
-void ButtonManager::update() {
-    // Update debounce and repeat state for all buttons
-    for (uint8_t i = 0; i < BUTTON_COUNT; i++) {
-        updateButtonDebounce(i);
-        updateButtonRepeat(i);
-    }
-    
-    // Simplified button handling - removed simultaneous press priority
+uint8_t ButtonManager::heldMask() {
+    return keyState;
 }
 
 /**
@@ -167,11 +202,8 @@ void ButtonManager::update() {
  */
 bool ButtonManager::isPressed(uint8_t buttonIndex) {
     if (buttonIndex >= BUTTON_COUNT) return false;
-    
-    ButtonState* btn = &buttons[buttonIndex];
-    
-    // Return true only if button was pressed this loop (clean single press)
-    return btn->pressedThisLoop;
+
+    return (pressed & BUTTON_BIT(buttonIndex)) != 0;
 }
 
 /**
@@ -181,8 +213,19 @@ bool ButtonManager::isPressed(uint8_t buttonIndex) {
  */
 bool ButtonManager::isHeld(uint8_t buttonIndex) {
     if (buttonIndex >= BUTTON_COUNT) return false;
-    
-    return buttons[buttonIndex].stableState;
+
+    return (keyState & BUTTON_BIT(buttonIndex)) != 0;
+}
+
+/**
+ * Check if button has been held for BUTTON_LONG_PRESS, once per hold
+ * @param buttonIndex Button to check
+ * @return true in the update() the long press was reached
+ */
+bool ButtonManager::isLongPressed(uint8_t buttonIndex) {
+    if (buttonIndex >= BUTTON_COUNT) return false;
+
+    return (longPressed & BUTTON_BIT(buttonIndex)) != 0;
 }
 
 /**
@@ -192,60 +235,39 @@ bool ButtonManager::isHeld(uint8_t buttonIndex) {
  */
 bool ButtonManager::isRepeating(uint8_t buttonIndex) {
     if (buttonIndex >= BUTTON_COUNT) return false;
-    
-    ButtonState* btn = &buttons[buttonIndex];
-    uint32_t currentTime = millis();
-    
-    // Button must be held and repeat timer must have elapsed
-    if (btn->stableState && btn->lastRepeat > 0 && (currentTime - btn->lastRepeat) >= BUTTON_REPEAT_RATE) {
-        // Update last repeat time for next cycle
-        btn->lastRepeat = currentTime;
+
+    uint8_t bit = BUTTON_BIT(buttonIndex);
+    if (repeated & bit) {
+        repeated &= ~bit;
         return true;
     }
-    
+
     return false;
 }
 
 /**
- * Reset button state (useful after processing an action)
- * @param buttonIndex Button to reset
+ * Take the oldest queued event
+ * @param event Filled in if there was one
+ * @return false if the queue is empty
  */
-void ButtonManager::resetButton(uint8_t buttonIndex) {
-    if (buttonIndex >= BUTTON_COUNT) return;
-    
-    ButtonState* btn = &buttons[buttonIndex];
-    
-    // Reset press detection but maintain physical state
-    btn->pressedThisLoop = false;
-    
-    // If button is still physically pressed, maintain held state
-    if (btn->stableState) {
-        btn->pressTime = millis();
+bool ButtonManager::nextEvent(ButtonEvent& event) {
+    uint8_t tail = eventTail;
+    if (tail == eventHead) {
+        return false;
     }
-}
-
 
-
-/**
- * Check if NEXT button should trigger RPM increase
- * Handles both single press and repeat for held button
- * @return true if RPM should be increased
- */
-bool ButtonManager::shouldIncreaseRPM() {
-    // For wheel pattern selection: single press
-    // For RPM adjustment: repeat when held
-    return isPressed(BUTTON_NEXT) || isRepeating(BUTTON_NEXT);
+    event.type = eventQueue[tail].type;
+    event.mask = eventQueue[tail].mask;
+    event.count = eventQueue[tail].count;
+    eventTail = (tail + 1) & BUTTON_EVENT_MASK;
+    return true;
 }
 
 /**
- * Check if PREV button should trigger RPM decrease
- * Handles both single press and repeat for held button
- * @return true if RPM should be decreased
+ * Events lost to a full queue since power up
  */
-bool ButtonManager::shouldDecreaseRPM() {
-    // For wheel pattern selection: single press
-    // For RPM adjustment: repeat when held
-    return isPressed(BUTTON_PREV) || isRepeating(BUTTON_PREV);
+uint8_t ButtonManager::droppedEvents() {
+    return eventsDropped;
 }
 
 /**
@@ -254,7 +276,7 @@ bool ButtonManager::shouldDecreaseRPM() {
  * @return true if NEXT or PREV button is held
  */
 bool ButtonManager::isRPMAdjustmentActive() {
-    return isHeld(BUTTON_NEXT) || isHeld(BUTTON_PREV);
+    return (keyState & (BUTTON_BIT(BUTTON_NEXT) | BUTTON_BIT(BUTTON_PREV))) != 0;
 }
 
 /**
@@ -263,8 +285,7 @@ bool ButtonManager::isRPMAdjustmentActive() {
  * @return true if button actions can be safely processed
  */
 bool ButtonManager::isSafeToProcessActions() {
-    // Always safe to process - button operations are designed to be non-blocking
-    // This method is provided for future expansion if timing constraints are added
-    // All button processing uses millis() timing and avoids blocking operations
+    // Always safe to process - the scan itself runs in TIMER0_COMPA_vect and
+    // everything here only reads the masks it leaves behind
     return true;
-}
\ No newline at end of file
+}
@@ -3,7 +3,8 @@
  * Button Input Manager
  * 
  * Handles button debouncing, repeat actions, and state management
- * Non-blocking implementation for Arduino Nano
+ * The buttons are scanned from a Timer0 interrupt and debounced in parallel
+ * with vertical counters, events are published as bitmasks
  *
  * Part of Ardu-Stim LCD Interface Enhancement
  */
@@ -35,63 +36,77 @@ enum ButtonIndex {
     BUTTON_COUNT = 5
 };
 
+/**
+ * Scanner configuration
+ *
+ * Timer0 runs millis() off its overflow every 1.024ms; its compare A match
+ * comes round at the same rate half way between and is otherwise unused
+ * (OC0A is D6, wired as an input). Every BUTTON_SCAN_TICKS of those the ISR
+ * reads PIND once and debounces all five buttons together, so a press is seen
+ * on time however long a loop pass takes.
+ */
+#define BUTTON_PIN_SHIFT        2       // PD2 is BUTTON_PREV, PD6 is BUTTON_HELP
+#define BUTTON_PIN_MASK         (((1 << BUTTON_COUNT) - 1) << BUTTON_PIN_SHIFT)
+#define BUTTON_SCAN_TICKS       2       // Scan every 2.048ms
+#define BUTTON_SCAN_US          (BUTTON_SCAN_TICKS * 1024UL)
+
 /**
  * Button Timing Configuration
+ * A change needs 8 agreeing scans (~16ms) to get through the debouncer
  */
-#define BUTTON_DEBOUNCE_TIME    100     // 200ms debounce period (much longer to prevent bouncing)
-#define BUTTON_REPEAT_DELAY     800     // 800ms before repeat starts (reasonable delay)
-#define BUTTON_REPEAT_RATE      150     // 150ms between repeats (fast repeat for holding)
+#define BUTTON_CHORD_TIME       40      // Presses this close together are one chord
+#define BUTTON_REPEAT_DELAY     300     // 300ms held before repeats start
+#define BUTTON_REPEAT_RATE      50      // 50ms between repeats, the UI scales the step by repeat count
+#define BUTTON_LONG_PRESS       800     // 800ms held for the long press event
+#define BUTTON_MS_TO_SCANS(ms)  ((uint16_t)(((ms) * 1000UL + BUTTON_SCAN_US / 2) / BUTTON_SCAN_US))
+#define BUTTON_CHORD_SCANS      BUTTON_MS_TO_SCANS(BUTTON_CHORD_TIME)
+#define BUTTON_REPEAT_SCANS     BUTTON_MS_TO_SCANS(BUTTON_REPEAT_RATE)
+#define BUTTON_DELAY_SCANS      BUTTON_MS_TO_SCANS(BUTTON_REPEAT_DELAY)
+#define BUTTON_LONG_SCANS       BUTTON_MS_TO_SCANS(BUTTON_LONG_PRESS)
 
 /**
- * Button debounce states
+ * Bit for a ButtonIndex in the event masks
  */
-enum ButtonDebounceState {
-    BUTTON_IDLE,
-    BUTTON_PRESSED_DEBOUNCE,
-    BUTTON_PRESSED_STABLE,
-    BUTTON_RELEASED_DEBOUNCE
-};
+#define BUTTON_BIT(index)       ((uint8_t)(1 << (index)))
 
 /**
- * Button state structure for tracking individual button states
+ * Button events, queued by the scanner in the order they happened
+ *
+ * A press is held back for BUTTON_CHORD_TIME: if a second button goes down
+ * in that time the pair is reported as one BUTTON_EVENT_CHORD instead of two
+ * presses, and neither button repeats or long presses until it's let go.
  */
-struct ButtonState {
-    ButtonDebounceState debounceState;  // Current debounce state
-    bool currentReading;                // Current raw pin reading
-    bool stableState;                   // Stable debounced state
-    bool pressedThisLoop;               // True if button was just pressed this loop
-    uint32_t stateChangeTime;           // Time when state last changed
-    uint32_t pressTime;                 // Time when button was first pressed
-    uint32_t lastRepeat;                // Time of last repeat action
+enum ButtonEventType {
+    BUTTON_EVENT_PRESS,         // mask: the button
+    BUTTON_EVENT_RELEASE,       // mask: the button
+    BUTTON_EVENT_LONG,          // mask: the button, held BUTTON_LONG_PRESS
+    BUTTON_EVENT_REPEAT,        // mask: the button, count: repeats so far, from 1
+    BUTTON_EVENT_CHORD          // mask: every button in the chord
+};
+
+struct ButtonEvent {
+    uint8_t type;               // ButtonEventType
+    uint8_t mask;               // BUTTON_BIT() of the buttons involved
+    uint8_t count;              // Repeat number, saturates at 255
 };
 
+/**
+ * Single producer (the scanner ISR), single consumer (nextEvent()) ring, so
+ * neither side locks. Events that find it full are dropped and counted
+ */
+#define BUTTON_EVENT_QUEUE      8       // Power of two
+
 /**
  * Button Manager Class
- * Handles all button input processing with non-blocking algorithms
+ * Front end for the Timer0 scanner. Events come out of nextEvent() one at a
+ * time; update() also takes a snapshot of them as masks for the is*() calls
  */
 class ButtonManager {
 private:
-    ButtonState buttons[BUTTON_COUNT];
-    static const uint8_t BUTTON_PINS[BUTTON_COUNT];
-    
-    /**
-     * Read raw button state from pin
-     * @param buttonIndex Index of button to read
-     * @return true if button is physically pressed
-     */
-    bool readButtonPin(uint8_t buttonIndex);
-    
-    /**
-     * Update debounce state for a single button
-     * @param buttonIndex Index of button to update
-     */
-    void updateButtonDebounce(uint8_t buttonIndex);
-    
-    /**
-     * Update repeat state for a single button
-     * @param buttonIndex Index of button to update
-     */
-    void updateButtonRepeat(uint8_t buttonIndex);
+    uint8_t pressed;        // Debounced press, this update()
+    uint8_t released;       // Debounced release, this update()
+    uint8_t longPressed;    // Held BUTTON_LONG_PRESS, this update()
+    uint8_t repeated;       // Repeat ticks not yet taken by isRepeating()
     
 public:
     /**
@@ -100,17 +115,31 @@ public:
     ButtonManager();
     
     /**
-     * Initialize button pins and internal state
+     * Initialize button pins and start the scanner
      * Call once during setup()
      */
     void init();
     
     /**
-     * Update all button states - call regularly in main loop
-     * Non-blocking operation using millis() timing
+     * Take the events the scanner collected since the last call
+     * Call once per UI pass, before the is*() checks
      */
     void update();
     
+    /**
+     * Event masks of this update(), one BUTTON_BIT() per button
+     */
+    uint8_t pressedMask() { return pressed; }
+    uint8_t releasedMask() { return released; }
+    uint8_t longPressMask() { return longPressed; }
+    uint8_t repeatMask() { return repeated; }
+    
+    /**
+     * Debounced state of all buttons, live from the scanner
+     * @return BUTTON_BIT() set for every button held down
+     */
+    uint8_t heldMask();
+    
     /**
      * Check if button was just pressed (single press detection)
      * @param buttonIndex Button to check
@@ -126,31 +155,31 @@ public:
     bool isHeld(uint8_t buttonIndex);
     
     /**
-     * Check if button is in repeat mode (held and repeating)
+     * Check if button has been held for BUTTON_LONG_PRESS, once per hold
      * @param buttonIndex Button to check
-     * @return true if button should trigger repeat action
+     * @return true in the update() the long press was reached
      */
-    bool isRepeating(uint8_t buttonIndex);
+    bool isLongPressed(uint8_t buttonIndex);
     
     /**
-     * Reset button state (useful after processing an action)
-     * @param buttonIndex Button to reset
+     * Check if button is in repeat mode (held and repeating)
+     * Each repeat is reported once
+     * @param buttonIndex Button to check
+     * @return true if button should trigger repeat action
      */
-    void resetButton(uint8_t buttonIndex);
+    bool isRepeating(uint8_t buttonIndex);
     
     /**
-     * Check if NEXT button should trigger RPM increase
-     * Handles both single press and repeat for held button
-     * @return true if RPM should be increased
+     * Take the oldest queued event
+     * @param event Filled in if there was one
+     * @return false if the queue is empty
      */
-    bool shouldIncreaseRPM();
+    bool nextEvent(ButtonEvent& event);
     
     /**
-     * Check if PREV button should trigger RPM decrease
-     * Handles both single press and repeat for held button
-     * @return true if RPM should be decreased
+     * Events lost to a full queue since power up
      */
-    bool shouldDecreaseRPM();
+    uint8_t droppedEvents();
     
     /**
      * Check if any button that affects RPM is currently held
@@ -0,0 +1,148 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Runtime cam phase offset (VVT simulation)
+ *
+ * See cam_phase.h
+ */
+
+#include "cam_phase.h"
+#include <Arduino.h>
+
+#define CAM_DELAY_NONE  -1          /* Nothing applied to the ISR yet, delays are never negative */
+
+extern volatile uint16_t edge_counter;
+
+volatile uint16_t cam_index = 0;
+volatile uint8_t cam_frac = 0;
+volatile uint8_t cam_out = 0;
+volatile uint8_t cam_next = 0;
+volatile bool cam_pending = false;
+
+static int16_t phaseTarget = 0;         /* Tenths of a degree */
+static uint16_t phaseSlew = 0;          /* Tenths of a degree per second, 0 = jump */
+static float phaseNow = 0;              /* Tenths of a degree, fractional while slewing */
+static int32_t appliedDelay = CAM_DELAY_NONE;
+static uint16_t lastRunMs;
+
+void cam_phase_set(int16_t target, uint16_t slew)
+{
+  if (target > CAM_PHASE_LIMIT) { target = CAM_PHASE_LIMIT; }
+  if (target < -CAM_PHASE_LIMIT) { target = -CAM_PHASE_LIMIT; }
+  phaseTarget = target;
+  phaseSlew = slew;
+  if (slew == 0) { phaseNow = target; }
+}
+
+void cam_phase_step(int16_t delta)
+{
+  cam_phase_set(phaseTarget + delta, phaseSlew);
+}
+
+int16_t cam_phase_now()
+{
+  return (int16_t)lroundf(phaseNow);
+}
+
+int16_t cam_phase_target()
+{
+  return phaseTarget;
+}
+
+uint16_t cam_phase_slew()
+{
+  return phaseSlew;
+}
+
+void cam_phase_reload()
+{
+  GPIOR0 &= ~(1 << CAM_PHASE_BIT);
+  TIMSK1 &= ~(1 << OCIE1B);
+  cam_pending = false;
+  appliedDelay = CAM_DELAY_NONE;
+}
+
+//! Hands a cam delay to the pattern ISR
+/*!
+ * @param delay Edges the cam runs behind the crank, /256, 0 turns the offset off
+ */
+static void cam_phase_apply(int32_t delay)
+{
+  uint16_t edges = activeWheel.wheel_max_edges;
+  uint16_t whole = delay >> 8;
+
+  noInterrupts();
+  if (delay == 0)
+  {
+    GPIOR0 &= ~(1 << CAM_PHASE_BIT);
+    TIMSK1 &= ~(1 << OCIE1B);
+    cam_pending = false;
+  }
+  else
+  {
+    uint16_t idx = edge_counter + edges - whole;
+    if (idx >= edges) { idx -= edges; }
+    if (!(GPIOR0 & (1 << CAM_PHASE_BIT)))
+    {
+      /* The cam bits of the edge just written, nothing changes on the pins */
+      cam_out = active_edge_state(edge_counter ? edge_counter - 1 : edges - 1) & CAM_PINS;
+    }
+    cam_index = idx;
+    cam_frac = delay & 0xFF;
+    GPIOR0 |= (1 << CAM_PHASE_BIT);
+  }
+  interrupts();
+  appliedDelay = delay;
+}
+
+void cam_phase_flip(bool reverse)
+{
+  uint16_t edges = activeWheel.wheel_max_edges;
+  uint16_t idx = cam_index;
+
+  /* A transition armed for the old direction may never be reached */
+  TIMSK1 &= ~(1 << OCIE1B);
+  cam_pending = false;
+
+  /* Same 2 edge step as edge_counter */
+  if (reverse)
+  {
+    idx = (idx >= 2) ? idx - 2 : idx + edges - 2;
+  }
+  else
+  {
+    idx = (idx + 2 < edges) ? idx + 2 : idx + 2 - edges;
+    /* Forwards the cam holds the previous edge's bits until cam_frac */
+    cam_out = active_edge_state(idx ? idx - 1 : edges - 1) & CAM_PINS;
+  }
+  cam_index = idx;
+}
+
+bool cam_phase_task()
+{
+  uint16_t now = millis();
+  uint16_t elapsed = now - lastRunMs;
+  lastRunMs = now;
+
+  if (phaseNow != phaseTarget)
+  {
+    float step = (float)phaseSlew * elapsed / 1000.0f;
+    if (phaseNow < phaseTarget)
+    {
+      phaseNow = (phaseNow + step < phaseTarget) ? phaseNow + step : phaseTarget;
+    }
+    else
+    {
+      phaseNow = (phaseNow - step > phaseTarget) ? phaseNow - step : phaseTarget;
+    }
+  }
+
+  /* Advance in 1/256 edges of the active wheel, as a delay within one cycle */
+  if (activeWheel.wheel_max_edges == 0) { return false; }
+  int32_t cycle = (int32_t)activeWheel.wheel_max_edges << 8;
+  int32_t advance = lroundf(phaseNow * 25.6f * activeWheel.wheel_max_edges / activeWheel.wheel_degrees);
+  int32_t delay = -advance % cycle;
+  if (delay < 0) { delay += cycle; }
+
+  if (delay != appliedDelay) { cam_phase_apply(delay); }
+  return false;
+}
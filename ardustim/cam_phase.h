@@ -0,0 +1,160 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Runtime cam phase offset (VVT simulation)
+ *
+ * The cam outputs of a wheel (edge state bits 1 and 2, values 2 and 4) can
+ * be shifted against the crank while it runs. The pattern ISR keeps a second
+ * index into the same edge table, cam_index, running a whole number of edges
+ * behind edge_counter, and takes the cam bits from there instead of from the
+ * crank edge. The rest of the offset, a fraction of an edge in 1/256 steps,
+ * delays each cam transition within its edge period with a Timer1 COMPB one
+ * shot. COMPB is only armed for the edges where a cam output changes, a
+ * handful per cycle, so the ISR rate stays what the wheel needs.
+ *
+ * The phase moves towards its target at a set slew rate, a step per
+ * millisecond from cam_phase_task(), so the cam can be swept smoothly while
+ * the pattern runs. At zero offset the ISR skips all of it, a single GPIOR0
+ * bit test.
+ */
+#ifndef __CAM_PHASE_H__
+#define __CAM_PHASE_H__
+
+#include <stdint.h>
+#include <avr/io.h>
+#include "wheel_gen.h"
+
+#define CAM_PHASE_BIT     1     /* GPIOR0 bit, set while the cam is offset (bit 0 is GEN_ACTIVE_BIT) */
+#define CAM_PINS          0x06  /* Cam1 and cam2 in the edge states and on PORTB */
+#define CAM_PHASE_LIMIT   1800  /* +-180.0 crank degrees */
+#define CAM_PHASE_STEP    10    /* ABT+NEXT/PREV chord step, 1.0 degree */
+#define CAM_POT_RANGE     600   /* The cam pot covers +-60.0 degrees */
+
+/* Pattern ISR state, see cam_phase_edge() */
+extern volatile uint16_t cam_index;   /* Edge the cam bits are taken from */
+extern volatile uint8_t cam_frac;     /* Fraction of an edge cam transitions are delayed by, /256 */
+extern volatile uint8_t cam_out;      /* Cam bits on the outputs */
+extern volatile uint8_t cam_next;     /* Cam bits COMPB is to write */
+extern volatile bool cam_pending;     /* COMPB is armed for cam_next */
+
+//! Sets the phase to move to, tenths of a crank degree, positive is advance
+/*!
+ * @param target Clamped to +-CAM_PHASE_LIMIT
+ * @param slew Tenths of a degree per second, 0 jumps straight there
+ */
+void cam_phase_set(int16_t target, uint16_t slew);
+
+//! Moves the target by delta tenths at the current slew rate
+void cam_phase_step(int16_t delta);
+
+//! Current phase, tenths of a crank degree
+int16_t cam_phase_now();
+
+//! Phase being moved to, tenths of a crank degree
+int16_t cam_phase_target();
+
+//! Slew rate, tenths of a degree per second
+uint16_t cam_phase_slew();
+
+//! Drops the ISR state for a new wheel, called by load_wheel() with interrupts off
+/*!
+ * cam_index could be past the new wheel's end, the offset is re-applied on
+ * the next cam_phase_task()
+ */
+void cam_phase_reload();
+
+//! Slews the phase towards its target and hands changes to the ISR
+bool cam_phase_task();
+
+//! Moves cam_index over with a direction change, see direction_flip()
+void cam_phase_flip(bool reverse);
+
+//! period * frac / 256 in two 8x8 multiplies, exact, pattern ISR context
+static inline uint16_t cam_phase_fraction(uint16_t period, uint8_t frac)
+{
+  return (uint16_t)((period >> 8) * frac) + (((period & 0xFF) * frac) >> 8);
+}
+
+//! Cam bits for the edge being written, pattern ISR context
+/*!
+ * @param states Edge states from the crank index
+ * @param period Timer1 counts of this edge, for the COMPB fraction
+ * @return states with the cam bits replaced
+ */
+static inline uint8_t cam_phase_edge(uint8_t states, uint16_t period)
+{
+  uint16_t idx = cam_index;
+  uint8_t next = active_edge_state(idx) & CAM_PINS;
+
+  if (++idx == activeWheel.wheel_max_edges) { idx = 0; }
+  cam_index = idx;
+
+  /* COMPB always fires inside its edge, this only catches a prescaler change */
+  if (cam_pending)
+  {
+    cam_out = cam_next;
+    cam_pending = false;
+    TIMSK1 &= ~(1 << OCIE1B);
+  }
+
+  if (next != cam_out)
+  {
+    uint16_t at = cam_phase_fraction(period, cam_frac);
+    if (TCNT1 >= at)
+    {
+      /* No fraction (at is 0), or already past it, the transition goes out with this edge */
+      cam_out = next;
+    }
+    else
+    {
+      cam_next = next;
+      cam_pending = true;
+      OCR1B = at;
+      TIFR1 = (1 << OCF1B);
+      TIMSK1 |= (1 << OCIE1B);
+    }
+  }
+  return (states & ~CAM_PINS) | cam_out;
+}
+
+//! cam_phase_edge() for a wheel running backwards, see direction.h
+/*!
+ * The edge is entered from its far end, so the cam shows cam_index's bits
+ * and changes to the previous edge's cam_frac short of the near end
+ */
+static inline uint8_t cam_phase_edge_reverse(uint8_t states, uint16_t period)
+{
+  uint16_t idx = cam_index;
+  uint16_t prev = (idx ? idx : activeWheel.wheel_max_edges) - 1;
+
+  cam_index = prev;
+  if (cam_pending)
+  {
+    cam_pending = false;
+    TIMSK1 &= ~(1 << OCIE1B);
+  }
+
+  cam_out = active_edge_state(idx) & CAM_PINS;
+  if (cam_frac)
+  {
+    uint8_t next = active_edge_state(prev) & CAM_PINS;
+    uint16_t at = cam_phase_fraction(period, 0 - cam_frac);
+    if (next != cam_out)
+    {
+      if (TCNT1 >= at)
+      {
+        cam_out = next;
+      }
+      else
+      {
+        cam_next = next;
+        cam_pending = true;
+        OCR1B = at;
+        TIFR1 = (1 << OCF1B);
+        TIMSK1 |= (1 << OCIE1B);
+      }
+    }
+  }
+  return (states & ~CAM_PINS) | cam_out;
+}
+
+#endif
@@ -0,0 +1,276 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * ECU output capture
+ *
+ * See capture.h
+ */
+
+#include "capture.h"
+
+#if ENABLE_CAPTURE
+
+#include "globals.h"
+#include "direction.h"
+#include <string.h>
+
+#define CAPTURE_SPARK_PIN       A3
+#define CAPTURE_INJECTOR_PIN    7
+#define CAPTURE_NO_LINE         0xFF
+
+/* Running statistics of one channel of one slot */
+struct capture_stats {
+  uint16_t count;
+  int32_t angle_sum;      //Tenths of a degree before TDC
+  int16_t angle_min;
+  int16_t angle_max;
+  uint32_t width_sum;     //us
+  uint16_t width_min;
+  uint16_t width_max;
+};
+
+/* A pulse that has started */
+struct capture_pulse {
+  bool started;
+  uint32_t pos;           //Edges x 256 from the wheel's first edge
+};
+
+struct capture_params captureParams = { 0, 4, 0, 0 };
+
+struct capture_raw capture_ring[CAPTURE_RING];
+volatile uint8_t capture_head = 0;
+volatile uint8_t capture_tail = 0;
+volatile uint16_t capture_overruns = 0;
+
+static struct capture_stats stats[CAPTURE_CHANNELS][CAPTURE_MAX_CYLINDERS];
+static struct capture_pulse pulses[CAPTURE_CHANNELS];
+static uint32_t events = 0;
+static uint32_t stream_last = 0;
+static uint8_t stream_line = CAPTURE_NO_LINE;
+
+/* Timer1 counts per CPU cycle as a shift, indexed by the clock select */
+static const uint8_t capture_cs_shift[8] PROGMEM = { 0, 0, 3, 6, 8, 10, 0, 0 };
+
+ISR(PCINT1_vect)
+{
+  capture_record(CAPTURE_SPARK | ((PINC & (1 << PINC3)) ? CAPTURE_LEVEL : 0));
+}
+
+ISR(PCINT2_vect)
+{
+  capture_record(CAPTURE_INJECTOR | ((PIND & (1 << PIND7)) ? CAPTURE_LEVEL : 0));
+}
+
+void capture_init()
+{
+  pinMode(CAPTURE_SPARK_PIN, INPUT);
+  pinMode(CAPTURE_INJECTOR_PIN, INPUT);
+  /* Only the capture pins, the buttons on PORTD are scanned from Timer0 */
+  PCMSK1 = (1 << PCINT11);
+  PCMSK2 = (1 << PCINT23);
+  PCICR &= ~((1 << PCIE1) | (1 << PCIE2));
+}
+
+//! Clears the statistics and anything in flight
+static void capture_reset()
+{
+  memset(stats, 0, sizeof(stats));
+  memset(pulses, 0, sizeof(pulses));
+  events = 0;
+  stream_line = CAPTURE_NO_LINE;
+  noInterrupts();
+  capture_tail = capture_head;
+  capture_overruns = 0;
+  interrupts();
+}
+
+bool capture_set(const struct capture_params *params)
+{
+  if ((params->cylinders == 0) || (params->cylinders > CAPTURE_MAX_CYLINDERS)) { return false; }
+  if (params->polarity > (CAPTURE_SPARK_LOW | CAPTURE_INJECTOR_LOW)) { return false; }
+
+  captureParams = *params;
+  noInterrupts();
+  PCICR &= ~((1 << PCIE1) | (1 << PCIE2));
+  interrupts();
+  capture_reset();
+  if (captureParams.enabled)
+  {
+    /* Changes from before now are stale */
+    PCIFR = (1 << PCIF1) | (1 << PCIF2);
+    PCICR |= (1 << PCIE1) | (1 << PCIE2);
+  }
+  stream_last = millis();
+  return true;
+}
+
+//! Distinct TDC positions on the active wheel, a 360 degree wheel folds an even cylinder count in half
+static uint8_t capture_slots()
+{
+  uint16_t turns = (uint16_t)captureParams.cylinders * activeWheel.wheel_degrees;
+  return ((turns % 720) == 0) ? turns / 720 : captureParams.cylinders;
+}
+
+//! Position of a snapshot, edges x 256 from the wheel's first edge
+static uint32_t capture_position(const struct capture_raw *r, uint16_t edges)
+{
+  uint16_t last;
+
+  /* A compare that matched between the TCNT1 and TIFR1 reads left a count from before it */
+  if ((r->flags & CAPTURE_PENDING) && (r->tcnt < (r->top >> 1))) { last = r->edge; }
+  else { last = r->edge ? r->edge - 1 : edges - 1; }
+
+  uint16_t frac = ((uint32_t)r->tcnt << 8) / ((uint32_t)r->top + 1);
+  if (frac > 255) { frac = 255; }
+  return ((uint32_t)last << 8) + frac;
+}
+
+//! Adds one pulse to its slot
+/*!
+ * @param angle Tenths of a degree from the wheel's first edge the event happened at
+ * @param width Pulse length, us
+ */
+static void capture_add(uint8_t channel, uint16_t angle, uint16_t width)
+{
+  uint8_t slots = capture_slots();
+  uint16_t spacing = (activeWheel.wheel_degrees * 10) / slots;
+  uint16_t k = (angle + 3 * spacing / 4) / spacing;
+  int16_t btdc = (int16_t)(k * spacing) - (int16_t)angle;
+  uint8_t slot = (k >= slots) ? k - slots : k;
+
+  struct capture_stats *s = &stats[channel][slot];
+  if (s->count == 0xFFFF) { return; } /* Saturate, the averages stay right */
+  if ((s->count == 0) || (btdc < s->angle_min)) { s->angle_min = btdc; }
+  if ((s->count == 0) || (btdc > s->angle_max)) { s->angle_max = btdc; }
+  if ((s->count == 0) || (width < s->width_min)) { s->width_min = width; }
+  if (width > s->width_max) { s->width_max = width; }
+  s->angle_sum += btdc;
+  s->width_sum += width;
+  s->count++;
+}
+
+//! Turns a snapshot into an angle and pairs it with the start of its pulse
+static void capture_event(const struct capture_raw *r)
+{
+  uint16_t edges = activeWheel.wheel_max_edges;
+  uint8_t channel = r->flags & CAPTURE_CHANNEL_MASK;
+  struct capture_pulse *p = &pulses[channel];
+
+  if ((edges == 0) || (activeWheel.wheel_degrees == 0) || (r->edge >= edges) || (GPIOR0 & (1 << DIRECTION_BIT)))
+  {
+    p->started = false;
+    return;
+  }
+
+  uint32_t pos = capture_position(r, edges);
+  bool level = (r->flags & CAPTURE_LEVEL) != 0;
+  bool low = (captureParams.polarity & (channel == CAPTURE_SPARK ? CAPTURE_SPARK_LOW : CAPTURE_INJECTOR_LOW)) != 0;
+  if (level != low)
+  {
+    p->started = true;
+    p->pos = pos;
+    return;
+  }
+  if (!p->started) { return; }
+  p->started = false;
+  events++;
+
+  /* Edges covered, across the end of the table if need be */
+  uint32_t cycle = (uint32_t)edges << 8;
+  uint32_t len = (pos >= p->pos) ? pos - p->pos : pos + cycle - p->pos;
+  uint32_t edge_cycles = ((uint32_t)r->top + 1) << pgm_read_byte(&capture_cs_shift[r->cs]);
+  float us = (float)len * edge_cycles / (256.0f * (F_CPU / 1000000UL));
+  uint16_t width = (us > 65535.0f) ? 65535 : (uint16_t)us;
+
+  /* Spark at the end of the dwell, injection timed from its start */
+  uint32_t at = (channel == CAPTURE_SPARK) ? pos : p->pos;
+  uint16_t angle = at * (activeWheel.wheel_degrees * 10UL) / cycle;
+  capture_add(channel, angle, width);
+}
+
+//! Sends one summary line: S or I, slot, count, angle avg, min, max, width avg, min, max
+static void capture_line(uint8_t channel, uint8_t slot)
+{
+  const struct capture_stats *s = &stats[channel][slot];
+
+  Serial.print(channel == CAPTURE_SPARK ? "S" : "I");
+  Serial.print(slot);
+  Serial.print(",");
+  Serial.print(s->count);
+  Serial.print(",");
+  Serial.print(s->count ? (int16_t)(s->angle_sum / s->count) : 0);
+  Serial.print(",");
+  Serial.print(s->angle_min);
+  Serial.print(",");
+  Serial.print(s->angle_max);
+  Serial.print(",");
+  Serial.print(s->count ? (uint16_t)(s->width_sum / s->count) : 0);
+  Serial.print(",");
+  Serial.print(s->width_min);
+  Serial.print(",");
+  Serial.println(s->width_max);
+}
+
+bool capture_task()
+{
+  if (!captureParams.enabled) { return false; }
+
+  for (uint8_t n = 0; (n < CAPTURE_BATCH) && (capture_tail != capture_head); n++)
+  {
+    uint8_t tail = capture_tail;
+    struct capture_raw r = capture_ring[tail];
+    capture_tail = (tail + 1) & (CAPTURE_RING - 1);
+    capture_event(&r);
+  }
+
+  if (captureParams.stream == 0) { return false; }
+  if ((stream_line == CAPTURE_NO_LINE) && (millis() - stream_last >= captureParams.stream * 100UL))
+  {
+    stream_last = millis();
+    stream_line = 0;
+  }
+  /* A line per pass, each slot starts over once it is sent */
+  uint8_t slots = capture_slots();
+  if (stream_line >= CAPTURE_CHANNELS * slots) { stream_line = CAPTURE_NO_LINE; } /* The wheel changed under it */
+  else if (Serial.availableForWrite() >= CAPTURE_LINE_MAX)
+  {
+    uint8_t channel = stream_line / slots;
+    uint8_t slot = stream_line % slots;
+    capture_line(channel, slot);
+    memset(&stats[channel][slot], 0, sizeof(struct capture_stats));
+    if (++stream_line == CAPTURE_CHANNELS * slots) { stream_line = CAPTURE_NO_LINE; }
+  }
+  return false;
+}
+
+//! Sends the capture state over serial
+/*!
+ * First line is enabled,cylinders,polarity,stream,slots,pulses,overruns
+ * (overruns are pin changes lost to a full ring)
+ * Then a line per slot for the spark, S0.., and the injector, I0..:
+ * count,angle_avg,angle_min,angle_max,width_avg,width_min,width_max
+ * Angles are tenths of a degree before TDC, widths us
+ */
+void capture_dump()
+{
+  uint8_t slots = capture_slots();
+
+  Serial.print(captureParams.enabled);
+  Serial.print(",");
+  Serial.print(captureParams.cylinders);
+  Serial.print(",");
+  Serial.print(captureParams.polarity);
+  Serial.print(",");
+  Serial.print(captureParams.stream);
+  Serial.print(",");
+  Serial.print(slots);
+  Serial.print(",");
+  Serial.print(events);
+  Serial.print(",");
+  Serial.println(capture_overruns);
+  for (uint8_t channel = 0; channel < CAPTURE_CHANNELS; channel++)
+  {
+    for (uint8_t slot = 0; slot < slots; slot++) { capture_line(channel, slot); }
+  }
+}
+
+#endif
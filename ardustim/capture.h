@@ -0,0 +1,126 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * ECU output capture
+ *
+ * Two inputs watch what the ECU under test does with the simulated engine:
+ * spark (coil) on A3 (PC3, PCINT11) and injector on D7 (PD7, PCINT23), each
+ * on its own pin change vector. The ISR does no maths, it snapshots TCNT1,
+ * OCR1A, the Timer1 prescaler, edge_counter and a pending pattern compare
+ * into a small ring. capture_task() turns each snapshot into a crank angle,
+ * the edge last written plus the fraction of the current edge period TCNT1
+ * has run, pairs the active and inactive edges of each pulse and adds them
+ * to per cylinder statistics:
+ *
+ *   spark: advance (angle of the spark edge before TDC) and dwell
+ *   injector: start of injection angle before TDC and pulse width
+ *
+ * TDC of the first cylinder is the wheel's first edge, the others evenly
+ * spaced over 720 degrees as for the knock windows. A 360 degree wheel can't
+ * tell cylinders a revolution apart, they share a slot. An event belongs to
+ * the TDC it falls between a quarter of the spacing after and three quarters
+ * before. Angles are tenths of a degree, widths microseconds worked out from
+ * the edge period at the end of the pulse, exact at a steady RPM.
+ *
+ * Pin change vectors come before TIMER1_COMPA, a capture can hold an edge up
+ * by the ~4us the ISR takes. Forward rotation only, events while the pattern
+ * runs backwards (direction.h) are dropped. ATmega328P pins.
+ *
+ * Compiles out completely unless built with -DENABLE_CAPTURE=1.
+ */
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#ifndef ENABLE_CAPTURE
+#define ENABLE_CAPTURE 0  // Default to disabled, costs ~450 bytes RAM
+#endif
+
+#if ENABLE_CAPTURE
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define CAPTURE_RING            16    /* Snapshots between the ISR and capture_task(), a power of 2 */
+#define CAPTURE_BATCH           4     /* Snapshots capture_task() works through per pass */
+#define CAPTURE_MAX_CYLINDERS   8
+#define CAPTURE_LINE_MAX        56    /* Longest summary line, streamed only when the TX buffer has room */
+
+enum {
+  CAPTURE_SPARK,          //A3, active level is dwell, the inactive edge the spark
+  CAPTURE_INJECTOR,       //D7, active level is the pulse
+  CAPTURE_CHANNELS
+};
+
+/* capture_raw.flags */
+#define CAPTURE_CHANNEL_MASK    0x01
+#define CAPTURE_LEVEL           0x02  /* Pin high after the change */
+#define CAPTURE_PENDING         0x04  /* Pattern compare matched, its ISR not run yet */
+
+/* capture_params.polarity */
+#define CAPTURE_SPARK_LOW       0x01  /* Dwell is low */
+#define CAPTURE_INJECTOR_LOW    0x02  /* Injector pulse is low */
+
+struct capture_params {
+  uint8_t enabled;
+  uint8_t cylinders;      //1..CAPTURE_MAX_CYLINDERS, evenly spaced over 720 degrees
+  uint8_t polarity;       //CAPTURE_SPARK_LOW | CAPTURE_INJECTOR_LOW
+  uint8_t stream;         //Summaries sent by themselves every stream x 100ms, 0 = only on 'e'
+};
+
+/* One pin change, as the ISR saw the pattern */
+struct capture_raw {
+  uint16_t tcnt;
+  uint16_t top;           //OCR1A
+  uint16_t edge;          //edge_counter
+  uint8_t cs;             //Timer1 clock select
+  uint8_t flags;
+};
+
+extern struct capture_params captureParams;
+
+/* Between the ISRs and capture_task() */
+extern struct capture_raw capture_ring[CAPTURE_RING];
+extern volatile uint8_t capture_head;
+extern volatile uint8_t capture_tail;
+extern volatile uint16_t capture_overruns;
+extern volatile uint16_t edge_counter;
+
+//! Makes the capture pins inputs, capture off
+void capture_init();
+
+//! Checks and applies capture settings, the statistics start over
+/*!
+ * @return false, nothing changed, if they are out of range
+ */
+bool capture_set(const struct capture_params *params);
+
+//! Works through the captured edges and streams summaries
+bool capture_task();
+
+//! Sends the capture settings and every slot's statistics over serial
+void capture_dump();
+
+//! Snapshots the pattern position for a pin change, pin change ISR context
+static inline void capture_record(uint8_t flags)
+{
+  uint16_t tcnt = TCNT1;  /* First, the closer to the pin change the better */
+  uint8_t head = capture_head;
+  uint8_t next = (head + 1) & (CAPTURE_RING - 1);
+
+  if (TIFR1 & (1 << OCF1A)) { flags |= CAPTURE_PENDING; }
+  if (next == capture_tail)
+  {
+    capture_overruns++;
+    return;
+  }
+  struct capture_raw *r = &capture_ring[head];
+  r->tcnt = tcnt;
+  r->top = OCR1A;
+  r->edge = edge_counter;
+  r->cs = TCCR1B & ((1 << CS10) | (1 << CS11) | (1 << CS12));
+  r->flags = flags;
+  capture_head = next;
+}
+
+#endif
+
+#endif
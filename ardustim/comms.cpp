@@ -25,16 +25,28 @@
 #include "comms.h"
 #include "storage.h"
 #include "wheel_defs.h"
+#include "wheel_gen.h"
+#include "cam_phase.h"
+#include "direction.h"
+#include "fault.h"
+#include "knock.h"
+#include "aux_out.h"
+#include "capture.h"
+#include "learn.h"
+#include "isr_jitter.h"
+#include "loop_profiler.h"
+#include "scheduler.h"
+#include "display_interface.h"
+#include "twi_master.h"
+#include "string_pool.h"
 #include <avr/pgmspace.h>
 #include <math.h>
 #include <util/delay.h>
 
 /* External Globla Variables */
-extern wheels Wheels[];
 
 /* Volatile variables (USED in ISR's) */
 extern volatile bool normal;
-extern volatile uint16_t edge_counter;
 extern volatile uint16_t new_OCR1A;
 
 bool cmdPending;
@@ -52,10 +64,30 @@ void serialSetup()
   cmdPending = false;
 }
 
-void commandParser()
+//! Handles one serial command
+/*!
+ * Long replies (the pattern dump) are sent a slice per call, cmdPending stays
+ * set and the call returns true until the reply is complete
+ * \return true while the current command has more to send
+ */
+bool commandParser()
 {
-  char buf[80];
+  char buf[21]; // Wheel names are sized for the 20 column LCD
   byte tmp_wheel;
+  byte tmp_mode;
+  uint16_t tmp_cycles;
+  struct gen_params tmp_params;
+  uint8_t gen_slices, gen_high;
+  int16_t tmp_phase;
+  struct fault_slot tmp_fault;
+  struct knock_params tmp_knock;
+  struct aux_params tmp_aux;
+#if ENABLE_CAPTURE
+  struct capture_params tmp_capture;
+#endif
+#if ENABLE_LEARN
+  uint8_t tmp_teeth;
+#endif
   void* pnt_Config = &config;
   if (cmdPending == false) { currentCommand = Serial.read(); }
 
@@ -64,6 +96,22 @@ void commandParser()
     case 'a':
       break;
 
+    case 'b': //Send the boot mode and timings: mode,first_edge_us,setup_us,ready_us
+      Serial.print(bootStatus.mode);
+      Serial.print(",");
+      Serial.print(bootStatus.first_edge_us);
+      Serial.print(",");
+      Serial.print(bootStatus.setup_us);
+      Serial.print(",");
+      Serial.println(bootStatus.ready_us);
+      break;
+
+    case 'B': //Set the boot mode (0 = animated, 1 = fast), saved with 's'
+      while(Serial.available() < 1) {}
+      tmp_mode = Serial.read();
+      if(tmp_mode < MAX_BOOT_MODES) { bootStatus.mode = tmp_mode; }
+      break;
+
     case 'c': //Receive a full config buffer
       //uint8_t targetBytes = (sizeof(struct configTable)-1); //No byte is sent for the version
       while(Serial.available() < (sizeof(struct configTable)-1) ) {} //Wait for all bytes
@@ -87,11 +135,220 @@ void commandParser()
       //Wheel names are then sent 1 per line
       for(byte x=0;x<MAX_WHEELS;x++)
       {
-        strcpy_P(buf,Wheels[x].decoder_name);
+        pool_wheel_name(x, buf, sizeof(buf));
         Serial.println(buf);
       }
       break;
 
+    case 'g': //Send the generated wheel: teeth,missing,duty,cam_tooth,cam_degrees,edges_per_tooth
+      gen_layout(&gen_slices, &gen_high);
+      Serial.print(genParams.teeth);
+      Serial.print(",");
+      Serial.print(genParams.missing);
+      Serial.print(",");
+      Serial.print(genParams.duty);
+      Serial.print(",");
+      Serial.print(genParams.cam_tooth);
+      Serial.print(",");
+      Serial.print(genParams.cam_degrees);
+      Serial.print(",");
+      Serial.println(gen_slices);
+      break;
+
+    case 'G': //Set and select the generated wheel: teeth, missing, duty, cam tooth, cam degrees, saved with 's'
+      while(Serial.available() < sizeof(tmp_params)) {}
+      for(uint8_t x=0; x<sizeof(tmp_params); x++)
+      {
+        *((uint8_t *)&tmp_params + x) = Serial.read();
+      }
+      if(gen_params_valid(&tmp_params))
+      {
+        genParams = tmp_params;
+        gen_forget_learned();
+        config.wheel = GENERATED_WHEEL;
+        display_new_wheel();
+      }
+      break;
+
+    case 'v': //Send the cam phase in tenths of a degree, positive is advance: now,target,slew_per_s
+      Serial.print(cam_phase_now());
+      Serial.print(",");
+      Serial.print(cam_phase_target());
+      Serial.print(",");
+      Serial.println(cam_phase_slew());
+      break;
+
+    case 'V': //Set the cam phase target and the tenths of a degree per second to slew there at, 0 = jump
+      while(Serial.available() < 4) {} //Wait for the 2 byte target and 2 byte slew rate
+      tmp_phase = Serial.read() << 8;
+      tmp_phase |= Serial.read();
+      tmp_cycles = Serial.read() << 8;
+      tmp_cycles |= Serial.read();
+      cam_phase_set(tmp_phase, tmp_cycles);
+      break;
+
+    case 'd': //Send the direction (0 = forwards, 1 = backwards) and the rock-back teeth left
+      Serial.print(direction_reversed());
+      Serial.print(",");
+      Serial.println(direction_rock_back_left());
+      break;
+
+    case 'D': //Rock back: 0 = forwards, 1-254 = that many crank teeth backwards then forwards, 255 = backwards
+      while(Serial.available() < 1) {}
+      direction_rock_back(Serial.read());
+      break;
+
+    case 'f': //Send the fault slots, their injection counters and the log of cycles with faults
+      fault_dump();
+      break;
+
+    case 'F': //Set a fault slot: slot, type, arg, every, chance, count, slot 255 disarms all and clears the counters
+      while(Serial.available() < 6) {}
+      tmp_mode = Serial.read();
+      for(uint8_t x=0; x<sizeof(tmp_fault); x++)
+      {
+        *((uint8_t *)&tmp_fault + x) = Serial.read();
+      }
+      if(tmp_mode == 255) { fault_clear(); }
+      else { fault_set(tmp_mode, &tmp_fault); }
+      break;
+
+    case 'k': //Send the knock settings: enabled,freq_hz (as made by Timer2),cylinders,start,width,mask,gates
+      Serial.print(knockParams.enabled);
+      Serial.print(",");
+      Serial.print(knock_freq_actual());
+      Serial.print(",");
+      Serial.print(knockParams.cylinders);
+      Serial.print(",");
+      Serial.print(knockParams.start);
+      Serial.print(",");
+      Serial.print(knockParams.width);
+      Serial.print(",");
+      Serial.print(knockParams.mask);
+      Serial.print(",");
+      Serial.println(knock_gate_count);
+      break;
+
+    case 'K': //Set knock: enabled, freq (2 bytes, high first), cylinders, start degrees, width degrees, cylinder mask
+      while(Serial.available() < 7) {}
+      tmp_knock.enabled = Serial.read();
+      tmp_knock.freq = Serial.read() << 8;
+      tmp_knock.freq |= Serial.read();
+      tmp_knock.cylinders = Serial.read();
+      tmp_knock.start = Serial.read();
+      tmp_knock.width = Serial.read();
+      tmp_knock.mask = Serial.read();
+      knock_set(&tmp_knock);
+      break;
+
+    case 't': //Send the tach and VSS: tach_ppr,vss_mode,vss_hz,vss_teeth,gear_ratio,vss_hz_now
+      Serial.print(auxParams.tach_ppr);
+      Serial.print(",");
+      Serial.print(auxParams.vss_mode);
+      Serial.print(",");
+      Serial.print(auxParams.vss_hz);
+      Serial.print(",");
+      Serial.print(auxParams.vss_teeth);
+      Serial.print(",");
+      Serial.print(auxParams.gear_ratio);
+      Serial.print(",");
+      Serial.println(aux_vss_hz());
+      break;
+
+    case 'T': //Set tach and VSS: tach ppr, VSS mode, VSS Hz (2 bytes), VSS teeth, gear ratio x100 (2 bytes), high bytes first
+      while(Serial.available() < 7) {}
+      tmp_aux.tach_ppr = Serial.read();
+      tmp_aux.vss_mode = Serial.read();
+      tmp_aux.vss_hz = Serial.read() << 8;
+      tmp_aux.vss_hz |= Serial.read();
+      tmp_aux.vss_teeth = Serial.read();
+      tmp_aux.gear_ratio = Serial.read() << 8;
+      tmp_aux.gear_ratio |= Serial.read();
+      aux_set(&tmp_aux);
+      break;
+
+#if ENABLE_CAPTURE
+    case 'e': //Send the ECU output capture settings and per cylinder spark and injector statistics
+      capture_dump();
+      break;
+
+    case 'E': //Set ECU output capture: enabled, cylinders, polarity, stream period x 100ms, clears the statistics
+      while(Serial.available() < 4) {}
+      for(uint8_t x=0; x<sizeof(tmp_capture); x++)
+      {
+        *((uint8_t *)&tmp_capture + x) = Serial.read();
+      }
+      capture_set(&tmp_capture);
+      break;
+
+#endif
+#if ENABLE_LEARN
+    case 'u': //Send the learn state: state,result,events,teeth,units,divs,cam,degrees,edges, then the learned wheel as a wheel_defs.h entry
+      if (learn_report()) { cmdPending = true; return true; }
+      break;
+
+    case 'U': //Learn a wheel from D7 (crank) and A3 (cam): teeth per crank period for evenly spaced teeth (0 = from the cam), cycle (255 stops)
+      while(Serial.available() < 2) {}
+      tmp_teeth = Serial.read();
+      learn_start(tmp_teeth, Serial.read());
+      break;
+
+#endif
+    case 'i': //Send the pattern ISR cost in CPU cycles the RPM limits are based on
+      Serial.println(getISRCycles());
+      break;
+
+    case 'I': //Forget the measured pattern ISR cost, the ISR times itself again from here
+      resetISRCycles();
+      break;
+
+#if ENABLE_ISR_JITTER
+    case 'j': //Send the pattern ISR latency histogram
+      jitter_dump();
+      break;
+
+    case 'J': //Reset the pattern ISR latency histogram
+      jitter_reset();
+      break;
+
+#endif
+#if ENABLE_LOOP_PROFILER
+    case 'o': //Send the main loop profile
+      profiler_dump();
+      break;
+
+    case 'O': //Reset the main loop profile
+      profiler_reset();
+      break;
+
+#endif
+    case 'q': //Send the loop() task table: label,period_ms,budget_us,worst_us,overruns
+      scheduler_dump();
+      break;
+
+    case 'Q': //Reset the task overrun counters
+      scheduler_reset();
+      break;
+
+#if LCD_DRIVER == LCD_DRIVER_TWI
+    case 'l': //Send the LCD bus counters: bytes,nacks,bus_errors,timeouts
+      twi_dump();
+      break;
+
+#endif
+    case 'm': //Send the maximum RPM of the current wheel
+      Serial.println(currentStatus.max_rpm);
+      break;
+
+    case 'M': //Send the maximum RPM of every wheel, 1 per line
+      tmp_cycles = getISRCycles();
+      for(byte x=0;x<GENERATED_WHEEL;x++)
+      {
+        Serial.println(max_rpm_for_isr_cycles(pgm_read_float(&Wheels[x].rpm_scaler), tmp_cycles));
+      }
+      Serial.println(max_rpm_for_isr_cycles(gen_rpm_scaler(), tmp_cycles)); //No table, scaler from genParams
+      break;
+
     case 'n': //Send the number of wheels
       Serial.println(MAX_WHEELS);
       break;
@@ -101,20 +358,11 @@ void commandParser()
       break;
     
     case 'p': //Send the size of the current wheel
-      Serial.println(Wheels[config.wheel].wheel_max_edges);
+      Serial.println(activeWheel.wheel_max_edges);
       break;
 
     case 'P': //Send the pattern for the current wheel
-      for(uint16_t x=0; x<Wheels[config.wheel].wheel_max_edges; x++)
-      {
-        if(x != 0) { Serial.print(","); }
-
-        byte tempByte = pgm_read_byte(&Wheels[config.wheel].edge_states_ptr[x]);
-        Serial.print(tempByte);
-      }
-      Serial.println("");
-      //2nd row of data sent is the number of degrees the wheel runs over (360 or 720 typically)
-      Serial.println(Wheels[config.wheel].wheel_degrees);
+      if (sendPatternSlice()) { cmdPending = true; return true; }
       break;
 
     case 'R': //Send the current RPM
@@ -149,7 +397,7 @@ void commandParser()
 
     case 'X': //Just a test method for switching the to the next wheel
       select_next_wheel_cb();
-      strcpy_P(buf,Wheels[config.wheel].decoder_name);
+      pool_wheel_name(config.wheel, buf, sizeof(buf));
       Serial.println(buf);
       break;
 
@@ -157,6 +405,33 @@ void commandParser()
       break;
   }
   cmdPending = false;
+  return false;
+}
+
+//! Sends as much of the current wheel's pattern as fits in the serial TX buffer
+/*!
+ * Never blocks on the UART, a 720 edge pattern would otherwise hold up loop()
+ * for a quarter of a second
+ * \return true if there's more of the pattern left to send
+ */
+bool sendPatternSlice()
+{
+  static uint16_t x = 0;
+
+  while(x < activeWheel.wheel_max_edges)
+  {
+    if(Serial.availableForWrite() < 4) { return true; } //Room for "," and up to 3 digits
+    if(x != 0) { Serial.print(","); }
+
+    byte tempByte = active_edge_state(x);
+    Serial.print(tempByte);
+    x++;
+  }
+  x = 0;
+  Serial.println("");
+  //2nd row of data sent is the number of degrees the wheel runs over (360 or 720 typically)
+  Serial.println(activeWheel.wheel_degrees);
+  return false;
 }
 
 /* Helper function to spit out amount of ram remainig */
@@ -187,10 +462,17 @@ void toggle_invert_secondary_cb()
   output_invert_mask ^= 0x02; /* Flip cam invert mask bit */
 }
 
+//! Reverses the direction the wheel turns in
+void reverse_wheel_direction_cb()
+{
+  direction_set(!direction_reversed());
+}
+
 void display_new_wheel()
 {
+  load_wheel(); // Also resets to the beginning of the wheel pattern
+  updateMaxRPM();
   reset_new_OCR1A(currentStatus.rpm);
-  edge_counter = 0; // Reset to beginning of the wheel pattern */
 }
 
 
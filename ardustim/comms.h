@@ -24,8 +24,12 @@
 #include <Arduino.h>
 /* Structures */
 
+/* Command parser state */
+extern bool cmdPending;
+
 /* Prototypes */
-void commandParser();
+bool commandParser();
+bool sendPatternSlice();
 void show_info_cb();
 void select_next_wheel_cb();
 void select_previous_wheel_cb();
@@ -0,0 +1,75 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Rotation direction and rock-back events
+ *
+ * See direction.h
+ */
+
+#include "direction.h"
+#include "cam_phase.h"
+#include <Arduino.h>
+
+volatile uint8_t rock_back_teeth = 0;
+volatile uint8_t rock_back_crank = 0;
+
+void direction_flip()
+{
+  uint16_t edges = activeWheel.wheel_max_edges;
+  uint16_t c = edge_counter;
+  bool reverse = !(GPIOR0 & (1 << DIRECTION_BIT));
+
+  /* Retrace the edge just written, 2 back from the next forward edge or 2
+   * on from the next backward one */
+  if (reverse)
+  {
+    c = (c >= 2) ? c - 2 : c + edges - 2;
+    GPIOR0 |= (1 << DIRECTION_BIT);
+    /* The crank bit of the edge just written, a tooth under the sensor isn't counted */
+    rock_back_crank = active_edge_state(c + 1 < edges ? c + 1 : c + 1 - edges) & 1;
+  }
+  else
+  {
+    c = (c + 2 < edges) ? c + 2 : c + 2 - edges;
+    GPIOR0 &= ~(1 << DIRECTION_BIT);
+    rock_back_teeth = 0;
+  }
+  edge_counter = c;
+  if (GPIOR0 & (1 << CAM_PHASE_BIT)) { cam_phase_flip(reverse); }
+}
+
+void direction_set(bool reverse)
+{
+  noInterrupts();
+  rock_back_teeth = 0;
+  if (reverse != direction_reversed()) { direction_flip(); }
+  interrupts();
+}
+
+void direction_rock_back(uint8_t teeth)
+{
+  if ((teeth == 0) || (teeth == ROCK_BACK_FOREVER))
+  {
+    direction_set(teeth == ROCK_BACK_FOREVER);
+    return;
+  }
+  noInterrupts();
+  if (!direction_reversed()) { direction_flip(); }
+  rock_back_teeth = teeth;
+  interrupts();
+}
+
+bool direction_reversed()
+{
+  return (GPIOR0 & (1 << DIRECTION_BIT)) != 0;
+}
+
+uint8_t direction_rock_back_left()
+{
+  return rock_back_teeth;
+}
+
+void direction_reload()
+{
+  GPIOR0 &= ~(1 << DIRECTION_BIT);
+  rock_back_teeth = 0;
+}
@@ -0,0 +1,83 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Rotation direction and rock-back events
+ *
+ * With DIRECTION_BIT set the pattern ISR walks the edge table backwards, the
+ * wheel turning the wrong way (backfire, kick-back). A direction change
+ * retraces the edge just written: forward had last written edge e and goes
+ * on with e+1, reversed it goes on with e-1 (and the other way round), so the
+ * outputs show what a sensor would see from a wheel stopping mid-tooth and
+ * coming back.
+ *
+ * A rock-back runs the wheel backwards for a number of crank teeth, counted
+ * as crank output rising edges, and the ISR turns it forward again by itself,
+ * like an engine rocking back against compression as it stops.
+ *
+ * Running forward the ISR pays a single GPIOR0 bit test for all of this.
+ *
+ * Backwards, the cycle timing used by calculateCurrentCrankAngle() restarts
+ * where the walk wraps to the last edge, so the compression modifier keeps
+ * following the wheel at the same rate rather than being held off.
+ */
+#ifndef __DIRECTION_H__
+#define __DIRECTION_H__
+
+#include <stdint.h>
+#include <avr/io.h>
+#include "globals.h"
+
+#define DIRECTION_BIT     2     /* GPIOR0 bit, set while running backwards (see wheel_gen.h, cam_phase.h) */
+#define ROCK_BACK_FOREVER 255   /* Rock-back teeth that mean reverse until told otherwise */
+
+extern volatile uint16_t edge_counter;
+extern volatile uint32_t cycleStartTime;
+extern volatile uint32_t cycleDuration;
+extern volatile uint8_t rock_back_teeth;  /* Crank teeth left to run backwards, 0 = reversed until told otherwise */
+extern volatile uint8_t rock_back_crank;  /* Crank bit of the last edge written backwards */
+
+//! Reverses the direction at the current edge, interrupts off or ISR context
+void direction_flip();
+
+//! Runs the wheel forwards or backwards until told otherwise
+void direction_set(bool reverse);
+
+//! Runs the wheel backwards for teeth crank teeth, then forwards again
+/*!
+ * @param teeth 1..254, ROCK_BACK_FOREVER is direction_set(true), 0 is direction_set(false)
+ */
+void direction_rock_back(uint8_t teeth);
+
+//! True while running backwards
+bool direction_reversed();
+
+//! Crank teeth left of the rock-back in progress, 0 if none
+uint8_t direction_rock_back_left();
+
+//! Back to forwards for a new wheel, called by load_wheel() with interrupts off
+void direction_reload();
+
+//! Steps edge_counter back after states was written, pattern ISR context
+static inline void direction_edge(uint8_t states)
+{
+  uint16_t c = edge_counter;
+  if (c == 0)
+  {
+    cycleDuration = micros() - cycleStartTime;
+    cycleStartTime = micros();
+    c = activeWheel.wheel_max_edges;
+  }
+  edge_counter = c - 1;
+
+  if (rock_back_teeth)
+  {
+    uint8_t crank = states & 1;
+    if (crank && !rock_back_crank && (--rock_back_teeth == 0))
+    {
+      direction_flip();
+      return;
+    }
+    rock_back_crank = crank;
+  }
+}
+
+#endif
@@ -11,6 +11,30 @@
 #define __DISPLAY_INTERFACE_H__
 
 #include <stdint.h>
+#include <string.h>
+
+/**
+ * I2C LCD Display Configuration, shared by the drivers
+ */
+#define LCD_I2C_ADDRESS 0x3F   // Try 0x3F if 0x27 doesn't work
+#define LCD_COLUMNS 20          // 20x4 LCD display
+#define LCD_ROWS 4
+
+/**
+ * LCD driver selection (-DLCD_DRIVER=...)
+ */
+#define LCD_DRIVER_WIRE 0       // LCDDisplay: LiquidCrystal_I2C on Wire, blocking
+#define LCD_DRIVER_TWI  1       // TwiLcdDisplay: interrupt driven TWI queue, non-blocking
+#ifndef LCD_DRIVER
+#define LCD_DRIVER LCD_DRIVER_TWI
+#endif
+
+/**
+ * Hot-plug: a display that stops answering is re-probed after
+ * LCD_REPROBE_MIN_MS, doubling up to LCD_REPROBE_MAX_MS while it stays away
+ */
+#define LCD_REPROBE_MIN_MS  250
+#define LCD_REPROBE_MAX_MS  8000
 
 /**
  * Abstract base class for display hardware abstraction
@@ -26,6 +50,14 @@ public:
      */
     virtual bool init() = 0;
     
+    /**
+     * Start the display without waiting for it, poll() finishes bringing it
+     * up. Drivers that can't do that in the background just init()
+     */
+    virtual void start() {
+        init();
+    }
+    
     /**
      * Clear the entire display
      */
@@ -50,6 +82,40 @@ public:
      */
     virtual void print(int value) = 0;
     
+    /**
+     * Write a run of characters starting at a position
+     * Drivers that can batch the cursor move and data override this
+     * @param col Column position (0-based)
+     * @param row Row position (0-based)
+     * @param text Characters to write, not null-terminated
+     * @param len Number of characters (at most 20)
+     */
+    virtual void write(uint8_t col, uint8_t row, const char* text, uint8_t len) {
+        char run[21];
+        if (len > sizeof(run) - 1) len = sizeof(run) - 1;
+        memcpy(run, text, len);
+        run[len] = '\0';
+        setCursor(col, row);
+        print(run);
+    }
+    
+    /**
+     * Check if a write() of len characters can be taken without blocking
+     * @param len Number of characters
+     * @return true if write() would return immediately
+     */
+    virtual bool canWrite(uint8_t len) {
+        (void)len;
+        return true;
+    }
+    
+    /**
+     * Periodic housekeeping, call every loop pass: notices a display that
+     * stopped answering and re-probes/re-initialises it on a back-off
+     * schedule. Must return quickly while the display is missing
+     */
+    virtual void poll() {}
+    
     /**
      * Check if display hardware is available and functional
      * @return true if display is available, false otherwise
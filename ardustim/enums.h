@@ -43,4 +43,10 @@ enum {
   MAX_MODES,
 };
 
+enum {
+  BOOT_ANIMATED,  /* Startup screens (~10s) before the main screen */
+  BOOT_FAST,      /* Straight to the main screen, LCD brought up in the background */
+  MAX_BOOT_MODES,
+};
+
 #endif
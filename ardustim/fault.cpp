@@ -0,0 +1,368 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Fault injection
+ *
+ * See fault.h
+ */
+
+#include "fault.h"
+#include "cam_phase.h"
+#include <Arduino.h>
+#include <string.h>
+
+/* Cycles with faults, for 'f' */
+struct fault_log_entry {
+  uint16_t cycle;
+  uint8_t slots;
+};
+
+static const struct fault_schedule no_faults = { 0, 0, 0xFF, false, {}, {} };
+
+const struct fault_schedule * volatile fault_play = &no_faults;
+volatile uint16_t fault_at = FAULT_NO_EDGE;
+volatile uint8_t fault_idx = 0;
+volatile uint8_t fault_left = 0;
+volatile uint8_t fault_and = 0xFF;
+volatile uint8_t fault_or = 0;
+volatile uint8_t fault_jitter_idx = 0;
+
+/* Between fault_task() and fault_cycle() */
+static const struct fault_schedule * volatile fault_next = NULL;     /* Built, waiting for the table to wrap */
+static const struct fault_schedule * volatile fault_started = NULL;  /* Swapped in, not accounted yet */
+static volatile uint16_t fault_started_cycle;
+static volatile uint16_t fault_cycles = 0;                           /* Wheel cycles since fault_clear() */
+
+static struct fault_schedule schedules[2];
+static uint8_t build = 0;                     /* Schedule built next, the other may be playing */
+
+static struct fault_slot slots[FAULT_SLOTS];
+static struct fault_edit slot_edit[FAULT_SLOTS];  /* FAULT_DROP and FAULT_EXTRA on the active wheel */
+static uint16_t injected[FAULT_SLOTS];
+static uint8_t slot_phase[FAULT_SLOTS];       /* Cycles since the slot was last due */
+static uint8_t unmapped = 0;                  /* Bit per slot whose tooth isn't on the active wheel */
+static bool mapped = false;
+static uint8_t blank_left = 0;                /* Cycles of cam blanking still to build */
+static uint8_t jitter_pct = 0;
+
+static struct fault_log_entry fault_log[FAULT_LOG];
+static uint8_t log_head = 0;
+static uint16_t rand_state = 0xACE1;
+
+//! 16 bit xorshift, plenty for picking which cycles get a fault
+static uint16_t fault_random()
+{
+  rand_state ^= rand_state << 7;
+  rand_state ^= rand_state >> 9;
+  rand_state ^= rand_state << 8;
+  return rand_state;
+}
+
+bool fault_set(uint8_t slot, const struct fault_slot *config)
+{
+  if ((slot >= FAULT_SLOTS) || (config->type >= MAX_FAULT_TYPES)) { return false; }
+  slots[slot] = *config;
+  if (slots[slot].type == FAULT_JITTER && slots[slot].arg > FAULT_JITTER_MAX) { slots[slot].arg = FAULT_JITTER_MAX; }
+  if (slots[slot].chance > 100) { slots[slot].chance = 100; }
+  injected[slot] = 0;
+  slot_phase[slot] = 0;
+  mapped = false;
+  return true;
+}
+
+void fault_clear()
+{
+  noInterrupts();
+  memset(slots, 0, sizeof(slots));
+  memset(injected, 0, sizeof(injected));
+  memset(fault_log, 0, sizeof(fault_log));
+  log_head = 0;
+  blank_left = 0;
+  fault_cycles = 0;
+  fault_next = NULL;
+  fault_started = NULL;
+  interrupts();
+}
+
+void fault_reload()
+{
+  GPIOR0 &= ~(1 << FAULT_BIT);
+  fault_play = &no_faults;
+  fault_next = NULL;
+  fault_started = NULL;
+  fault_at = FAULT_NO_EDGE;
+  fault_left = 0;
+  mapped = false;
+}
+
+void fault_cycle()
+{
+  const struct fault_schedule *play = fault_next;
+
+  fault_cycles++;
+  if (play)
+  {
+    fault_next = NULL;
+    fault_started = play;
+    fault_started_cycle = fault_cycles;
+  }
+  else
+  {
+    /* fault_task() fell behind, a clean cycle rather than a replayed one */
+    play = &no_faults;
+  }
+  fault_play = play;
+  fault_idx = 0;
+  fault_jitter_idx = 0;
+  fault_at = play->edits ? play->edit[0].edge : FAULT_NO_EDGE;
+  /* fault_left carries on, a tooth can straddle the end of the table */
+}
+
+//! Finds the edges of the FAULT_DROP and FAULT_EXTRA teeth on the active wheel
+static void fault_map()
+{
+  uint16_t edges = activeWheel.wheel_max_edges;
+
+  unmapped = 0;
+  for (uint8_t i = 0; i < FAULT_SLOTS; i++)
+  {
+    uint8_t type = slots[i].type;
+    if ((type != FAULT_DROP) && (type != FAULT_EXTRA)) { continue; }
+
+    /* Rising crank edge of tooth arg, counted from edge 0 */
+    uint8_t tooth = 0;
+    uint16_t rise = FAULT_NO_EDGE;
+    uint8_t prev = active_edge_state(edges - 1) & 1;
+    for (uint16_t e = 0; e < edges; e++)
+    {
+      uint8_t crank = active_edge_state(e) & 1;
+      if (crank && !prev && (++tooth == slots[i].arg))
+      {
+        rise = e;
+        break;
+      }
+      prev = crank;
+    }
+    if (rise == FAULT_NO_EDGE)
+    {
+      unmapped |= (1 << i);
+      continue;
+    }
+
+    /* Lengths of the tooth and the low time after it */
+    uint16_t high = 0, low = 0;
+    uint16_t e = rise;
+    while ((high < edges) && (active_edge_state(e) & 1))
+    {
+      high++;
+      if (++e == edges) { e = 0; }
+    }
+    uint16_t fall = e;
+    while ((high + low < edges) && !(active_edge_state(e) & 1))
+    {
+      low++;
+      if (++e == edges) { e = 0; }
+    }
+
+    struct fault_edit *ed = &slot_edit[i];
+    ed->len = 1;
+    if (type == FAULT_DROP)
+    {
+      ed->edge = rise;
+      ed->len = (high > 255) ? 255 : high;
+      ed->and_mask = 0xFE;
+      ed->or_mask = 0;
+    }
+    else if (low >= 3)
+    {
+      /* A pulse in the middle of the gap */
+      ed->edge = (fall + low / 2) % edges;
+      ed->and_mask = 0xFF;
+      ed->or_mask = 1;
+    }
+    else if (high >= 3)
+    {
+      /* A notch in the middle of the tooth, two teeth where there was one */
+      ed->edge = (rise + high / 2) % edges;
+      ed->and_mask = 0xFE;
+      ed->or_mask = 0;
+    }
+    else
+    {
+      unmapped |= (1 << i);
+    }
+  }
+  mapped = true;
+}
+
+//! Adds an edit keeping the list sorted by edge
+/*!
+ * An edit starting on the same edge as one already there is dropped, the ISR
+ * only looks for each start once
+ */
+static bool fault_add_edit(struct fault_schedule *s, const struct fault_edit *ed)
+{
+  uint8_t n = s->edits;
+
+  for (uint8_t i = 0; i < n; i++)
+  {
+    if (s->edit[i].edge == ed->edge) { return false; }
+  }
+  while (n && (s->edit[n - 1].edge > ed->edge))
+  {
+    s->edit[n] = s->edit[n - 1];
+    n--;
+  }
+  s->edit[n] = *ed;
+  s->edits++;
+  return true;
+}
+
+//! Decides which slots fire in the next cycle and writes its schedule
+static void fault_build(struct fault_schedule *s)
+{
+  s->slots = 0;
+  s->edits = 0;
+  s->states_mask = 0xFF;
+  s->jitter = false;
+
+  for (uint8_t i = 0; i < FAULT_SLOTS; i++)
+  {
+    struct fault_slot *f = &slots[i];
+    if ((f->type == FAULT_NONE) || (f->every == 0)) { continue; }
+    if (++slot_phase[i] < f->every) { continue; }
+    slot_phase[i] = 0;
+    if ((f->chance < 100) && ((fault_random() % 100) >= f->chance)) { continue; }
+
+    switch (f->type)
+    {
+      case FAULT_DROP:
+      case FAULT_EXTRA:
+        if ((unmapped & (1 << i)) || !fault_add_edit(s, &slot_edit[i])) { continue; }
+        break;
+
+      case FAULT_CAM_BLANK:
+        blank_left = f->arg ? f->arg : 1;
+        break;
+
+      case FAULT_JITTER:
+        s->jitter = true;
+        jitter_pct = f->arg;
+        break;
+    }
+    s->slots |= (1 << i);
+    if (f->count && (--f->count == 0)) { f->every = 0; }
+  }
+
+  if (blank_left)
+  {
+    s->states_mask = ~CAM_PINS;
+    blank_left--;
+  }
+  if (s->jitter)
+  {
+    /* Each offset and its negative, in the two halves of the ring */
+    uint8_t amp = (uint16_t)jitter_pct * FAULT_JITTER_ONE / 100;
+    for (uint8_t i = 0; i < FAULT_JITTER_RING / 2; i++)
+    {
+      int8_t q = fault_random() % (amp + 1);
+      if (fault_random() & 1) { q = -q; }
+      s->jitter_ring[i] = q;
+      s->jitter_ring[i + FAULT_JITTER_RING / 2] = -q;
+    }
+  }
+}
+
+//! Counts the slots of a cycle that started playing and logs it
+static void fault_account(const struct fault_schedule *s, uint16_t cycle)
+{
+  if (s->slots == 0) { return; }
+  for (uint8_t i = 0; i < FAULT_SLOTS; i++)
+  {
+    if (s->slots & (1 << i)) { injected[i]++; }
+  }
+  fault_log[log_head].cycle = cycle;
+  fault_log[log_head].slots = s->slots;
+  log_head = (log_head + 1) & (FAULT_LOG - 1);
+}
+
+bool fault_task()
+{
+  bool armed = (blank_left != 0);
+
+  for (uint8_t i = 0; i < FAULT_SLOTS; i++)
+  {
+    if ((slots[i].type != FAULT_NONE) && slots[i].every) { armed = true; }
+  }
+  if (!armed && (fault_play == &no_faults) && !fault_next && !fault_started)
+  {
+    /* Nothing left to play, back to the plain pattern */
+    noInterrupts();
+    GPIOR0 &= ~(1 << FAULT_BIT);
+    fault_left = 0;
+    interrupts();
+    return false;
+  }
+  if (activeWheel.wheel_max_edges == 0) { return false; }
+  if (!mapped) { fault_map(); }
+
+  noInterrupts();
+  GPIOR0 |= (1 << FAULT_BIT);
+  const struct fault_schedule *started = fault_started;
+  uint16_t cycle = fault_started_cycle;
+  fault_started = NULL;
+  bool waiting = (fault_next != NULL);
+  interrupts();
+
+  if (started) { fault_account(started, cycle); }
+  if (!waiting && armed)
+  {
+    /* The older buffer, the newer one may still be playing */
+    struct fault_schedule *s = &schedules[build];
+    build ^= 1;
+    fault_build(s);
+    noInterrupts();
+    fault_next = s;
+    interrupts();
+  }
+  return false;
+}
+
+//! Sends the fault state over serial
+/*!
+ * First line is wheel cycles played with a slot armed since the last clear
+ * Then one line per slot: type,arg,every,chance,count,injected,mapped
+ * (mapped is 0 for a tooth the active wheel doesn't have)
+ * Last line is the logged cycles with faults, oldest first, as cycle:slot_bits
+ */
+void fault_dump()
+{
+  Serial.println(fault_cycles);
+  for (uint8_t i = 0; i < FAULT_SLOTS; i++)
+  {
+    Serial.print(slots[i].type);
+    Serial.print(",");
+    Serial.print(slots[i].arg);
+    Serial.print(",");
+    Serial.print(slots[i].every);
+    Serial.print(",");
+    Serial.print(slots[i].chance);
+    Serial.print(",");
+    Serial.print(slots[i].count);
+    Serial.print(",");
+    Serial.print(injected[i]);
+    Serial.print(",");
+    Serial.println((unmapped & (1 << i)) ? 0 : 1);
+  }
+  bool first = true;
+  for (uint8_t n = 0; n < FAULT_LOG; n++)
+  {
+    const struct fault_log_entry *l = &fault_log[(log_head + n) & (FAULT_LOG - 1)];
+    if (l->slots == 0) { continue; }
+    if (!first) { Serial.print(","); }
+    Serial.print(l->cycle);
+    Serial.print(":");
+    Serial.print(l->slots);
+    first = false;
+  }
+  Serial.println();
+}
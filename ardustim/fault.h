@@ -0,0 +1,166 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Fault injection
+ *
+ * Up to FAULT_SLOTS faults, each one of:
+ *   FAULT_DROP       crank tooth arg (1 = first rising crank edge of the table) missing
+ *   FAULT_EXTRA      an extra crank pulse after tooth arg, in its low time if
+ *                    that is 3 edges or more (a gap), else splitting the tooth
+ *   FAULT_CAM_BLANK  cam outputs held low for arg wheel cycles
+ *   FAULT_JITTER     every edge period of the cycle moved by up to +-arg percent,
+ *                    FAULT_JITTER_MAX at most
+ * firing every `every` wheel cycles (one pass of the edge table), with a
+ * `chance` percent probability when due, `count` times (0 = no limit).
+ *
+ * The pattern ISR doesn't decide anything. fault_task() builds the next
+ * cycle's schedule ahead of time: a short list of edge ranges with the AND/OR
+ * masks to apply, sorted by edge, the mask for every edge (cam blanking) and a
+ * ring of period offsets that sums to zero, so the RPM is unchanged on
+ * average (short of the clamps at either end, see fault_period()). The
+ * offsets are fractions of the period rather than Timer1 counts, an RPM or
+ * prescaler change while the cycle plays keeps them in scale. The ISR swaps
+ * the schedule in when the table wraps and per edge only compares
+ * edge_counter against the next range. Schedules are double buffered, one
+ * playing while the next is built.
+ *
+ * A slot is counted when a cycle carrying it starts playing, and the last
+ * FAULT_LOG cycles with faults are kept, see serial 'f'. Faults follow the
+ * forward pattern, a cycle only starts on a forward wrap.
+ */
+#ifndef __FAULT_H__
+#define __FAULT_H__
+
+#include <stdint.h>
+#include <avr/io.h>
+#include "globals.h"
+#include "timer_math.h"
+
+#define FAULT_BIT           3       /* GPIOR0 bit, set while any slot is armed (see wheel_gen.h, direction.h) */
+#define FAULT_SLOTS         4
+#define FAULT_JITTER_RING   8       /* Period offsets per schedule, a power of two */
+#define FAULT_JITTER_MAX    50      /* Percent of the edge period */
+#define FAULT_JITTER_ONE    128     /* A whole edge period in the jitter ring */
+#define FAULT_JITTER_MIN_OCR (2 * ISR_CYCLES_ESTIMATE) /* Shortest jittered edge period, Timer1 counts */
+#define FAULT_LOG           8       /* Cycles with faults kept for 'f', a power of two */
+#define FAULT_NO_EDGE       0xFFFF
+
+enum {
+  FAULT_NONE,
+  FAULT_DROP,
+  FAULT_EXTRA,
+  FAULT_CAM_BLANK,
+  FAULT_JITTER,
+  MAX_FAULT_TYPES
+};
+
+/* One configured fault */
+struct fault_slot {
+  uint8_t type;         //FAULT_x
+  uint8_t arg;          //Tooth, cycles or percent, see above
+  uint8_t every;        //Wheel cycles between firings, 0 = slot off
+  uint8_t chance;       //Percent chance of firing when due
+  uint8_t count;        //Firings left, 0 = no limit
+};
+
+/* One range of edges with its output masks */
+struct fault_edit {
+  uint16_t edge;
+  uint8_t len;
+  uint8_t and_mask;
+  uint8_t or_mask;
+};
+
+/* What one wheel cycle gets */
+struct fault_schedule {
+  uint8_t slots;                  //Bit per slot that fires in this cycle
+  uint8_t edits;
+  uint8_t states_mask;            //ANDed into every edge
+  bool jitter;
+  struct fault_edit edit[FAULT_SLOTS];
+  int8_t jitter_ring[FAULT_JITTER_RING];  //Period offsets, /FAULT_JITTER_ONE
+};
+
+extern volatile uint16_t edge_counter;
+
+/* Pattern ISR state, see fault_edge() */
+extern const struct fault_schedule * volatile fault_play;
+extern volatile uint16_t fault_at;        /* Edge the next range starts on */
+extern volatile uint8_t fault_idx;        /* Next range in fault_play */
+extern volatile uint8_t fault_left;       /* Edges left of the range being applied */
+extern volatile uint8_t fault_and;
+extern volatile uint8_t fault_or;
+extern volatile uint8_t fault_jitter_idx;
+
+//! Sets a slot up, clearing its counters
+/*!
+ * @return false if slot or type are out of range
+ */
+bool fault_set(uint8_t slot, const struct fault_slot *config);
+
+//! Disarms every slot and clears the counters and the log
+void fault_clear();
+
+//! Sends the slots, counters and log over serial, see README
+void fault_dump();
+
+//! Forgets the schedules and the tooth positions, called by load_wheel() with interrupts off
+void fault_reload();
+
+//! Accounts the cycle that started and builds the next schedule
+bool fault_task();
+
+//! Starts a wheel cycle, pattern ISR context when the table wraps
+void fault_cycle();
+
+//! Applies the schedule to the edge being written, pattern ISR context
+static inline uint8_t fault_edge(uint8_t states)
+{
+  const struct fault_schedule *play = fault_play;
+
+  if (edge_counter == fault_at)
+  {
+    uint8_t idx = fault_idx;
+    fault_and = play->edit[idx].and_mask;
+    fault_or = play->edit[idx].or_mask;
+    fault_left = play->edit[idx].len;
+    fault_at = (++idx < play->edits) ? play->edit[idx].edge : FAULT_NO_EDGE;
+    fault_idx = idx;
+  }
+  if (fault_left)
+  {
+    states = (states & fault_and) | fault_or;
+    fault_left--;
+  }
+  return states & play->states_mask;
+}
+
+//! Period of the edge being written with the schedule's jitter, pattern ISR context
+static inline uint16_t fault_period(uint16_t ocr)
+{
+  const struct fault_schedule *play = fault_play;
+
+  if (play->jitter)
+  {
+    /* ocr * |q| / 128 in two 8x8 multiplies, then the sign, so offsets and
+     * their negatives cancel exactly unless one of them is clamped */
+    int8_t q = play->jitter_ring[fault_jitter_idx++ & (FAULT_JITTER_RING - 1)];
+    uint8_t a = (q < 0) ? -q : q;
+    uint16_t j = (uint16_t)((ocr >> 8) * a) + (((ocr & 0xFF) * a) >> 8);
+    j <<= 1;
+    if (q < 0)
+    {
+      /* No shorter than FAULT_JITTER_MIN_OCR, or the period itself if that already is */
+      uint16_t shortest = (ocr < FAULT_JITTER_MIN_OCR) ? ocr : FAULT_JITTER_MIN_OCR;
+      ocr = (ocr - j > shortest) ? ocr - j : shortest;
+    }
+    else
+    {
+      /* Saturated, a long period near 0xFFFF would wrap to a short one */
+      uint32_t longer = (uint32_t)ocr + j;
+      ocr = (longer > 0xFFFF) ? 0xFFFF : longer;
+    }
+  }
+  return ocr;
+}
+
+#endif
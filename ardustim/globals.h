@@ -62,19 +62,33 @@ struct status
   uint16_t base_rpm; //RPM excluding compression modifier
   uint16_t compressionModifier;
   uint16_t rpm; //Final RPM
+  uint16_t max_rpm; //Highest RPM the current wheel can be driven at, see updateMaxRPM()
 };
 extern struct status currentStatus;
 
+/* Boot mode and how long the last boot took, all times are micros() since the
+ * sketch started (the bootloader isn't included). Kept out of configTable so
+ * the 'c'/'C' config block stays the size the desktop app expects */
+struct boot_status
+{
+  uint8_t mode;           //BOOT_ANIMATED or BOOT_FAST, saved with the config
+  uint32_t first_edge_us; //First pattern edge on the outputs
+  uint32_t setup_us;      //End of setup(): serial and buttons live
+  uint32_t ready_us;      //Main screen fully on the LCD, 0 = not yet / no LCD
+};
+extern struct boot_status bootStatus;
+
 /* Tie things wheel related into one nicer structure ... */
 typedef struct _wheels wheels;
 struct _wheels {
-  const char *decoder_name PROGMEM;
-  const unsigned char *edge_states_ptr PROGMEM;
-  const float rpm_scaler;
-  //const uint16_t rpm_scaler;
-  const uint16_t wheel_max_edges;
-  const uint16_t wheel_degrees;
+  const char *decoder_name;
+  const unsigned char *edge_states_ptr; /* Nibble packed, read with wheel_edge_state(), gen_edges[] for GENERATED_WHEEL */
+  float rpm_scaler;
+  uint16_t wheel_max_edges;
+  uint16_t wheel_degrees;
 };
+extern const wheels Wheels[]; /* In flash, generated from WHEEL_LIST */
+extern wheels activeWheel;    /* RAM copy of Wheels[config.wheel], see load_wheel() */
 
 //A sin wave of amplitude 100 with a complete cycle in 180 degrees (1 entry per degree). 
 const uint8_t sin_100_180[] PROGMEM = 
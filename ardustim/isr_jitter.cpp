@@ -0,0 +1,56 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Pattern ISR latency/jitter histogram
+ *
+ * Storage, reset and serial dump for the samples taken by jitter_record()
+ */
+
+#include "isr_jitter.h"
+
+#if ENABLE_ISR_JITTER
+
+#include <string.h>
+
+volatile struct jitter_stats jitterStats = { {0}, 0, 0xFFFF, 0, 0 };
+const uint8_t jitter_cs_shift[8] = { 0, 0, 3, 6, 8, 10, 0, 0 };
+
+//! Clears the histogram and counters
+void jitter_reset()
+{
+  noInterrupts();
+  memset((void *)&jitterStats, 0, sizeof(jitterStats));
+  jitterStats.min_cycles = 0xFFFF;
+  interrupts();
+}
+
+//! Sends the histogram over serial
+/*!
+ * First line is samples,min,max,overruns (min/max in CPU cycles, 62.5ns)
+ * Second line is the bucket counts, JITTER_BUCKETS comma separated values
+ * each 1 << JITTER_BUCKET_SHIFT cycles wide starting at 0
+ */
+void jitter_dump()
+{
+  struct jitter_stats snap;
+
+  /* Copy under cli so the lines are consistent with each other */
+  noInterrupts();
+  memcpy(&snap, (const void *)&jitterStats, sizeof(snap));
+  interrupts();
+
+  Serial.print(snap.samples);
+  Serial.print(",");
+  Serial.print(snap.samples ? snap.min_cycles : 0);
+  Serial.print(",");
+  Serial.print(snap.max_cycles);
+  Serial.print(",");
+  Serial.println(snap.overruns);
+  for (uint8_t x = 0; x < JITTER_BUCKETS; x++)
+  {
+    if (x != 0) { Serial.print(","); }
+    Serial.print(snap.buckets[x]);
+  }
+  Serial.println("");
+}
+
+#endif
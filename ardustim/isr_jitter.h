@@ -0,0 +1,59 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Pattern ISR latency/jitter histogram
+ *
+ * TIMER1_COMPA_vect samples TCNT1 on entry. In CTC mode the counter restarts
+ * from 0 on the compare match, so the sample is how late the ISR started
+ * (hardware response + prologue + whatever ISR was running when the match
+ * hit: TWI, ADC, USART RX, Timer0). Samples are scaled to CPU cycles and
+ * binned into a fixed histogram, read with serial 'j', cleared with 'J'.
+ *
+ * Compiles out completely unless built with -DENABLE_ISR_JITTER=1.
+ */
+#ifndef __ISR_JITTER_H__
+#define __ISR_JITTER_H__
+
+#ifndef ENABLE_ISR_JITTER
+#define ENABLE_ISR_JITTER 0  // Default to disabled, costs ~50 bytes RAM
+#endif
+
+#if ENABLE_ISR_JITTER
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define JITTER_BUCKETS 16
+#define JITTER_BUCKET_SHIFT 4 /* 16 CPU cycles (1us) per bucket, last one catches everything later */
+
+struct jitter_stats {
+  uint16_t buckets[JITTER_BUCKETS];
+  uint32_t samples;
+  uint16_t min_cycles;
+  uint16_t max_cycles;
+  uint16_t overruns; /* Compare match already pending again on entry, an edge was lost */
+};
+extern volatile struct jitter_stats jitterStats;
+
+/* CPU cycles per Timer1 count as a shift, indexed by the CS12..CS10 bits */
+extern const uint8_t jitter_cs_shift[8];
+
+//! Records one pattern ISR entry from the TCNT1 TIMER1_COMPA_vect read first thing
+static inline void jitter_record(uint16_t tcnt)
+{
+  uint16_t cycles = tcnt << jitter_cs_shift[TCCR1B & ((1 << CS10) | (1 << CS11) | (1 << CS12))];
+  uint8_t bucket = cycles >> JITTER_BUCKET_SHIFT;
+
+  if (TIFR1 & (1 << OCF1A)) { jitterStats.overruns++; }
+  if (bucket >= JITTER_BUCKETS) { bucket = JITTER_BUCKETS - 1; }
+  if (jitterStats.buckets[bucket] != 0xFFFF) { jitterStats.buckets[bucket]++; } /* Saturate */
+  if (cycles < jitterStats.min_cycles) { jitterStats.min_cycles = cycles; }
+  if (cycles > jitterStats.max_cycles) { jitterStats.max_cycles = cycles; }
+  jitterStats.samples++;
+}
+
+void jitter_reset();
+void jitter_dump();
+
+#endif
+
+#endif
@@ -0,0 +1,188 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Knock signal on pin 11 (OC2A)
+ *
+ * See knock.h
+ */
+
+#include "knock.h"
+#include "globals.h"
+#include "aux_out.h"
+#include <Arduino.h>
+#include <string.h>
+
+struct knock_params knockParams = { 0, 7000, 4, 10, 40, 0x0F };
+
+struct knock_gate knock_gates[KNOCK_MAX_GATES];
+volatile uint8_t knock_gate_count = 0;
+volatile uint8_t knock_idx = 0;
+volatile uint16_t knock_at = KNOCK_NO_EDGE;
+
+/* Window of edges [on, off) */
+struct knock_window {
+  uint16_t on;
+  uint16_t off;
+};
+
+//! Sets the Timer2 prescaler and compare value for freq
+static void knock_timer(uint16_t freq)
+{
+  /* OC2A toggles on every compare, two per period */
+  uint16_t div = 8;
+  uint8_t cs = (1 << CS21);
+  if (F_CPU / (2UL * 8 * freq) > 256)
+  {
+    div = 32;
+    cs = (1 << CS21) | (1 << CS20);
+  }
+  TCCR2B = 0;
+  OCR2A = (F_CPU / (2UL * div * freq)) - 1;
+  TCNT2 = 0;
+  TCCR2B = cs;
+}
+
+void knock_init()
+{
+  TIMSK2 = 0;
+  TCCR2A = KNOCK_TCCR2A_OFF;
+  knock_timer(knockParams.freq);
+}
+
+uint16_t knock_freq_actual()
+{
+  /* From the settings, Timer2 may be the VSS's */
+  uint16_t freq = knockParams.freq;
+  uint16_t div = (F_CPU / (2UL * 8 * freq) > 256) ? 32 : 8;
+  return F_CPU / (2UL * div * (F_CPU / (2UL * div * freq)));
+}
+
+//! Works out the gate list for the active wheel
+/*!
+ * @return Number of gates written to gates
+ */
+static uint8_t knock_build(struct knock_gate *gates)
+{
+  uint16_t edges = activeWheel.wheel_max_edges;
+  uint16_t degrees = activeWheel.wheel_degrees;
+  uint16_t spacing = 720 / knockParams.cylinders;
+  uint16_t width = knockParams.width;
+  struct knock_window win[2 * KNOCK_MAX_CYLINDERS];
+  uint8_t n = 0;
+
+  if (!knockParams.enabled || (edges == 0) || (degrees == 0)) { return 0; }
+  if (width >= degrees) { width = degrees - 1; }
+
+  for (uint8_t k = 0; k < knockParams.cylinders; k++)
+  {
+    if (!(knockParams.mask & (1 << k))) { continue; }
+    uint16_t a = (knockParams.start + k * spacing) % degrees;
+    uint16_t on = (uint32_t)a * edges / degrees;
+    uint16_t off = (uint32_t)(a + width) * edges / degrees;
+    if (on == off) { continue; }
+
+    /* Past the end of the table it carries on from edge 0 */
+    struct knock_window w[2] = { { on, off }, { 0, 0 } };
+    uint8_t pieces = 1;
+    if (off > edges)
+    {
+      w[0].off = edges;
+      w[1].off = off - edges;
+      pieces = 2;
+    }
+    for (uint8_t p = 0; p < pieces; p++)
+    {
+      /* Sorted by start */
+      uint8_t i = n++;
+      while (i && (win[i - 1].on > w[p].on))
+      {
+        win[i] = win[i - 1];
+        i--;
+      }
+      win[i] = w[p];
+    }
+  }
+
+  /* Overlapping windows merged, then a gate at each end */
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < n; )
+  {
+    uint16_t on = win[i].on;
+    uint16_t off = win[i].off;
+    for (i++; (i < n) && (win[i].on <= off); i++)
+    {
+      if (win[i].off > off) { off = win[i].off; }
+    }
+    if (count + 2 > KNOCK_MAX_GATES) { break; }
+    gates[count].edge = on;
+    gates[count++].tccr2a = KNOCK_TCCR2A_ON;
+    if (off == edges)
+    {
+      /* Closes at edge 0, unless a window opens there and it just carries on */
+      if (win[0].on == 0) { continue; }
+      for (uint8_t g = count++; ; g--)
+      {
+        if (g == 0) { gates[0].edge = 0; gates[0].tccr2a = KNOCK_TCCR2A_OFF; break; }
+        gates[g] = gates[g - 1];
+      }
+    }
+    else
+    {
+      gates[count].edge = off;
+      gates[count++].tccr2a = KNOCK_TCCR2A_OFF;
+    }
+  }
+  return count;
+}
+
+//! Puts the gate in the state it has at edge_counter and hands the list to the ISR, interrupts off
+static void knock_sync(uint8_t count)
+{
+  knock_gate_count = count;
+  if (count == 0)
+  {
+    /* Only closed if it was knock's, the VSS may have Timer2 */
+    if (GPIOR0 & (1 << KNOCK_BIT)) { TCCR2A = KNOCK_TCCR2A_OFF; }
+    GPIOR0 &= ~(1 << KNOCK_BIT);
+    knock_at = KNOCK_NO_EDGE;
+    return;
+  }
+
+  /* The last gate of the cycle holds until the first one of the next */
+  uint8_t state = knock_gates[count - 1].tccr2a;
+  uint8_t idx = 0;
+  while ((idx < count) && (knock_gates[idx].edge < edge_counter))
+  {
+    state = knock_gates[idx++].tccr2a;
+  }
+  if (idx == count) { idx = 0; }
+  TCCR2A = state;
+  knock_idx = idx;
+  knock_at = knock_gates[idx].edge;
+  GPIOR0 |= (1 << KNOCK_BIT);
+}
+
+bool knock_set(const struct knock_params *params)
+{
+  struct knock_gate gates[KNOCK_MAX_GATES];
+
+  if ((params->freq < KNOCK_FREQ_MIN) || (params->freq > KNOCK_FREQ_MAX)) { return false; }
+  if ((params->cylinders == 0) || (params->cylinders > KNOCK_MAX_CYLINDERS)) { return false; }
+  if (params->width >= 720 / params->cylinders) { return false; }
+  if (params->enabled && aux_vss_active()) { return false; }
+
+  knockParams = *params;
+  if (knockParams.enabled) { knock_timer(knockParams.freq); }
+  /* Worked out with interrupts on, the divisions would hold up the pattern */
+  uint8_t count = knock_build(gates);
+
+  noInterrupts();
+  memcpy(knock_gates, gates, sizeof(gates));
+  knock_sync(count);
+  interrupts();
+  return true;
+}
+
+void knock_reload()
+{
+  knock_sync(knock_build(knock_gates));
+}
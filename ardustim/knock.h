@@ -0,0 +1,89 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Knock signal on pin 11 (OC2A)
+ *
+ * Timer2 makes the knock tone by itself, CTC mode toggling OC2A, so the tone
+ * costs no CPU at all. The pattern ISR only gates it: knock_reload() turns
+ * the crank angle windows (one per knocking cylinder, from the wheel's first
+ * edge) into a short list of edges, sorted, where the OC2A toggle is
+ * connected or disconnected, and the ISR compares edge_counter against the
+ * next one, a TCCR2A write when it matches. Disconnected, the pin is the
+ * PORTB bit under it, which the pattern ISR keeps at 0, so the gate always
+ * closes low.
+ *
+ * Windows are whole edges of the active wheel (3 degrees on a 60-2) and
+ * follow the forward pattern. On a 360 degree wheel the cylinders one
+ * revolution apart share a window. Knock off, the ISR pays a single GPIOR0
+ * bit test. Timer2 and pin 11 are the VSS output's while that runs
+ * (aux_out.h), knock can't be turned on then.
+ */
+#ifndef __KNOCK_H__
+#define __KNOCK_H__
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#define KNOCK_BIT             4     /* GPIOR0 bit, set while knock windows are gated (see fault.h) */
+#define KNOCK_FREQ_MIN        1000  /* Hz, Timer2 prescaler 32 */
+#define KNOCK_FREQ_MAX        20000
+#define KNOCK_MAX_CYLINDERS   8
+#define KNOCK_MAX_GATES       (2 * KNOCK_MAX_CYLINDERS + 2)   /* A window can be split by the table wrap */
+#define KNOCK_NO_EDGE         0xFFFF
+
+/* Timer2 CTC with OC2A toggling or disconnected */
+#define KNOCK_TCCR2A_ON       ((1 << COM2A0) | (1 << WGM21))
+#define KNOCK_TCCR2A_OFF      (1 << WGM21)
+
+struct knock_params {
+  uint8_t enabled;
+  uint16_t freq;          //Hz, KNOCK_FREQ_MIN..KNOCK_FREQ_MAX
+  uint8_t cylinders;      //1..KNOCK_MAX_CYLINDERS, evenly spaced over 720 degrees
+  uint8_t start;          //Crank degrees from TDC (the first edge of the wheel) to the window
+  uint8_t width;          //Crank degrees
+  uint8_t mask;           //Bit per cylinder that knocks, firing order
+};
+
+/* One point where the gate changes */
+struct knock_gate {
+  uint16_t edge;
+  uint8_t tccr2a;         //KNOCK_TCCR2A_ON or KNOCK_TCCR2A_OFF
+};
+
+extern struct knock_params knockParams;
+
+/* Pattern ISR state, see knock_edge() */
+extern struct knock_gate knock_gates[KNOCK_MAX_GATES];
+extern volatile uint8_t knock_gate_count;
+extern volatile uint8_t knock_idx;
+extern volatile uint16_t knock_at;
+extern volatile uint16_t edge_counter;
+
+//! Sets Timer2 up for the knock tone with the gate closed
+void knock_init();
+
+//! Checks and applies knock settings
+/*!
+ * @return false, nothing changed, if they are out of range or the VSS has Timer2
+ */
+bool knock_set(const struct knock_params *params);
+
+//! Tone frequency Timer2 makes for the set one, Hz
+uint16_t knock_freq_actual();
+
+//! Rebuilds the gate list for the active wheel, called by load_wheel() with interrupts off
+void knock_reload();
+
+//! Opens or closes the gate at the edge just written, pattern ISR context
+static inline void knock_edge()
+{
+  if (edge_counter == knock_at)
+  {
+    uint8_t idx = knock_idx;
+    TCCR2A = knock_gates[idx].tccr2a;
+    if (++idx == knock_gate_count) { idx = 0; }
+    knock_idx = idx;
+    knock_at = knock_gates[idx].edge;
+  }
+}
+
+#endif
@@ -8,11 +8,16 @@
  * Part of Ardu-Stim LCD Interface Enhancement
  */
 
+#include "display_interface.h"
+
+#if LCD_DRIVER == LCD_DRIVER_WIRE
+
 #include "lcd_display.h"
 #include <Wire.h>
 #include <Arduino.h>
 
-LCDDisplay::LCDDisplay() : lcd(nullptr), initialized(false), available(false) {
+LCDDisplay::LCDDisplay() : lcd(nullptr), initialized(false), available(false),
+                           backoffMs(LCD_REPROBE_MIN_MS), lastProbe(0) {
     // Create LCD instance with I2C address and dimensions
     lcd = new LiquidCrystal_I2C(LCD_I2C_ADDRESS, LCD_COLUMNS, LCD_ROWS);
 }
@@ -24,6 +29,21 @@ LCDDisplay::~LCDDisplay() {
     }
 }
 
+bool LCDDisplay::probe() {
+    Wire.beginTransmission(LCD_I2C_ADDRESS);
+    return Wire.endTransmission() == 0;
+}
+
+void LCDDisplay::begin() {
+    lcd->init();
+    lcd->backlight();
+    lcd->clear();
+#ifdef WIRE_HAS_TIMEOUT
+    // lcd->init() restarts Wire, a stuck bus must not hang loop()
+    Wire.setWireTimeout(LCD_WIRE_TIMEOUT_US, true);
+#endif
+}
+
 bool LCDDisplay::init() {
     if (!lcd) {
         return false;
@@ -31,17 +51,67 @@ bool LCDDisplay::init() {
     
     // Initialize I2C communication
     Wire.begin();
-    
-    // Initialize LCD
-    lcd->init();
-    lcd->backlight();
-    lcd->clear();
+#ifdef WIRE_HAS_TIMEOUT
+    Wire.setWireTimeout(LCD_WIRE_TIMEOUT_US, true);
+#endif
     
     initialized = true;
+    backoffMs = LCD_REPROBE_MIN_MS;
+    lastProbe = millis();
+    
+    // Nothing answering, poll() keeps trying
+    if (!probe()) {
+        available = false;
+        return false;
+    }
+    
+    // Initialize LCD
+    begin();
     available = true;
     return true;
 }
 
+void LCDDisplay::poll() {
+    if (!lcd) {
+        return;
+    }
+    
+    uint32_t now = millis();
+    if (available) {
+        bool lost = false;
+#ifdef WIRE_HAS_TIMEOUT
+        if (Wire.getWireTimeoutFlag()) {
+            Wire.clearWireTimeoutFlag();
+            lost = true;
+        }
+#endif
+        if (now - lastProbe >= LCD_HEALTH_CHECK_MS) {
+            lastProbe = now;
+            lost = lost || !probe();
+        }
+        if (lost) {
+            available = false;
+            backoffMs = LCD_REPROBE_MIN_MS;
+        }
+        return;
+    }
+    
+    // Missing: one address probe per back-off period, nothing else
+    if (now - lastProbe < backoffMs) {
+        return;
+    }
+    lastProbe = now;
+    if (probe()) {
+        begin();
+        available = true;
+        backoffMs = LCD_REPROBE_MIN_MS;
+    } else if (backoffMs < LCD_REPROBE_MAX_MS / 2) {
+        backoffMs *= 2;
+    } else {
+        backoffMs = LCD_REPROBE_MAX_MS;
+    }
+}
+
 void LCDDisplay::clear() {
     if (!available || !lcd) {
         return;
@@ -77,4 +147,6 @@ void LCDDisplay::print(int value) {
 
 bool LCDDisplay::isAvailable() {
     return available;
-}
\ No newline at end of file
+}
+
+#endif
@@ -14,11 +14,12 @@
 #include <LiquidCrystal_I2C.h>
 
 /**
- * I2C LCD Display Configuration
+ * LiquidCrystal_I2C drops Wire's NACK results, so a lost display is found
+ * by probing its address this often. Wire transfers give up after
+ * LCD_WIRE_TIMEOUT_US on cores that support it (WIRE_HAS_TIMEOUT)
  */
-#define LCD_I2C_ADDRESS 0x3F   // Try 0x3F if 0x27 doesn't work
-#define LCD_COLUMNS 20          // 20x4 LCD display
-#define LCD_ROWS 4
+#define LCD_HEALTH_CHECK_MS     1000
+#define LCD_WIRE_TIMEOUT_US     3000
 
 /**
  * Concrete implementation of DisplayInterface for I2C LCD
@@ -29,6 +30,19 @@ private:
     LiquidCrystal_I2C* lcd;
     bool initialized;
     bool available;
+    uint16_t backoffMs;
+    uint32_t lastProbe;
+    
+    /**
+     * Address the backpack with an empty write
+     * @return true if it ACKed
+     */
+    bool probe();
+    
+    /**
+     * Run the library's init sequence, blocks for about 60ms
+     */
+    void begin();
     
 public:
     /**
@@ -71,6 +85,11 @@ public:
      */
     void print(int value) override;
     
+    /**
+     * Health check while available, back-off re-probe and re-init while not
+     */
+    void poll() override;
+    
     /**
      * Check if LCD is available and functional
      * @return true if LCD is working
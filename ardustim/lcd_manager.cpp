@@ -12,23 +12,20 @@
 #include "globals.h"
 #include "enums.h"
 #include "wheel_defs.h"
+#include "string_pool.h"
 #include <Arduino.h>
 #include <avr/pgmspace.h>
+#include <string.h>
 
-// Minimal text constants to save flash
-const char LCD_TEXT_SAVED[] PROGMEM = "SAVED";
-const char LCD_TEXT_SAVING[] PROGMEM = "SAVING...";
-
-// External wheel definitions
-extern wheels Wheels[];
 
 LCDManager::LCDManager() : display(nullptr), currentMode(DISPLAY_MAIN), 
                            messageTimeout(0), lastRefresh(0),
                            needsRefresh(true), forceRefreshFlag(false),
-                           forceStaticLabelReset(false),
-                           lastWheel(255), lastRPM(0), lastMode(255), 
-                           isDisplayInitialized(false), messageModeInitialized(false) {
+                           lastWheel(255), lastRPM(0), lastMode(255), lastMaxRPM(0),
+                           dirtyRows(0), flushRow(0), flushCol(0), displayOnline(false) {
     messageBuffer[0] = '\0';
+    memset(frontBuffer, ' ', sizeof(frontBuffer));
+    memset(backBuffer, ' ', sizeof(backBuffer));
 }
 
 void LCDManager::init(DisplayInterface* disp) {
@@ -43,15 +40,39 @@ void LCDManager::init(DisplayInterface* disp) {
     lastWheel = 255;
     lastRPM = 0;
     lastMode = 255;
-    isDisplayInitialized = false;
-    messageModeInitialized = false;
+    lastMaxRPM = 0;
     
     messageBuffer[0] = '\0';
+    
+    // Start from a known blank screen, both buffers match it
+    if (display) {
+        display->clear();
+    }
+    memset(frontBuffer, ' ', sizeof(frontBuffer));
+    memset(backBuffer, ' ', sizeof(backBuffer));
+    dirtyRows = 0;
+    flushRow = 0;
+    flushCol = 0;
+    displayOnline = display && display->isAvailable();
 }
 
-void LCDManager::update() {
-    if (!display || !display->isAvailable()) {
-        return;
+bool LCDManager::update() {
+    if (!display) {
+        return false;
+    }
+    
+    // Nothing is rendered or sent while the display is missing, the driver
+    // only checks now and then whether it's back
+    display->poll();
+    if (!display->isAvailable()) {
+        displayOnline = false;
+        return false;
+    }
+    if (!displayOnline) {
+        // Re-initialised blank, whatever frontBuffer says
+        displayOnline = true;
+        invalidate();
+        forceRefresh();
     }
     
     uint32_t currentTime = millis();
@@ -61,35 +82,44 @@ void LCDManager::update() {
         returnToMain();  // Use returnToMain() to properly reset all flags
     }
     
-    // Skip main display updates during startup mode
-    if (currentMode == DISPLAY_STARTUP) {
-        return;
-    }
-
-    
-    // Check if state has changed
-    if (hasStateChanged()) {
-        needsRefresh = true;
-    }
-    
-    // Limit refresh rate
-    if (needsRefresh && (currentTime - lastRefresh >= DISPLAY_REFRESH_MIN || forceRefreshFlag)) {
-        switch (currentMode) {
-            case DISPLAY_MAIN:
-                updateMainDisplay();
-                break;
-            case DISPLAY_MESSAGE:
-                updateMessageDisplay();
-                break;
-            case DISPLAY_STARTUP:
-                // Startup display is handled externally by handleStartupSequence()
-                break;
+    // Startup screens are drawn externally by handleStartupSequence(), only flush them
+    if (currentMode != DISPLAY_STARTUP) {
+        // Check if state has changed
+        if (hasStateChanged()) {
+            needsRefresh = true;
         }
         
-        needsRefresh = false;
-        forceRefreshFlag = false;
-        lastRefresh = currentTime;
+        // Diagnostics are live figures, redraw at the normal refresh rate
+        if (currentMode == DISPLAY_DIAG) {
+            needsRefresh = true;
+        }
+        
+        // Limit refresh rate, rendering only touches the shadow screen
+        if (needsRefresh && (currentTime - lastRefresh >= DISPLAY_REFRESH_MIN || forceRefreshFlag)) {
+            switch (currentMode) {
+                case DISPLAY_MAIN:
+                    updateMainDisplay();
+                    break;
+                case DISPLAY_MESSAGE:
+                    updateMessageDisplay();
+                    break;
+                case DISPLAY_STARTUP:
+                    break;
+                case DISPLAY_DIAG:
+#if ENABLE_LOOP_PROFILER
+                    updateDiagnosticsDisplay();
+#endif
+                    break;
+            }
+            
+            needsRefresh = false;
+            forceRefreshFlag = false;
+            lastRefresh = currentTime;
+        }
     }
+    
+    // Send what changed, a bounded slice per call
+    return flush();
 }
 
 bool LCDManager::hasStateChanged() {
@@ -120,324 +150,125 @@ bool LCDManager::hasStateChanged() {
         changed = true;
     }
     
+    if (currentStatus.max_rpm != lastMaxRPM) {
+        lastMaxRPM = currentStatus.max_rpm;
+        changed = true;
+    }
+    
     return changed;
 }
 
 void LCDManager::updateMainDisplay() {
-    if (!display) return;
-    
     char buffer[21];  // 20 chars + null terminator for 20x4 display
-    static uint8_t lastWheelDisplayed = 255;
-    static uint16_t lastRPMDisplayed = 0;
-    static uint8_t lastModeDisplayed = 255;
-    static bool staticLabelsInitialized = false;
     
-    // Initialize static labels only once (NEVER use clear() in loop)
-    if (!staticLabelsInitialized || forceStaticLabelReset) {
-        display->clear();
-        
-        // Initialize Line 2: RPM label (static - write once)
-        display->setCursor(0, 1);
-        display->print("RPM: ");
-        
-        // Initialize Line 3: Mode label (static - write once)
-        display->setCursor(0, 2);
-        display->print("Mode: ");
-        
-        // Initialize Line 4: Status (static - write once)
-        display->setCursor(0, 3);
-        display->print("Ready");
-        
-        staticLabelsInitialized = true;
-        isDisplayInitialized = true;
-        forceStaticLabelReset = false;  // Reset the flag
-        
-        // Force all content to be displayed after initialization
-        lastWheelDisplayed = 255;
-        lastRPMDisplayed = 0;
-        lastModeDisplayed = 255;
-    }
+    // Line 1: Wheel pattern name
+    getWheelName(config.wheel, buffer, sizeof(buffer));
+    drawField(0, 0, buffer, SCREEN_COLS);
     
-    // Update Line 1: Wheel pattern name (only if changed)
-    if (config.wheel != lastWheelDisplayed) {
-        display->setCursor(0, 0);
-        // Use spaces to overwrite old content (Arduino community best practice)
-        display->print("                    "); // 20 spaces to clear line
-        display->setCursor(0, 0);
-        getWheelName(config.wheel, buffer, sizeof(buffer));
-        display->print(buffer);
-        lastWheelDisplayed = config.wheel;
-    }
+    // Line 2: RPM
+    drawString(0, 1, STR_RPM_LABEL);
+    formatRPM(currentStatus.rpm, buffer, sizeof(buffer));
+    drawField(5, 1, buffer, SCREEN_COLS - 5);
     
-    // Update Line 2: RPM number only (preserve "RPM: " label)
-    if (currentStatus.rpm != lastRPMDisplayed) {
-        display->setCursor(5, 1);
-        // Clear only the RPM number area with spaces
-        display->print("               "); // 15 spaces (20 total - 5 for "RPM: ")
-        display->setCursor(5, 1);
-        
-        formatRPM(currentStatus.rpm, buffer, sizeof(buffer));
-        display->print(buffer);
-        lastRPMDisplayed = currentStatus.rpm;
-    }
+    // Line 3: Mode
+    drawString(0, 2, STR_MODE_LABEL);
+    formatMode(config.mode, buffer, sizeof(buffer));
+    drawField(6, 2, buffer, SCREEN_COLS - 6);
     
-    // Update Line 3: Mode text only (preserve "Mode: " label)
-    if (config.mode != lastModeDisplayed) {
-        display->setCursor(6, 2);
-        // Clear only the mode text area with spaces
-        display->print("              "); // 14 spaces (20 total - 6 for "Mode: ")
-        display->setCursor(6, 2);
-        
-        formatMode(config.mode, buffer, sizeof(buffer));
-        display->print(buffer);
-        lastModeDisplayed = config.mode;
-    }
+    // Line 4: Status and the current wheel's RPM limit
+    drawString(0, 3, STR_READY_MAX);
+    formatRPM(currentStatus.max_rpm, buffer, sizeof(buffer));
+    drawField(13, 3, buffer, SCREEN_COLS - 13);
 }
 
-
-
 void LCDManager::updateMessageDisplay() {
-    if (!display) return;
-    
-    // Only clear when switching to message mode (not every update)
-    if (!messageModeInitialized) {
-        display->clear();
-        messageModeInitialized = true;
-    }
-    
     // Center the message on line 2 (middle of 20x4 display)
     uint8_t messageLen = strlen(messageBuffer);
-    uint8_t startPos = (20 - messageLen) / 2;
+    uint8_t startPos = (SCREEN_COLS - messageLen) / 2;
     
-    // Clear the message line with spaces first
-    display->setCursor(0, 1);
-    display->print("                    "); // 20 spaces
+    clearScreen();
+    drawText(startPos, 1, messageBuffer);
+}
+
+#if ENABLE_LOOP_PROFILER
+void LCDManager::updateDiagnosticsDisplay() {
+    char buffer[21];
+    uint32_t worst = loopProfile.worst_pass_us;
+    if (worst > 99999) worst = 99999;
+    
+    // Line 1: loop rate and worst single pass
+    snprintf_P(buffer, sizeof(buffer), PSTR("Hz:%-4u Pass:%5luus"), loopProfile.loop_hz, (unsigned long)worst);
+    drawText(0, 0, buffer);
+    
+    // Lines 2-4: worst time per stage and then the scheduler's own (SC), 3 per line 7 columns apart
+    for (uint8_t slot = 0; slot <= PROF_STAGES; slot++) {
+        const char *tag = "SC";
+        uint16_t maxUs = loopProfile.sched_max_us;
+        if (slot < PROF_STAGES) {
+            tag = profiler_stage_label(slot);
+            maxUs = loopProfile.stages[slot].max_us;
+        }
+        if (maxUs > 9999) maxUs = 9999;
+        snprintf_P(buffer, sizeof(buffer), PSTR("%s%4u"), tag, maxUs);
+        drawText((slot % 3) * 7, 1 + slot / 3, buffer);
+    }
+}
+
+void LCDManager::toggleDiagnostics() {
+    if (currentMode == DISPLAY_DIAG) {
+        returnToMain();
+        return;
+    }
+    if (currentMode != DISPLAY_MAIN) {
+        return;
+    }
     
-    // Then write the message
-    display->setCursor(startPos, 1);
-    display->print(messageBuffer);
+    currentMode = DISPLAY_DIAG;
+    clearScreen();
+    needsRefresh = true;
+    forceRefreshFlag = true;
 }
+#endif
 
 void LCDManager::returnToMain() {
     currentMode = DISPLAY_MAIN;
     messageTimeout = 0;
     needsRefresh = true;
+    forceRefreshFlag = true;
     
-    // Reset message mode flag so it can be re-initialized next time
-    messageModeInitialized = false;
-    
-    // Force static labels to be reinitialized since message mode cleared the display
-    forceStaticLabelReset = true;
+    // Whatever the previous screen left behind is replaced on the next render
+    clearScreen();
 }
 
 void LCDManager::formatRPM(uint16_t rpm, char* buffer, uint8_t bufferSize) {
     // Always show full RPM numbers, no "k" suffix
-    snprintf(buffer, bufferSize, "%d", rpm);
+    snprintf_P(buffer, bufferSize, PSTR("%u"), rpm);
 }
 
 void LCDManager::formatMode(uint8_t mode, char* buffer, uint8_t bufferSize) {
+    uint8_t id;
     switch (mode) {
         case FIXED_RPM:
-            strncpy(buffer, "Fixed", bufferSize - 1);
+            id = STR_MODE_FIXED;
             break;
         case POT_RPM:
-            strncpy(buffer, "Pot Control", bufferSize - 1);
+            id = STR_MODE_POT;
             break;
         case LINEAR_SWEPT_RPM:
-            strncpy(buffer, "Linear Sweep", bufferSize - 1);
+            id = STR_MODE_SWEEP;
             break;
         default:
-            strncpy(buffer, "Unknown", bufferSize - 1);
+            id = STR_UNKNOWN;
             break;
     }
-    buffer[bufferSize - 1] = '\0';
+    pool_copy(id, buffer, bufferSize);
 }
 
 void LCDManager::getWheelName(uint8_t wheelIndex, char* buffer, uint8_t bufferSize) {
-    if (wheelIndex >= MAX_WHEELS) {
-        strncpy(buffer, "Unknown", bufferSize - 1);
-        buffer[bufferSize - 1] = '\0';
-        return;
-    }
-    
-    // Get the wheel name from PROGMEM
-    const char* wheelName = nullptr;
-    switch (wheelIndex) {
-        case DIZZY_FOUR_CYLINDER:
-            wheelName = dizzy_four_cylinder_friendly_name;
-            break;
-        case DIZZY_SIX_CYLINDER:
-            wheelName = dizzy_six_cylinder_friendly_name;
-            break;
-        case DIZZY_EIGHT_CYLINDER:
-            wheelName = dizzy_eight_cylinder_friendly_name;
-            break;
-        case SIXTY_MINUS_TWO:
-            wheelName = sixty_minus_two_friendly_name;
-            break;
-        case SIXTY_MINUS_TWO_WITH_CAM:
-            wheelName = sixty_minus_two_with_cam_friendly_name;
-            break;
-        case SIXTY_MINUS_TWO_WITH_HALFMOON_CAM:
-            wheelName = sixty_minus_two_with_halfmoon_cam_friendly_name;
-            break;
-        case THIRTY_SIX_MINUS_ONE:
-            wheelName = thirty_six_minus_one_friendly_name;
-            break;
-        case TWENTY_FOUR_MINUS_ONE:
-            wheelName = twenty_four_minus_one_friendly_name;
-            break;
-        case FOUR_MINUS_ONE_WITH_CAM:
-            wheelName = four_minus_one_with_cam_friendly_name;
-            break;
-        case EIGHT_MINUS_ONE:
-            wheelName = eight_minus_one_friendly_name;
-            break;
-        case SIX_MINUS_ONE_WITH_CAM:
-            wheelName = six_minus_one_with_cam_friendly_name;
-            break;
-        case TWELVE_MINUS_ONE_WITH_CAM:
-            wheelName = twelve_minus_one_with_cam_friendly_name;
-            break;
-        case FOURTY_MINUS_ONE:
-            wheelName = fourty_minus_one_friendly_name;
-            break;
-        case DIZZY_FOUR_TRIGGER_RETURN:
-            wheelName = dizzy_four_trigger_return_friendly_name;
-            break;
-        case ODDFIRE_VR:
-            wheelName = oddfire_vr_friendly_name;
-            break;
-        case OPTISPARK_LT1:
-            wheelName = optispark_lt1_friendly_name;
-            break;
-        case TWELVE_MINUS_THREE:
-            wheelName = twelve_minus_three_friendly_name;
-            break;
-        case THIRTY_SIX_MINUS_TWO_TWO_TWO:
-            wheelName = thirty_six_minus_two_two_two_friendly_name;
-            break;
-        case THIRTY_SIX_MINUS_TWO_TWO_TWO_H6:
-            wheelName = thirty_six_minus_two_two_two_h6_friendly_name;
-            break;
-        case THIRTY_SIX_MINUS_TWO_TWO_TWO_WITH_CAM:
-            wheelName = thirty_six_minus_two_two_two_with_cam_friendly_name;
-            break;
-        case FOURTY_TWO_HUNDRED_WHEEL:
-            wheelName = fourty_two_hundred_wheel_friendly_name;
-            break;
-        case THIRTY_SIX_MINUS_ONE_WITH_CAM_FE3:
-            wheelName = thirty_six_minus_one_with_cam_fe3_friendly_name;
-            break;
-        case SIX_G_SEVENTY_TWO_WITH_CAM:
-            wheelName = six_g_seventy_two_with_cam_friendly_name;
-            break;
-        case BUELL_ODDFIRE_CAM:
-            wheelName = buell_oddfire_cam_friendly_name;
-            break;
-        case GM_LS1_CRANK_AND_CAM:
-            wheelName = gm_ls1_crank_and_cam_friendly_name;
-            break;
-        case GM_58x_LS_CRANK_4X_CAM:
-            wheelName = gm_ls_58X_crank_and_4x_cam_friendly_name;
-            break;
-        case LOTUS_THIRTY_SIX_MINUS_ONE_ONE_ONE_ONE:
-            wheelName = lotus_thirty_six_minus_one_one_one_one_friendly_name;
-            break;
-        case HONDA_RC51_WITH_CAM:
-            wheelName = honda_rc51_with_cam_friendly_name;
-            break;
-        case THIRTY_SIX_MINUS_ONE_WITH_SECOND_TRIGGER:
-            wheelName = thirty_six_minus_one_with_second_trigger_friendly_name;
-            break;
-        case WEBER_IAW_WITH_CAM:
-            wheelName = weber_iaw_with_cam_friendly_name;
-            break;
-        case FIAT_ONE_POINT_EIGHT_SIXTEEN_VALVE_WITH_CAM:
-            wheelName = fiat_one_point_eight_sixteen_valve_with_cam_friendly_name;
-            break;
-        case THREE_SIXTY_NISSAN_CAS:
-            wheelName = three_sixty_nissan_cas_friendly_name;
-            break;
-        case TWENTY_FOUR_MINUS_TWO_WITH_SECOND_TRIGGER:
-            wheelName = twenty_four_minus_two_with_second_trigger_friendly_name;
-            break;
-        case YAMAHA_EIGHT_TOOTH_WITH_CAM:
-            wheelName = yamaha_eight_tooth_with_cam_friendly_name;
-            break;
-        case MITSUBISH_4g63_4_2:
-            wheelName = mitsubishi_4g63_4_2_friendly_name;
-            break;
-        case AUDI_135_WITH_CAM:
-            wheelName = audi_135_with_cam_friendly_name;
-            break;
-        case HONDA_D17_NO_CAM:
-            wheelName = honda_d17_no_cam_friendly_name;
-            break;
-        case MAZDA_323_AU:
-            wheelName = mazda_323_au_friendly_name;
-            break;
-        case DAIHATSU_3CYL:
-            wheelName = daihatsu_3cyl_friendly_name;
-            break;
-        case MIATA_9905:
-            wheelName = miata_9905_friendly_name;
-            break;
-        case TWELVE_WITH_CAM:
-            wheelName = twelve_with_cam_friendly_name;
-            break;
-        case TWENTY_FOUR_WITH_CAM:
-            wheelName = twenty_four_with_cam_friendly_name;
-            break;
-        case SUBARU_SIX_SEVEN:
-            wheelName = subaru_six_seven_name_friendly_name;
-            break;
-        case GM_7X:
-            wheelName = gm_seven_x_friendly_name;
-            break;
-        case FOUR_TWENTY_A:
-            wheelName = four_twenty_a_friendly_name;
-            break;
-        case FORD_ST170:
-            wheelName = ford_st170_friendly_name;
-            break;
-        case MITSUBISHI_3A92:
-            wheelName = mitsubishi_3A92_friendly_name;
-            break;
-        case TOYOTA_4AGE_CAS:
-            wheelName = Toyota_4AGE_CAS_friendly_name;
-            break;
-        case TOYOTA_4AGZE:
-            wheelName = Toyota_4AGZE_friendly_name;
-            break;
-        case SUZUKI_DRZ400:
-            wheelName = Suzuki_DRZ400_friendly_name;
-            break;
-        case JEEP2000_4CYL:
-            wheelName = Jeep_2000_4cyl_friendly_name;
-            break;
-        case VIPER_96_02:
-            wheelName = VIPER9602_friendly_name;
-            break;
-        case THIRTY_SIX_MINUS_TWO_WITH_ONE_CAM:
-            wheelName = thirty_six_minus_two_with_second_trigger_friendly_name;
-            break;
-        case GM_40_OSS:
-            wheelName = GM_40_Tooth_Trans_OSS_friendly_name;
-            break;
-        default:
-            strncpy(buffer, "Unknown", bufferSize - 1);
-            buffer[bufferSize - 1] = '\0';
-            return;
-    }
-    
-    // Copy string from PROGMEM
-    strncpy_P(buffer, wheelName, bufferSize - 1);
-    buffer[bufferSize - 1] = '\0';
+    // Same text as serial 'L', straight from Wheels[] so it can't drift from the enum
+    pool_wheel_name(wheelIndex, buffer, bufferSize);
 }
 
-
-
 void LCDManager::showMessage(const char* message, uint16_t duration) {
     if (!display || !message) return;
     
@@ -448,9 +279,14 @@ void LCDManager::showMessage(const char* message, uint16_t duration) {
     currentMode = DISPLAY_MESSAGE;
     messageTimeout = millis() + duration;
     needsRefresh = true;
+    forceRefreshFlag = true;
+}
+
+void LCDManager::showMessage(StringId id, uint16_t duration) {
+    char buffer[sizeof(messageBuffer)];
     
-    // Reset message mode flag to ensure display gets cleared
-    messageModeInitialized = false;
+    pool_copy(id, buffer, sizeof(buffer));
+    showMessage(buffer, duration);
 }
 
 void LCDManager::enterStartupMode() {
@@ -460,26 +296,30 @@ void LCDManager::enterStartupMode() {
     messageTimeout = 0;  // No timeout during startup
     needsRefresh = true;
     
-    // Clear display for startup sequence
-    display->clear();
+    // Blank screen for the startup sequence
+    clearScreen();
 }
 
 void LCDManager::showStartupMessage(const char* message) {
     if (!display || !message || currentMode != DISPLAY_STARTUP) return;
     
-    // Clear display and show startup message
-    display->clear();
-    
     // Center the message on line 1 (top line for startup)
     uint8_t messageLen = strlen(message);
-    uint8_t startPos = (20 - messageLen) / 2;
+    uint8_t startPos = (SCREEN_COLS - messageLen) / 2;
     
-    display->setCursor(startPos, 1);
-    display->print(message);
+    clearScreen();
+    drawText(startPos, 1, message);
     
     needsRefresh = true;
 }
 
+void LCDManager::showStartupMessage(StringId id) {
+    char buffer[SCREEN_COLS + 1];
+    
+    pool_copy(id, buffer, sizeof(buffer));
+    showStartupMessage(buffer);
+}
+
 void LCDManager::exitStartupMode() {
     if (currentMode == DISPLAY_STARTUP) {
         returnToMain();
@@ -489,10 +329,138 @@ void LCDManager::exitStartupMode() {
 void LCDManager::forceRefresh() {
     forceRefreshFlag = true;
     needsRefresh = true;
-    // Note: We don't reset static initialization to avoid clearing static labels
-    // The static labels ("RPM:", "Mode:", "Ready") remain persistent
 }
 
 bool LCDManager::isDisplayAvailable() {
     return display && display->isAvailable();
-}
\ No newline at end of file
+}
+
+bool LCDManager::isIdle() {
+    return displayOnline && currentMode != DISPLAY_STARTUP && !needsRefresh && !dirtyRows;
+}
+
+void LCDManager::showBootTimes() {
+    char buffer[sizeof(messageBuffer)];
+    
+    // "Boot edge/ready" in ms, ready is 0 until the first main screen went out
+    snprintf_P(buffer, sizeof(buffer), PSTR("Boot %lu/%lums"),
+             (unsigned long)(bootStatus.first_edge_us / 1000), (unsigned long)(bootStatus.ready_us / 1000));
+    showMessage(buffer, MESSAGE_TIMEOUT_LONG);
+}
+
+void LCDManager::markDirty(uint8_t row) {
+    dirtyRows |= (1 << row);
+    // Cells before the resume point may have changed again
+    if (row == flushRow) {
+        flushCol = 0;
+    }
+}
+
+void LCDManager::clearScreen() {
+    memset(backBuffer, ' ', sizeof(backBuffer));
+    dirtyRows = (1 << SCREEN_ROWS) - 1;
+    flushCol = 0;
+}
+
+void LCDManager::drawText(uint8_t col, uint8_t row, const char* text) {
+    if (!text || row >= SCREEN_ROWS) return;
+    
+    while (*text && col < SCREEN_COLS) {
+        if (backBuffer[row][col] != *text) {
+            backBuffer[row][col] = *text;
+            markDirty(row);
+        }
+        col++;
+        text++;
+    }
+}
+
+uint8_t LCDManager::drawString(uint8_t col, uint8_t row, StringId id) {
+    char buffer[SCREEN_COLS + 1];
+    uint8_t len = pool_copy(id, buffer, sizeof(buffer));
+    
+    drawText(col, row, buffer);
+    return len;
+}
+
+void LCDManager::drawField(uint8_t col, uint8_t row, const char* text, uint8_t width) {
+    if (!text || row >= SCREEN_ROWS) return;
+    
+    uint8_t end = (col + width > SCREEN_COLS) ? SCREEN_COLS : col + width;
+    while (col < end) {
+        char c = *text ? *text++ : ' ';
+        if (backBuffer[row][col] != c) {
+            backBuffer[row][col] = c;
+            markDirty(row);
+        }
+        col++;
+    }
+}
+
+bool LCDManager::flush() {
+    if (!display) return false;
+    
+    uint32_t start = micros();
+    uint8_t cells = 0;
+    
+    while (dirtyRows) {
+        uint8_t row = flushRow;
+        if (!(dirtyRows & (1 << row))) {
+            flushRow = (row + 1) % SCREEN_ROWS;
+            flushCol = 0;
+            continue;
+        }
+        
+        char* back = backBuffer[row];
+        char* front = frontBuffer[row];
+        
+        while (flushCol < SCREEN_COLS) {
+            if (back[flushCol] == front[flushCol]) {
+                flushCol++;
+                continue;
+            }
+            
+            // Out of cells or time, carry on from here next call
+            if (cells >= LCD_FLUSH_MAX_CELLS || (micros() - start) >= LCD_FLUSH_BUDGET_US) {
+                return true;
+            }
+            
+            // Grow the run over further changes, bridging short unchanged gaps,
+            // but never past what's left of this call's allowance
+            uint8_t runStart = flushCol;
+            uint8_t runEnd = flushCol + 1;
+            uint8_t limit = runStart + (LCD_FLUSH_MAX_CELLS - cells);
+            if (limit > SCREEN_COLS) limit = SCREEN_COLS;
+            for (uint8_t scan = runEnd; scan < limit; scan++) {
+                if (back[scan] != front[scan]) {
+                    runEnd = scan + 1;
+                } else if (scan - runEnd >= SCREEN_RUN_MERGE_GAP) {
+                    break;
+                }
+            }
+            
+            // Driver queue full, leave the run for when the bus has drained
+            if (!display->canWrite(runEnd - runStart)) {
+                return true;
+            }
+            
+            display->write(runStart, row, &back[runStart], runEnd - runStart);
+            memcpy(&front[runStart], &back[runStart], runEnd - runStart);
+            cells += runEnd - runStart;
+            flushCol = runEnd;
+        }
+        
+        // Row fully compared, everything in it is on the display
+        dirtyRows &= ~(1 << row);
+        flushRow = (row + 1) % SCREEN_ROWS;
+        flushCol = 0;
+    }
+    return false;
+}
+
+void LCDManager::invalidate() {
+    // No character the screens draw is 0xFF, every cell compares as changed
+    memset(frontBuffer, 0xFF, sizeof(frontBuffer));
+    dirtyRows = (1 << SCREEN_ROWS) - 1;
+    flushCol = 0;
+}
@@ -13,6 +13,8 @@
 #include <stdint.h>
 #include <avr/pgmspace.h>
 #include "display_interface.h"
+#include "loop_profiler.h"
+#include "string_pool.h"
 
 /**
  * Display Mode Enumeration
@@ -20,7 +22,8 @@
 enum DisplayMode {
     DISPLAY_MAIN = 0,       // Main screen: wheel name, RPM, mode
     DISPLAY_MESSAGE = 1,    // Temporary message display
-    DISPLAY_STARTUP = 2     // Startup sequence display
+    DISPLAY_STARTUP = 2,    // Startup sequence display
+    DISPLAY_DIAG = 3        // Diagnostics page: loop profiler
 };
 
 /**
@@ -31,6 +34,28 @@ enum DisplayMode {
 #define STATUS_DISPLAY_TIME     3000    // 3 seconds for status display
 #define DISPLAY_REFRESH_MIN     1000     // Minimum 100ms between refreshes for smooth sweep mode
 
+/**
+ * Shadow Framebuffer Configuration
+ */
+#define SCREEN_COLS             20      // 20x4 display
+#define SCREEN_ROWS             4
+#define SCREEN_RUN_MERGE_GAP    1       // Unchanged cells resent to join two runs (a cursor move costs as much)
+
+/**
+ * Flush Slicing - each update() sends at most this much, the rest goes out
+ * on later loop passes so a full redraw never stalls the RPM task
+ */
+#ifndef LCD_FLUSH_MAX_CELLS
+#if LCD_DRIVER == LCD_DRIVER_TWI
+#define LCD_FLUSH_MAX_CELLS     SCREEN_COLS // Only queued, a whole row is one TWI transaction
+#else
+#define LCD_FLUSH_MAX_CELLS     4       // Characters sent per flush() call
+#endif
+#endif
+#ifndef LCD_FLUSH_BUDGET_US
+#define LCD_FLUSH_BUDGET_US     1000    // No new run is started past this
+#endif
+
 // Removed text constants to save flash memory - using direct strings
 
 /**
@@ -45,21 +70,33 @@ private:
     uint32_t lastRefresh;
     bool needsRefresh;
     bool forceRefreshFlag;
-    bool forceStaticLabelReset;  // Force static labels to be reinitialized
     
     // Cached values for change detection
     uint8_t lastWheel;
     uint16_t lastRPM;
     uint8_t lastMode;
-    bool isDisplayInitialized;  // Track if display has been initialized
-    bool messageModeInitialized;  // Track if message mode has been initialized
+    uint16_t lastMaxRPM;
+    
+    // Shadow framebuffers: screens render into backBuffer, flush() sends the
+    // cells that differ from frontBuffer (what the LCD is showing)
+    char frontBuffer[SCREEN_ROWS][SCREEN_COLS];
+    char backBuffer[SCREEN_ROWS][SCREEN_COLS];
+    uint8_t dirtyRows;  // Bit per row where backBuffer may differ from frontBuffer
+    uint8_t flushRow;   // Where the previous flush() stopped
+    uint8_t flushCol;
+    bool displayOnline; // Last seen isAvailable(), a comeback redraws everything
+    
+    /**
+     * Flag a row for the next flush, restarting it if it was part sent
+     */
+    void markDirty(uint8_t row);
     
     // Message buffer for temporary displays
     char messageBuffer[17];  // 16 chars + null terminator for LCD
     
     /**
-     * Update main display screen
-     * Shows wheel pattern, RPM, and mode
+     * Render main display screen
+     * Shows wheel pattern, RPM, mode and the wheel's RPM limit
      */
     void updateMainDisplay();
     
@@ -69,6 +106,14 @@ private:
      */
     void updateMessageDisplay();
     
+#if ENABLE_LOOP_PROFILER
+    /**
+     * Update diagnostics page
+     * Loop rate, worst pass and worst time per task stage in microseconds
+     */
+    void updateDiagnosticsDisplay();
+#endif
+    
     /**
      * Check if any values have changed since last update
      * @return true if display needs refresh
@@ -92,7 +137,7 @@ private:
     void formatMode(uint8_t mode, char* buffer, uint8_t bufferSize);
     
     /**
-     * Get wheel pattern name from PROGMEM
+     * Get wheel pattern name from the string pool
      * @param wheelIndex Index of wheel pattern
      * @param buffer Buffer to store wheel name
      * @param bufferSize Size of buffer
@@ -114,8 +159,56 @@ public:
     /**
      * Update display - call regularly in main loop
      * Handles mode timeouts and refresh logic
+     * @return true while changed cells are still being sent (see flush())
+     */
+    bool update();
+    
+    /**
+     * Blank the whole shadow screen (nothing is sent until flush())
+     */
+    void clearScreen();
+    
+    /**
+     * Draw text into the shadow screen, clipped at the right edge
+     * @param col Column position (0-based)
+     * @param row Row position (0-based)
+     * @param text Null-terminated string
+     */
+    void drawText(uint8_t col, uint8_t row, const char* text);
+    
+    /**
+     * Draw a string pool entry into the shadow screen
+     * @param col Column position (0-based)
+     * @param row Row position (0-based)
+     * @param id String pool ID (string_pool.h)
+     * @return Length of the text
      */
-    void update();
+    uint8_t drawString(uint8_t col, uint8_t row, StringId id);
+    
+    /**
+     * Draw text into a fixed width field, padding the rest with spaces
+     * Erases stale characters without resending unchanged ones
+     * @param col Column position (0-based)
+     * @param row Row position (0-based)
+     * @param text Null-terminated string
+     * @param width Field width in characters
+     */
+    void drawField(uint8_t col, uint8_t row, const char* text, uint8_t width);
+    
+    /**
+     * Send up to LCD_FLUSH_MAX_CELLS changed cells to the display, stopping
+     * early once LCD_FLUSH_BUDGET_US has been spent. Resumes where the
+     * previous call stopped. Adjacent changes go out as one run after a
+     * single cursor move. Also stops when the driver can't take a run
+     * without blocking
+     * @return true if changed cells are left
+     */
+    bool flush();
+    
+    /**
+     * Forget what the display shows, the next flushes redraw every cell
+     */
+    void invalidate();
     
     /**
      * Show temporary message with timeout
@@ -124,6 +217,13 @@ public:
      */
     void showMessage(const char* message, uint16_t duration);
     
+    /**
+     * Show a string pool entry as a temporary message
+     * @param id String pool ID (string_pool.h)
+     * @param duration Duration in milliseconds
+     */
+    void showMessage(StringId id, uint16_t duration);
+    
     /**
      * Enter startup display mode
      * Prevents main display from interfering with startup sequence
@@ -136,6 +236,12 @@ public:
      */
     void showStartupMessage(const char* message);
     
+    /**
+     * Show a string pool entry as the startup message
+     * @param id String pool ID (string_pool.h)
+     */
+    void showStartupMessage(StringId id);
+    
     /**
      * Exit startup mode and return to main display
      */
@@ -159,6 +265,24 @@ public:
      * @return true if display hardware is functional
      */
     bool isDisplayAvailable();
+    
+    /**
+     * Check the main screen (or whatever is showing) is fully on the display
+     * @return true if the display is up with nothing left to render or send
+     */
+    bool isIdle();
+    
+    /**
+     * Show the last boot's time to first edge and time to ready
+     */
+    void showBootTimes();
+    
+#if ENABLE_LOOP_PROFILER
+    /**
+     * Switch between the main display and the diagnostics page
+     */
+    void toggleDiagnostics();
+#endif
 };
 
 #endif
\ No newline at end of file
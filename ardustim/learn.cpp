@@ -0,0 +1,521 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Pattern learn mode
+ *
+ * See learn.h
+ */
+
+#include "learn.h"
+
+#if ENABLE_LEARN
+
+#include "capture.h"
+#include "globals.h"
+#include "comms.h"
+#include "wheel_defs.h"
+#include "wheel_gen.h"
+#include <ctype.h>
+
+#if ENABLE_CAPTURE
+#error "Learn mode and the ECU output capture share A3 and D7, build one or the other"
+#endif
+
+#define LEARN_CRANK_PIN     7
+#define LEARN_CAM_PIN       A3
+#define LEARN_FRAC          16384   /* A cycle, edge positions are fractions of it in the LEARN_DT_MASK bits */
+#define LEARN_SNAP          (LEARN_FRAC / 5)  /* Furthest an edge may move to a slice boundary, x slices */
+#define LEARN_NO_SLICE      0xFFFF
+#define LEARN_NO_EXPORT     0xFFFF
+#define LEARN_EXPORT_UNITS  5       /* Grid units per exported line */
+#define LEARN_CAM_MARKS     16      /* Cam rises kept to find the cam's own period */
+
+/* What learn_next() read */
+enum {
+  SCAN_END,
+  SCAN_SAME,              //A level the pin already had, an edge the ISR was too late for
+  SCAN_CRANK_RISE,
+  SCAN_CRANK_FALL,
+  SCAN_CAM_RISE,
+  SCAN_CAM_FALL,
+};
+
+/* A walk through learn_events[] */
+struct learn_scan {
+  uint16_t i;             //Next word
+  uint32_t t;             //Time of the last one read, ticks
+  uint8_t crank;          //Level, 2 = not seen yet
+  uint8_t cam;
+};
+
+/* What the recording turned out to be */
+struct learn_found {
+  uint8_t teeth;          //Crank teeth per crank period
+  uint8_t divs;           //Grid units per smallest tooth interval
+  uint16_t units;         //Grid units per cycle
+  uint8_t slices;         //Edges per grid unit
+  uint16_t degrees;
+  bool cam;
+};
+
+volatile uint16_t learn_events[LEARN_MAX_EVENTS];
+volatile uint16_t learn_count = 0;
+volatile uint32_t learn_last = 0;
+
+static uint8_t units[LEARN_MAX_EVENTS / 2];   /* Grid units of each crank tooth interval */
+static uint8_t state = LEARN_IDLE;
+static uint8_t result = LEARN_OK;
+static uint8_t hint_teeth = 0;
+static uint8_t cycle_kind = LEARN_CYCLE_AUTO;
+static struct learn_found found;
+static uint16_t export_at = LEARN_NO_EXPORT;
+
+ISR(PCINT1_vect)
+{
+  learn_record(LEARN_CAM | ((PINC & (1 << PINC3)) ? LEARN_LEVEL : 0));
+}
+
+ISR(PCINT2_vect)
+{
+  learn_record((PIND & (1 << PIND7)) ? LEARN_LEVEL : 0);
+}
+
+void learn_init()
+{
+  pinMode(LEARN_CRANK_PIN, INPUT);
+  pinMode(LEARN_CAM_PIN, INPUT);
+  /* Only the learn pins, the buttons on PORTD are scanned from Timer0 */
+  PCMSK1 = (1 << PCINT11);
+  PCMSK2 = (1 << PCINT23);
+  PCICR &= ~((1 << PCIE1) | (1 << PCIE2));
+}
+
+bool learn_start(uint8_t teeth, uint8_t cycle)
+{
+  if ((cycle >= MAX_LEARN_CYCLES) && (cycle != LEARN_CYCLE_STOP)) { return false; }
+
+  noInterrupts();
+  PCICR &= ~((1 << PCIE1) | (1 << PCIE2));
+  interrupts();
+  if (cycle == LEARN_CYCLE_STOP)
+  {
+    if (state == LEARN_RECORDING) { state = LEARN_IDLE; }
+    return true;
+  }
+
+  hint_teeth = teeth;
+  cycle_kind = cycle;
+  state = LEARN_RECORDING;
+  result = LEARN_OK;
+  noInterrupts();
+  learn_count = 0;
+  learn_last = micros();
+  interrupts();
+  /* Changes from before now are stale */
+  PCIFR = (1 << PCIF1) | (1 << PCIF2);
+  PCICR |= (1 << PCIE1) | (1 << PCIE2);
+  return true;
+}
+
+//! Reads the next word of the recording
+static uint8_t learn_next(struct learn_scan *s)
+{
+  if (s->i >= LEARN_MAX_EVENTS) { return SCAN_END; }
+
+  uint16_t word = learn_events[s->i++];
+  uint8_t level = (word & LEARN_LEVEL) ? 1 : 0;
+  s->t += word & LEARN_DT_MASK;
+  if (word & LEARN_CAM)
+  {
+    if (level == s->cam) { return SCAN_SAME; }
+    s->cam = level;
+    return level ? SCAN_CAM_RISE : SCAN_CAM_FALL;
+  }
+  if (level == s->crank) { return SCAN_SAME; }
+  s->crank = level;
+  return level ? SCAN_CRANK_RISE : SCAN_CRANK_FALL;
+}
+
+//! Moves on to the next crank rising edge
+static bool learn_next_rise(struct learn_scan *s)
+{
+  uint8_t kind;
+
+  while ((kind = learn_next(s)) != SCAN_END)
+  {
+    if (kind == SCAN_CRANK_RISE) { return true; }
+  }
+  return false;
+}
+
+//! Fits the crank tooth intervals to a grid, units[] of each
+/*!
+ * The grid starts at the smallest of the first few intervals / divs and
+ * follows the speed, each interval sets it for the next
+ * @return Intervals fitted, 0 if one is off the grid
+ */
+static uint16_t learn_fit(uint32_t smallest, uint8_t divs)
+{
+  struct learn_scan s = { 0, 0, 2, 2 };
+  float pitch = (float)smallest / divs;
+  uint16_t n = 0;
+
+  if (!learn_next_rise(&s)) { return 0; }
+  uint32_t rise = s.t;
+  while (learn_next_rise(&s))
+  {
+    uint32_t len = s.t - rise;
+    float q = len / pitch;
+    uint16_t u = q + 0.5f;
+    if ((u == 0) || (u > 255) || (q - u > 0.25f) || (u - q > 0.25f)) { return 0; }
+    units[n++] = u;
+    pitch = (float)len / u;
+    rise = s.t;
+  }
+  return n;
+}
+
+//! Turns the cycle from tooth first on into edge positions, in place at the start of learn_events[]
+/*!
+ * Each word keeps its LEARN_CAM and LEARN_LEVEL bits, the LEARN_DT_MASK bits
+ * become the position in the cycle, /LEARN_FRAC
+ * @param start Set to the pin levels just before the cycle, crank bit 0 and cam bit 1
+ * @return Words written, 0 if a pin doesn't end the cycle at the level it starts it
+ */
+static uint16_t learn_place(uint16_t first, uint16_t teeth, uint8_t *start)
+{
+  struct learn_scan s = { 0, 0, 2, 2 };
+  uint16_t rises = 0;
+  uint16_t out = 0;
+
+  /* To the first tooth of the cycle */
+  while (learn_next_rise(&s) && (rises++ < first)) { }
+  uint8_t cam_before = s.cam;
+  struct learn_scan ahead = s;
+  learn_next_rise(&ahead);
+
+  uint16_t tooth = first;
+  uint32_t rise = s.t;
+  uint32_t len = ahead.t - s.t;
+  uint32_t pos = 0;                         /* Grid units to the tooth */
+  learn_events[out++] = LEARN_LEVEL;       /* Its rising edge, at 0 */
+
+  uint8_t kind;
+  while ((kind = learn_next(&s)) != SCAN_END)
+  {
+    if (kind == SCAN_SAME) { continue; }
+    uint16_t word = (kind == SCAN_CAM_RISE || kind == SCAN_CAM_FALL) ? LEARN_CAM : 0;
+    if (kind == SCAN_CRANK_RISE || kind == SCAN_CAM_RISE) { word |= LEARN_LEVEL; }
+
+    if (kind == SCAN_CRANK_RISE)
+    {
+      pos += units[tooth++];
+      if (tooth == first + teeth) { break; }
+      rise = s.t;
+      learn_next_rise(&ahead);
+      len = ahead.t - s.t;
+      learn_events[out++] = word | (uint16_t)(pos * LEARN_FRAC / found.units);
+      continue;
+    }
+    /* Between this tooth and the next, as far as the time says */
+    float at = pos + units[tooth] * (float)(s.t - rise) / len;
+    uint16_t frac = at * LEARN_FRAC / found.units + 0.5f;
+    if (frac > LEARN_DT_MASK) { frac = LEARN_DT_MASK; }
+    learn_events[out++] = word | frac;
+  }
+
+  /* A pin has to be back where it started for the cycle to repeat */
+  if ((cam_before != 2) && (s.cam != 2) && (cam_before != s.cam)) { return 0; }
+  if (cam_before == 2) { cam_before = (s.cam == 1) ? 1 : 0; }
+  *start = cam_before ? 2 : 0;
+  return out;
+}
+
+//! Slice of a placed edge for slices per cycle, rounded
+static uint16_t learn_slice(uint16_t word, uint16_t slices)
+{
+  return ((uint32_t)(word & LEARN_DT_MASK) * slices + LEARN_FRAC / 2) / LEARN_FRAC;
+}
+
+//! Furthest a placed edge moves to its slice, x slices / LEARN_FRAC
+/*!
+ * @return LEARN_NO_SLICE if two edges of a pin share a slice, the pulse between them would be lost
+ */
+static uint16_t learn_snap_error(uint16_t count, uint16_t slices)
+{
+  uint16_t last[2] = { LEARN_NO_SLICE, LEARN_NO_SLICE };
+  uint16_t first[2] = { LEARN_NO_SLICE, LEARN_NO_SLICE };
+  uint16_t worst = 0;
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    uint16_t word = learn_events[i];
+    uint8_t pin = (word & LEARN_CAM) ? 1 : 0;
+    uint32_t x = (uint32_t)(word & LEARN_DT_MASK) * slices;
+    uint16_t k = learn_slice(word, slices);
+    uint32_t at = (uint32_t)k * LEARN_FRAC;
+    uint16_t err = (x > at) ? x - at : at - x;
+
+    /* The end of the cycle is slice 0 of the next */
+    if ((k == last[pin]) || ((k == slices) && (first[pin] == 0))) { return LEARN_NO_SLICE; }
+    if (first[pin] == LEARN_NO_SLICE) { first[pin] = k; }
+    last[pin] = k;
+    if (err > worst) { worst = err; }
+  }
+  return worst;
+}
+
+//! Writes the placed edges into gen_edges[] as slices, interrupts off
+static void learn_render(uint16_t count, uint16_t slices, uint8_t start)
+{
+  uint8_t levels = start;
+  uint16_t i = count;
+
+  /* Edges that round up to the end of the cycle show in its first slice */
+  while (i && (learn_slice(learn_events[i - 1], slices) == slices)) { i--; }
+  for (uint16_t w = i; w < count; w++)
+  {
+    uint8_t bit = (learn_events[w] & LEARN_CAM) ? 2 : 1;
+    levels = (learn_events[w] & LEARN_LEVEL) ? (levels | bit) : (levels & ~bit);
+  }
+  count = i;
+
+  i = 0;
+  for (uint16_t k = 0; k < slices; k++)
+  {
+    while ((i < count) && (learn_slice(learn_events[i], slices) == k))
+    {
+      uint8_t bit = (learn_events[i] & LEARN_CAM) ? 2 : 1;
+      levels = (learn_events[i] & LEARN_LEVEL) ? (levels | bit) : (levels & ~bit);
+      i++;
+    }
+    gen_edges[k] = levels;
+  }
+}
+
+//! Works the recording out into an edge table and plays it
+static uint8_t learn_analyse()
+{
+  struct learn_scan s = { 0, 0, 2, 2 };
+  uint16_t rises = 0;
+  uint16_t cam_changes = 0;
+  uint16_t cam_tooth[LEARN_CAM_MARKS];
+  uint8_t cam_rises = 0;
+  uint32_t smallest = 0xFFFFFFFF;
+  uint32_t rise = 0;
+  uint8_t kind;
+
+  /* Teeth, the smallest of the first few intervals and where the cam rises */
+  while ((kind = learn_next(&s)) != SCAN_END)
+  {
+    if (kind == SCAN_CRANK_RISE)
+    {
+      if (rises && (rises <= 8) && (s.t - rise < smallest)) { smallest = s.t - rise; }
+      rise = s.t;
+      rises++;
+    }
+    else if ((kind == SCAN_CAM_RISE) || (kind == SCAN_CAM_FALL))
+    {
+      cam_changes++;
+      if ((kind == SCAN_CAM_RISE) && rises && (cam_rises < LEARN_CAM_MARKS)) { cam_tooth[cam_rises++] = rises - 1; }
+    }
+  }
+  if ((rises < 3) || (smallest == 0)) { return LEARN_ERR_CRANK; }
+
+  uint16_t n = 0;
+  for (found.divs = 1; found.divs <= LEARN_MAX_DIVS; found.divs++)
+  {
+    n = learn_fit(smallest, found.divs);
+    if (n) { break; }
+  }
+  if (n == 0) { return LEARN_ERR_GRID; }
+  found.cam = (cam_changes >= 2);
+
+  /* Shortest repeating run of intervals, seen twice */
+  uint16_t period = 1;
+  for ( ; period <= n / 2; period++)
+  {
+    uint16_t j = 0;
+    while ((j + period < n) && (units[j] == units[j + period])) { j++; }
+    if (j + period == n) { break; }
+  }
+  if (period > n / 2) { return LEARN_ERR_SHORT; }
+
+  uint8_t periods = (cycle_kind == LEARN_CYCLE_720) || ((cycle_kind == LEARN_CYCLE_AUTO) && found.cam) ? 2 : 1;
+  found.degrees = ((cycle_kind == LEARN_CYCLE_360) || ((cycle_kind == LEARN_CYCLE_AUTO) && !found.cam)) ? 360 : 720;
+  uint16_t first = 0;
+  uint16_t teeth;
+  if (period > 1)
+  {
+    /* From the first tooth after the longest interval, the gap */
+    uint8_t longest = 0;
+    for (uint16_t j = 0; j < period; j++)
+    {
+      if (units[j] > longest) { longest = units[j]; first = j + 1; }
+    }
+    found.teeth = period;
+    teeth = period * periods;
+  }
+  else if (hint_teeth)
+  {
+    /* Evenly spaced, told how many make a period */
+    if (cam_rises) { first = cam_tooth[0]; }
+    found.teeth = hint_teeth;
+    teeth = (uint16_t)hint_teeth * periods;
+  }
+  else if (cam_rises >= 3)
+  {
+    /* Evenly spaced, a cycle is the shortest run of cam rises that repeats */
+    uint8_t marks = 1;
+    for ( ; marks <= (cam_rises - 1) / 2; marks++)
+    {
+      uint8_t j = 0;
+      while ((j + marks + 1 < cam_rises) &&
+             (cam_tooth[j + 1] - cam_tooth[j] == cam_tooth[j + marks + 1] - cam_tooth[j + marks])) { j++; }
+      if (j + marks + 1 == cam_rises) { break; }
+    }
+    if (marks > (cam_rises - 1) / 2) { return LEARN_ERR_MARK; }
+    first = cam_tooth[0];
+    teeth = cam_tooth[marks] - cam_tooth[0];
+    found.teeth = ((uint32_t)teeth * 360) / found.degrees;
+  }
+  else
+  {
+    return LEARN_ERR_MARK;
+  }
+  if ((teeth == 0) || (first + teeth > n)) { return LEARN_ERR_SHORT; }
+
+  found.units = 0;
+  for (uint16_t j = first; j < first + teeth; j++) { found.units += units[j]; }
+  if (found.units > GEN_MAX_EDGES) { return LEARN_ERR_SIZE; }
+
+  uint8_t start;
+  uint16_t count = learn_place(first, teeth, &start);
+  if (count == 0) { return LEARN_ERR_LEVELS; }
+
+  /* Fewest slices per grid unit that put every edge close enough */
+  uint16_t best_err = LEARN_NO_SLICE;
+  found.slices = 0;
+  for (uint8_t per = 1; per <= GEN_MAX_SLICES; per++)
+  {
+    uint16_t slices = found.units * per;
+    if (slices > GEN_MAX_EDGES) { break; }
+    uint16_t err = learn_snap_error(count, slices);
+    if (err < best_err)
+    {
+      best_err = err;
+      found.slices = per;
+    }
+    if (err <= LEARN_SNAP) { break; }
+  }
+  if (found.slices == 0) { return LEARN_ERR_EDGES; }
+
+  uint16_t edges = found.units * found.slices;
+  noInterrupts();
+  learn_render(count, edges, start);
+  genLearned.edges = edges;
+  genLearned.degrees = found.degrees;
+  genLearned.teeth = found.teeth;
+  genLearned.units = (found.divs == 1) ? ((uint32_t)found.units * found.teeth) / teeth : 0; /* Per crank period */
+  genLearned.cam = found.cam;
+  config.wheel = GENERATED_WHEEL;
+  interrupts();
+  display_new_wheel();
+  return LEARN_OK;
+}
+
+bool learn_task()
+{
+  if ((state != LEARN_RECORDING) || (learn_count < LEARN_MAX_EVENTS)) { return false; }
+
+  PCICR &= ~((1 << PCIE1) | (1 << PCIE2));
+  /* Once per recording, up to ~150ms of loop() time */
+  result = learn_analyse();
+  state = LEARN_DONE;
+  return false;
+}
+
+//! Sends the wheel_defs.h lines before the edges, named after the learned wheel
+static void learn_export_head()
+{
+  char name[21]; // Wheel names are sized for the 20 column LCD
+  char id[21];
+  uint8_t len = gen_name(name, sizeof(name));
+
+  /* "Learned 60-2 Cam" -> LEARNED_60_2_CAM and learned_60_2_cam */
+  for (uint8_t i = 0; i <= len; i++)
+  {
+    char c = name[i];
+    if ((c == ' ') || (c == '-')) { c = '_'; }
+    id[i] = toupper(c);
+  }
+  Serial.print("  X(");
+  Serial.print(id);
+  for (uint8_t i = 0; i < len; i++) { id[i] = tolower(id[i]); }
+  Serial.print(", ");
+  Serial.print(id);
+  Serial.print(", \"");
+  Serial.print(name);
+  Serial.print("\", ");
+  Serial.print(genLearned.degrees);
+  Serial.println(") /* Learned */ \\");
+  Serial.print(" WHEEL_EDGES(");
+  Serial.print(id);
+  Serial.println(",");
+  Serial.print("   { /* ");
+  Serial.print(name);
+  Serial.println(" */");
+}
+
+bool learn_report()
+{
+  uint16_t edges = genLearned.edges;
+
+  if (export_at == LEARN_NO_EXPORT)
+  {
+    Serial.print(state);
+    Serial.print(",");
+    Serial.print(result);
+    Serial.print(",");
+    Serial.print(learn_count);
+    Serial.print(",");
+    Serial.print(found.teeth);
+    Serial.print(",");
+    Serial.print(found.units);
+    Serial.print(",");
+    Serial.print(found.divs);
+    Serial.print(",");
+    Serial.print(found.cam);
+    Serial.print(",");
+    Serial.print(found.degrees);
+    Serial.print(",");
+    Serial.println(edges);
+    if (edges == 0) { return false; }
+    learn_export_head();
+    export_at = 0;
+  }
+
+  /* The edges a slice at a time, LEARN_EXPORT_UNITS grid units a line */
+  uint16_t line = (uint16_t)found.slices * LEARN_EXPORT_UNITS;
+  while (export_at < edges)
+  {
+    if (Serial.availableForWrite() < 24) { return true; } //Room for a value and the line's comment
+    if ((export_at % line) == 0) { Serial.print("     "); }
+    Serial.print(gen_edges[export_at++]);
+    Serial.print((export_at < edges) ? "," : " ");
+    if (((export_at % line) == 0) || (export_at == edges))
+    {
+      /* Crank degrees the line covers */
+      uint16_t from = ((uint32_t)((export_at - 1) / line) * line * genLearned.degrees) / edges;
+      Serial.print("  /* ");
+      Serial.print(from);
+      Serial.print("-");
+      Serial.print(((uint32_t)export_at * genLearned.degrees) / edges);
+      Serial.println(" */");
+    }
+  }
+  Serial.println("   });");
+  export_at = LEARN_NO_EXPORT;
+  return false;
+}
+
+#endif
@@ -0,0 +1,136 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Pattern learn mode
+ *
+ * Records a real engine's crank (D7, PCINT23) and cam (A3, PCINT11) signals
+ * and turns them into an edge table. The pin change ISRs only timestamp:
+ * each edge is one 16 bit word in learn_events[], the channel, the level
+ * after the change and the time since the edge before in LEARN_TICK_US
+ * steps. An edge later than LEARN_DT_MAX after the one before is a stalled
+ * engine and the recording starts over. Once the buffer is full,
+ * learn_task() works it out in loop() context:
+ *
+ *   - The crank rising edges are fitted to the coarsest angular grid they
+ *     all fall on (a pitch, tracked through the speed changes, or a fraction
+ *     of it for wheels with uneven teeth) and each tooth interval becomes
+ *     a number of grid units: a 60-2 is 57 ones and a 3
+ *   - The shortest run of intervals that repeats is the crank period, one
+ *     revolution unless told otherwise. Evenly spaced teeth have no period of
+ *     their own, the cam or the teeth per revolution from 'U' give it one
+ *   - A cycle is one period, or two with a cam (720 degrees), starting at the
+ *     first tooth after the longest interval (the gap). Falling crank edges
+ *     and cam edges are placed between the crank teeth either side of them,
+ *     so speed changes between teeth don't smear them
+ *   - Like the N-M generator, every grid unit is split into the fewest slices
+ *     that put each edge within a fifth of a slice of where it was seen
+ *
+ * The result goes straight into gen_edges[] and GENERATED_WHEEL is selected,
+ * see wheel_gen.h. It isn't saved, 'u' also sends it in wheel_defs.h syntax
+ * to paste in.
+ *
+ * Shares A3 and D7 with the ECU output capture (capture.h), build one or
+ * the other. Compiles out completely unless built with -DENABLE_LEARN=1.
+ */
+#ifndef __LEARN_H__
+#define __LEARN_H__
+
+#ifndef ENABLE_LEARN
+#define ENABLE_LEARN 0  // Default to disabled, costs ~1KB RAM with the default buffer
+#endif
+
+#if ENABLE_LEARN
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#ifndef LEARN_MAX_EVENTS
+#define LEARN_MAX_EVENTS    384   /* Edges recorded, three turns of a 60-2 with a cam */
+#endif
+#define LEARN_TICK_SHIFT    3     /* micros() >> 3, 8us steps */
+#define LEARN_DT_MAX        0x3FFF  /* 131ms, more is a stall */
+#define LEARN_MAX_DIVS      12    /* Finest grid tried, the smallest tooth interval / 12 */
+
+/* learn_events[] words */
+#define LEARN_CAM           0x8000
+#define LEARN_LEVEL         0x4000
+#define LEARN_DT_MASK       0x3FFF
+
+/* What a cycle of the recording is, 'U' */
+enum {
+  LEARN_CYCLE_AUTO,       //720 degrees, two crank periods, with a cam, else 360 and one
+  LEARN_CYCLE_360,        //One crank period, 360 degrees
+  LEARN_CYCLE_720,        //Two crank periods, 720 degrees
+  LEARN_CYCLE_720_SLOW,   //One crank period over 720 degrees, the "crank" turns at cam speed
+  MAX_LEARN_CYCLES,
+  LEARN_CYCLE_STOP = 255  //Stops a recording
+};
+
+enum {
+  LEARN_IDLE,
+  LEARN_RECORDING,
+  LEARN_DONE,             //'u' says how it went
+};
+
+enum {
+  LEARN_OK,
+  LEARN_ERR_CRANK,        //Fewer than 3 crank teeth
+  LEARN_ERR_GRID,         //Teeth not on any grid up to LEARN_MAX_DIVS
+  LEARN_ERR_MARK,         //Evenly spaced teeth, no repeating cam and no teeth per revolution
+  LEARN_ERR_SHORT,        //Not two crank periods, or not a whole cycle after the first gap
+  LEARN_ERR_SIZE,         //More grid units per cycle than GEN_MAX_EDGES
+  LEARN_ERR_EDGES,        //Two edges of a pin in one slice at every resolution
+  LEARN_ERR_LEVELS,       //A pin ends the cycle at another level than it starts, a missed edge
+};
+
+/* Between the ISRs and learn_task() */
+extern volatile uint16_t learn_events[LEARN_MAX_EVENTS];
+extern volatile uint16_t learn_count;
+extern volatile uint32_t learn_last;
+
+//! Makes the learn pins inputs, not recording
+void learn_init();
+
+//! Starts a recording, or stops one
+/*!
+ * @param teeth Crank teeth per crank period for evenly spaced teeth, 0 = from the cam
+ * @param cycle LEARN_CYCLE_x
+ * @return false, nothing changed, if cycle is out of range
+ */
+bool learn_start(uint8_t teeth, uint8_t cycle);
+
+//! Works out a full recording and selects the learned wheel
+bool learn_task();
+
+//! Sends the learn state and, once a wheel is learned, the wheel_defs.h entry for it
+/*!
+ * @return true while there is more to send, the serial task calls it again
+ */
+bool learn_report();
+
+//! Timestamps a learn pin change, pin change ISR context
+static inline void learn_record(uint16_t word)
+{
+  uint16_t n = learn_count;
+
+  if (n >= LEARN_MAX_EVENTS) { return; }
+  uint32_t now = micros();
+  uint32_t dt = (now - learn_last) >> LEARN_TICK_SHIFT;
+  if (dt > LEARN_DT_MAX)
+  {
+    /* Stalled, the first edge of a new recording */
+    n = 0;
+    dt = 0;
+    learn_last = now;
+  }
+  else
+  {
+    /* Whole ticks only, the remainder carries on into the next edge */
+    learn_last += dt << LEARN_TICK_SHIFT;
+  }
+  learn_events[n] = word | dt;
+  learn_count = n + 1;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Main loop profiler
+ *
+ * Pass and stage accounting behind the PROF_* macros, the per task totals
+ * are kept by the scheduler
+ */
+
+#include "loop_profiler.h"
+
+#if ENABLE_LOOP_PROFILER
+
+#include "scheduler.h"
+#include <string.h>
+#include <avr/pgmspace.h>
+
+struct loop_profile loopProfile;
+
+/* Two letter stage labels, shared by the serial dump and the LCD page */
+static const char prof_labels[PROF_STAGES][3] PROGMEM = {
+  "SR", "ST", "UI", "LC", "AD", "SW", "CP", "RP"
+};
+
+//! Starts timing one loop() pass
+void profiler_pass_begin()
+{
+  uint32_t now = micros();
+
+  loopProfile.pass_start = now;
+  loopProfile.task_us = 0;
+  if (now - loopProfile.window_start >= 1000000UL)
+  {
+    loopProfile.loop_hz = loopProfile.window_passes;
+    loopProfile.window_passes = 0;
+    loopProfile.window_start = now;
+  }
+}
+
+//! Charges the time since the previous mark to a stage
+void profiler_mark(uint8_t stage)
+{
+  uint32_t now = micros();
+  uint32_t spent = now - loopProfile.mark;
+  struct prof_stage *s = &loopProfile.stages[stage];
+
+  s->total_us += spent;
+  s->calls++;
+  if (spent > s->max_us) { s->max_us = (spent > 0xFFFF) ? 0xFFFF : spent; }
+  loopProfile.mark = now;
+}
+
+//! Finishes timing one loop() pass, what the tasks didn't use is the scheduler's
+void profiler_pass_end()
+{
+  uint32_t spent = micros() - loopProfile.pass_start;
+  uint32_t sched = (spent > loopProfile.task_us) ? spent - loopProfile.task_us : 0;
+
+  if (spent > loopProfile.worst_pass_us) { loopProfile.worst_pass_us = spent; }
+  loopProfile.sched_us += sched;
+  if (sched > loopProfile.sched_max_us) { loopProfile.sched_max_us = (sched > 0xFFFF) ? 0xFFFF : sched; }
+  loopProfile.passes++;
+  loopProfile.window_passes++;
+}
+
+//! Clears the pass and stage counters and the scheduler's task totals
+void profiler_reset()
+{
+  memset(&loopProfile, 0, sizeof(loopProfile));
+  loopProfile.window_start = micros();
+  for (uint8_t x = 0; x < scheduler_task_count(); x++)
+  {
+    struct task *t = scheduler_task(x);
+    t->runs = 0;
+    t->total_us = 0;
+  }
+}
+
+//! Returns a stage's two letter label (in RAM, valid until the next call)
+const char *profiler_stage_label(uint8_t stage)
+{
+  static char label[3];
+  strcpy_P(label, prof_labels[stage]);
+  return label;
+}
+
+//! Sends the profile over serial
+/*!
+ * One line per task, in priority order: label,runs,total_us,worst_us
+ * Then one line per stage: LABEL,calls,total_us,max_us
+ * Then the scheduler's overhead: sched,passes,total_us,max_us
+ * Last line: passes,worst_pass_us,loop_hz
+ */
+void profiler_dump()
+{
+  char buf[8];
+
+  for (uint8_t x = 0; x < scheduler_task_count(); x++)
+  {
+    const struct task *t = scheduler_task(x);
+    strncpy_P(buf, t->label, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    Serial.print(buf);
+    Serial.print(",");
+    Serial.print(t->runs);
+    Serial.print(",");
+    Serial.print(t->total_us);
+    Serial.print(",");
+    Serial.println(t->worst_us);
+  }
+  for (uint8_t x = 0; x < PROF_STAGES; x++)
+  {
+    Serial.print(profiler_stage_label(x));
+    Serial.print(",");
+    Serial.print(loopProfile.stages[x].calls);
+    Serial.print(",");
+    Serial.print(loopProfile.stages[x].total_us);
+    Serial.print(",");
+    Serial.println(loopProfile.stages[x].max_us);
+  }
+  Serial.print("sched,");
+  Serial.print(loopProfile.passes);
+  Serial.print(",");
+  Serial.print(loopProfile.sched_us);
+  Serial.print(",");
+  Serial.println(loopProfile.sched_max_us);
+  Serial.print(loopProfile.passes);
+  Serial.print(",");
+  Serial.print(loopProfile.worst_pass_us);
+  Serial.print(",");
+  Serial.println(loopProfile.loop_hz);
+}
+
+#endif
@@ -0,0 +1,82 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Main loop profiler
+ *
+ * Accumulates micros() spent and run counts per scheduler task (scheduler.h
+ * does the timing around each task body, so every task is covered), the
+ * scheduler's own overhead, the worst single pass and the loop rate. loop()
+ * brackets scheduler_run() with PROF_PASS_BEGIN()/PROF_PASS_END().
+ *
+ * Inside the tasks, PROF_MARK() splits the time further into the stages
+ * below with call counts; a stage's time runs from the previous mark or the
+ * start of its task. Read with serial 'o', cleared with 'O', and shown on the
+ * LCD diagnostics page (ABT button).
+ *
+ * Compiles out completely unless built with -DENABLE_LOOP_PROFILER=1.
+ */
+#ifndef __LOOP_PROFILER_H__
+#define __LOOP_PROFILER_H__
+
+#ifndef ENABLE_LOOP_PROFILER
+#define ENABLE_LOOP_PROFILER 0  // Default to disabled, costs ~100 bytes RAM
+#endif
+
+#if ENABLE_LOOP_PROFILER
+
+#include <stdint.h>
+#include <Arduino.h>
+
+/* Task stages */
+enum {
+  PROF_SERIAL,        // commandParser()
+  PROF_STARTUP,       // handleStartupSequence()
+  PROF_UI,            // uiController.update()
+  PROF_LCD,           // lcdManager.update()
+  PROF_ADC,           // Pot smoothing and scaling
+  PROF_SWEEP,         // Sweep stepping
+  PROF_COMPRESSION,   // calculateCompressionModifier()
+  PROF_SETRPM,        // setRPM()
+  PROF_STAGES
+};
+
+struct prof_stage {
+  uint32_t total_us;
+  uint32_t calls;
+  uint16_t max_us;
+};
+
+struct loop_profile {
+  struct prof_stage stages[PROF_STAGES];
+  uint32_t passes;
+  uint32_t worst_pass_us;
+  uint32_t sched_us;        /* Pass time outside the task bodies */
+  uint16_t sched_max_us;
+  uint16_t loop_hz;         /* Passes counted over the last full second */
+  uint16_t window_passes;
+  uint32_t window_start;
+  uint32_t pass_start;
+  uint32_t task_us;         /* Task time in the pass so far */
+  uint32_t mark;            /* Where the next stage started */
+};
+extern struct loop_profile loopProfile;
+
+void profiler_pass_begin();
+void profiler_mark(uint8_t stage);
+void profiler_pass_end();
+void profiler_reset();
+void profiler_dump();
+const char *profiler_stage_label(uint8_t stage);
+
+#define PROF_PASS_BEGIN() profiler_pass_begin()
+#define PROF_MARK(stage) profiler_mark(stage)
+#define PROF_PASS_END() profiler_pass_end()
+
+#else
+
+#define PROF_PASS_BEGIN()
+#define PROF_MARK(stage)
+#define PROF_PASS_END()
+
+#endif
+
+#endif
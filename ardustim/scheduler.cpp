@@ -0,0 +1,110 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Cooperative loop() scheduler
+ *
+ * See scheduler.h for the rules
+ */
+
+#include "scheduler.h"
+#include <avr/pgmspace.h>
+
+static struct task *taskTable = NULL;
+static uint8_t taskCount = 0;
+
+//! Registers the task table, tasks are run in table order
+void scheduler_init(struct task *tasks, uint8_t count)
+{
+  uint16_t now = (uint16_t)millis();
+
+  taskTable = tasks;
+  taskCount = count;
+  for (uint8_t x = 0; x < taskCount; x++)
+  {
+    taskTable[x].last_run_ms = now;
+    taskTable[x].pending = true; /* Everything runs once on the first pass */
+  }
+}
+
+//! Runs one pass over the task table, call from loop()
+void scheduler_run()
+{
+  uint32_t passStart = micros();
+
+  for (uint8_t x = 0; x < taskCount; x++)
+  {
+    struct task *t = &taskTable[x];
+    uint16_t now = (uint16_t)millis();
+
+    if (!t->pending && (uint16_t)(now - t->last_run_ms) < t->period_ms) { continue; }
+
+    /* Slack only work waits for the next pass once this one is used up */
+    if ((x >= SCHED_CRITICAL_TASKS) && (micros() - passStart >= SCHED_PASS_BUDGET_US) && (t->deferrals < SCHED_MAX_DEFERRALS))
+    {
+      t->deferrals++;
+      continue;
+    }
+
+    uint32_t start = micros();
+#if ENABLE_LOOP_PROFILER
+    loopProfile.mark = start; /* A task's first stage starts with it */
+#endif
+    t->pending = t->fn();
+    uint32_t spent = micros() - start;
+
+    t->last_run_ms = now;
+    t->deferrals = 0;
+    if (spent > t->worst_us) { t->worst_us = (spent > 0xFFFF) ? 0xFFFF : spent; }
+    if ((spent > t->budget_us) && (t->overruns != 0xFFFF)) { t->overruns++; }
+#if ENABLE_LOOP_PROFILER
+    t->runs++;
+    t->total_us += spent;
+    loopProfile.task_us += spent;
+#endif
+  }
+}
+
+//! Number of tasks in the table
+uint8_t scheduler_task_count()
+{
+  return taskCount;
+}
+
+//! A task of the table, in priority order
+struct task *scheduler_task(uint8_t x)
+{
+  return &taskTable[x];
+}
+
+//! Clears the overrun and worst case counters
+void scheduler_reset()
+{
+  for (uint8_t x = 0; x < taskCount; x++)
+  {
+    taskTable[x].overruns = 0;
+    taskTable[x].worst_us = 0;
+  }
+}
+
+//! Sends the task table over serial
+/*!
+ * One line per task, in priority order: label,period_ms,budget_us,worst_us,overruns
+ */
+void scheduler_dump()
+{
+  char buf[8];
+
+  for (uint8_t x = 0; x < taskCount; x++)
+  {
+    strncpy_P(buf, taskTable[x].label, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    Serial.print(buf);
+    Serial.print(",");
+    Serial.print(taskTable[x].period_ms);
+    Serial.print(",");
+    Serial.print(taskTable[x].budget_us);
+    Serial.print(",");
+    Serial.print(taskTable[x].worst_us);
+    Serial.print(",");
+    Serial.println(taskTable[x].overruns);
+  }
+}
@@ -0,0 +1,55 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Cooperative loop() scheduler
+ *
+ * A static table of tasks, highest priority first. Each pass runs every task
+ * that is due (its period has elapsed, or it asked to be run again), in
+ * table order. Tasks after the first SCHED_CRITICAL_TASKS only run in the
+ * slack: once a pass has used SCHED_PASS_BUDGET_US they're deferred to the
+ * next pass, at most SCHED_MAX_DEFERRALS times in a row so they can't starve.
+ *
+ * Long jobs (LCD redraws, pattern dumps) do a slice per call and return true
+ * while they have more to do. Runs longer than a task's budget are counted as
+ * overruns, read them with serial 'q'.
+ */
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "loop_profiler.h"
+
+#define SCHED_PASS_BUDGET_US  1000  /* Time per pass before slack tasks get deferred */
+#define SCHED_CRITICAL_TASKS  1     /* Leading tasks that are never deferred */
+#define SCHED_MAX_DEFERRALS   20    /* Passes a slack task may be pushed back in a row */
+
+//! Task body, returns true if it has more work pending
+typedef bool (*task_fn)();
+
+struct task {
+  task_fn fn;
+  const char *label;      /* PROGMEM */
+  uint8_t period_ms;      /* 0 = every pass */
+  uint16_t budget_us;
+  /* Runtime state */
+  uint16_t last_run_ms;
+  uint16_t overruns;
+  uint16_t worst_us;
+  uint8_t deferrals;
+  bool pending;
+#if ENABLE_LOOP_PROFILER
+  uint32_t runs;          /* Totals for the loop profiler, cleared with 'O' */
+  uint32_t total_us;
+#endif
+};
+
+#define TASK(fn, label, period_ms, budget_us) { fn, label, period_ms, budget_us, 0, 0, 0, 0, false }
+
+void scheduler_init(struct task *tasks, uint8_t count);
+void scheduler_run();
+void scheduler_dump();
+void scheduler_reset();
+uint8_t scheduler_task_count();
+struct task *scheduler_task(uint8_t x);
+
+#endif
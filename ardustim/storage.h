@@ -10,6 +10,8 @@
 #define EEPROM_COMPRESSION_TYPE 15
 #define EEPROM_COMPRESSION_RPM  16 //Note this is 2 bytes
 #define EEPROM_COMPRESSION_OFFSET 18 //Note this is 2 bytes
+#define EEPROM_BOOT_MODE        20
+#define EEPROM_GEN_PARAMS       21 //Note this is sizeof(struct gen_params), 5 bytes
 
 void loadConfig();
 void saveConfig();
@@ -4,6 +4,7 @@
 #include "ardustim.h"
 #include "enums.h"
 #include "globals.h"
+#include "wheel_gen.h"
 
 void loadConfig()
 {
@@ -11,7 +12,7 @@ void loadConfig()
   if(EEPROM.read(EEPROM_VERSION) == 255)
   {
     //New arduino
-    config.wheel = 5; //36-1
+    config.wheel = THIRTY_SIX_MINUS_ONE;
     currentStatus.rpm = 3000;
     currentStatus.base_rpm = 3000;
     config.mode = POT_RPM;
@@ -26,6 +27,9 @@ void loadConfig()
     config.compressionRPM = 400;
     config.compressionOffset = 0;
 
+    bootStatus.mode = BOOT_ANIMATED;
+    gen_defaults(&genParams);
+
     saveConfig();
   }
   else
@@ -68,15 +72,19 @@ void loadConfig()
     lowByte = EEPROM.read(EEPROM_COMPRESSION_OFFSET+1);
     config.compressionOffset = word(highByte, lowByte);
     //config.compressionType = COMPRESSION_TYPE_6CYL_4STROKE;
+    bootStatus.mode = EEPROM.read(EEPROM_BOOT_MODE);
+    EEPROM.get(EEPROM_GEN_PARAMS, genParams);
 
     //Error checking
-    if(config.wheel >= MAX_WHEELS) { config.wheel = 5; }
+    if(config.wheel >= MAX_WHEELS) { config.wheel = THIRTY_SIX_MINUS_ONE; }
     if(config.mode >= MAX_MODES) { config.mode = FIXED_RPM; }
     if(currentStatus.rpm > 15000) { currentStatus.rpm = 4000; }
     if(currentStatus.base_rpm > 15000) { currentStatus.base_rpm = 4000; }
     if(config.compressionType > COMPRESSION_TYPE_8CYL_4STROKE) { config.compressionType = COMPRESSION_TYPE_4CYL_4STROKE; }
     if(config.compressionRPM > 1000) { config.compressionRPM = 400; }
     if(config.compressionOffset > 359) { config.compressionOffset = 0; }
+    if(bootStatus.mode >= MAX_BOOT_MODES) { bootStatus.mode = BOOT_ANIMATED; } //Also EEPROMs saved before boot modes existed
+    if(!gen_params_valid(&genParams)) { gen_defaults(&genParams); } //Also EEPROMs saved before the generator existed
   }
 }
 
@@ -121,4 +129,6 @@ void saveConfig()
   lowByte = lowByte(config.compressionOffset);
   EEPROM.update(EEPROM_COMPRESSION_OFFSET, highByte);
   EEPROM.update(EEPROM_COMPRESSION_OFFSET+1, lowByte);
+  EEPROM.update(EEPROM_BOOT_MODE, bootStatus.mode);
+  EEPROM.put(EEPROM_GEN_PARAMS, genParams); //put() only writes the bytes that changed
 }
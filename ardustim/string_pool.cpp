@@ -0,0 +1,76 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Flash string pool
+ *
+ * Storage for STRING_POOL, the dictionary, and the one decoder both go through
+ */
+
+#include "string_pool.h"
+#include "globals.h"
+#include "wheel_gen.h"
+
+#define STRING_POOL_TEXT(id, text) static const char id##_text[] PROGMEM = text;
+STRING_POOL(STRING_POOL_TEXT)
+#undef STRING_POOL_TEXT
+
+#define STRING_POOL_PTR(id, text) id##_text,
+static const char * const pool[STR_COUNT] PROGMEM = {
+  STRING_POOL(STRING_POOL_PTR)
+};
+#undef STRING_POOL_PTR
+
+#if ENABLE_STRING_DICT
+static const char w_crank_cam[] PROGMEM = W_CRANK_CAM;
+static const char w_crank[] PROGMEM = W_CRANK;
+static const char w_cam[] PROGMEM = W_CAM;
+static const char w_cyl_dizzy[] PROGMEM = W_CYL_DIZZY;
+static const char w_mitsubishi[] PROGMEM = W_MITSUBISHI;
+static const char w_mazda[] PROGMEM = W_MAZDA;
+static const char w_36_2_2_2[] PROGMEM = W_36_2_2_2;
+static const char w_toyota[] PROGMEM = W_TOYOTA;
+
+/* Indexed by token - 0x80, same order as the D_* tokens */
+static const char * const dictionary[] PROGMEM = {
+  w_crank_cam, w_crank, w_cam, w_cyl_dizzy, w_mitsubishi,
+  w_mazda, w_36_2_2_2, w_toyota
+};
+#define DICT_WORDS (sizeof(dictionary) / sizeof(dictionary[0]))
+#endif
+
+//! Copies a flash string into buf, expanding any dictionary tokens
+static uint8_t pool_decode(PGM_P src, char *buf, uint8_t size)
+{
+  uint8_t len = 0;
+  uint8_t c;
+
+  while ((c = pgm_read_byte(src++)) && (len < size - 1))
+  {
+#if ENABLE_STRING_DICT
+    if ((c >= 0x80) && ((uint8_t)(c - 0x80) < DICT_WORDS))
+    {
+      PGM_P word = (PGM_P)pgm_read_ptr(&dictionary[c - 0x80]);
+      while ((c = pgm_read_byte(word++)) && (len < size - 1))
+      {
+        buf[len++] = c;
+      }
+      continue;
+    }
+#endif
+    buf[len++] = c;
+  }
+  buf[len] = '\0';
+  return len;
+}
+
+uint8_t pool_copy(uint8_t id, char *buf, uint8_t size)
+{
+  if (id >= STR_COUNT) { id = STR_UNKNOWN; }
+  return pool_decode((PGM_P)pgm_read_ptr(&pool[id]), buf, size);
+}
+
+uint8_t pool_wheel_name(uint8_t wheel, char *buf, uint8_t size)
+{
+  if (wheel >= MAX_WHEELS) { return pool_copy(STR_UNKNOWN, buf, size); }
+  if (wheel == GENERATED_WHEEL) { return gen_name(buf, size); }
+  return pool_decode((PGM_P)pgm_read_ptr(&Wheels[wheel].decoder_name), buf, size);
+}
@@ -0,0 +1,122 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Flash string pool
+ *
+ * Every piece of fixed UI text lives in flash once, in STRING_POOL below, and
+ * is fetched by ID into a caller's buffer. Literals passed straight to
+ * drawText()/showMessage() would otherwise be copied into SRAM at startup.
+ *
+ * Wheel names stay with their wheels (Wheels[].decoder_name) and are fetched
+ * by wheel index with pool_wheel_name(), the same text serial 'L' sends.
+ *
+ * With ENABLE_STRING_DICT the words the wheel names keep repeating are stored
+ * once in a dictionary and the names carry a single byte >= 0x80 in their
+ * place, expanded again by pool_copy()/pool_wheel_name(). Only text read
+ * through those two may use the D_* tokens.
+ */
+#ifndef __STRING_POOL_H__
+#define __STRING_POOL_H__
+
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#ifndef ENABLE_STRING_DICT
+#define ENABLE_STRING_DICT 1  // Default to enabled, saves ~90 bytes of flash
+#endif
+
+/* Dictionary words, W_* index + 0x80 is the D_* token. Order matters */
+#define W_CRANK_CAM   " Crank+Cam"
+#define W_CRANK       " Crank"
+#define W_CAM         "+Cam"
+#define W_CYL_DIZZY   " Cyl Dizzy"
+#define W_MITSUBISHI  "Mitsubishi "
+#define W_MAZDA       "Mazda "
+#define W_36_2_2_2    "36-2-2-2 "
+#define W_TOYOTA      "Toyota 4AG"
+
+/* Tokens are literals of their own so the hex escape can't swallow the text after it */
+#if ENABLE_STRING_DICT
+#define D_CRANK_CAM   "\x80"
+#define D_CRANK       "\x81"
+#define D_CAM         "\x82"
+#define D_CYL_DIZZY   "\x83"
+#define D_MITSUBISHI  "\x84"
+#define D_MAZDA       "\x85"
+#define D_36_2_2_2    "\x86"
+#define D_TOYOTA      "\x87"
+#else
+#define D_CRANK_CAM   W_CRANK_CAM
+#define D_CRANK       W_CRANK
+#define D_CAM         W_CAM
+#define D_CYL_DIZZY   W_CYL_DIZZY
+#define D_MITSUBISHI  W_MITSUBISHI
+#define D_MAZDA       W_MAZDA
+#define D_36_2_2_2    W_36_2_2_2
+#define D_TOYOTA      W_TOYOTA
+#endif
+
+/* UI text by ID */
+#define STRING_POOL(X) \
+  X(STR_UNKNOWN,        "Unknown") \
+  X(STR_RPM_LABEL,      "RPM: ") \
+  X(STR_MODE_LABEL,     "Mode: ") \
+  X(STR_READY_MAX,      "Ready   Max: ") \
+  X(STR_MODE_FIXED,     "Fixed") \
+  X(STR_MODE_POT,       "Pot Control") \
+  X(STR_MODE_SWEEP,     "Linear Sweep") \
+  X(STR_SAVING,         "SAVING...") \
+  X(STR_SAVED,          "SAVED") \
+  X(STR_TITLE,          "* ARDU-STIM v3.0 *") \
+  X(STR_RULE,           "====================") \
+  X(STR_SUBTITLE,       "  Engine Simulator   ") \
+  X(STR_LOADING,        "   Loading System    ") \
+  X(STR_CHECKS,         "  System Checks     ") \
+  X(STR_CHECK_TIMER,    "Timer Hardware") \
+  X(STR_CHECK_ADC,      "ADC System") \
+  X(STR_CHECK_PATTERN,  "Pattern Memory") \
+  X(STR_CHECK_LCD,      "LCD Display") \
+  X(STR_CHECK_UI,       "User Interface") \
+  X(STR_CHECK_OK,       " [OK]") \
+  X(STR_FEATURES,       "    Features        ") \
+  X(STR_FEATURE_WHEELS, "30+ Wheel Patterns") \
+  X(STR_FEATURE_RPM,    "RPM: 0-9000") \
+  X(STR_FEATURE_MODES,  "3 Control Modes") \
+  X(STR_FEATURE_UI,     "LCD + Serial UI") \
+  X(STR_READY_BORDER,   "********************") \
+  X(STR_READY_LINE1,    "*  SYSTEM READY!   *") \
+  X(STR_READY_LINE2,    "*   Let's Start!   *") \
+  X(STR_GEN_TEETH,      "Teeth: ") \
+  X(STR_GEN_MISSING,    "Missing: ") \
+  X(STR_GEN_DUTY,       "Duty %: ") \
+  X(STR_GEN_CAM_TOOTH,  "Cam tooth: ") \
+  X(STR_GEN_CAM_DEGREES, "Cam width: ") \
+  X(STR_CAM_PHASE,      "Cam phase: ") \
+  X(STR_AUX_TACH,       "Tach/rev: ") \
+  X(STR_AUX_VSS_MODE,   "VSS: ") \
+  X(STR_AUX_VSS_HZ,     "VSS Hz: ") \
+  X(STR_AUX_VSS_TEETH,  "VSS teeth: ") \
+  X(STR_AUX_GEAR,       "Gear ratio: ") \
+  X(STR_VSS_OFF,        "Off") \
+  X(STR_VSS_FIXED,      "Fixed") \
+  X(STR_VSS_RPM,        "Follow RPM")
+
+#define STRING_POOL_ID(id, text) id,
+enum StringId {
+  STRING_POOL(STRING_POOL_ID)
+  STR_COUNT
+};
+#undef STRING_POOL_ID
+
+//! Copies pool string id into buf, expanding dictionary tokens
+/*!
+ * @param id String to fetch
+ * @param buf Destination, always null terminated
+ * @param size Size of buf, the text is cut short to fit
+ * @return Number of characters copied
+ */
+uint8_t pool_copy(uint8_t id, char *buf, uint8_t size);
+
+//! Copies the name of wheel into buf, "Unknown" past the end of Wheels[]
+uint8_t pool_wheel_name(uint8_t wheel, char *buf, uint8_t size);
+
+#endif
@@ -0,0 +1,103 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Timer1 RPM arithmetic
+ *
+ * RPM -> compare value -> prescaler conversion used by reset_new_OCR1A().
+ * Kept header-only and free of AVR register access so the host side tools
+ * (tools/timing_report.cpp) run exactly the same arithmetic as the firmware.
+ */
+#ifndef __TIMER_MATH_H__
+#define __TIMER_MATH_H__
+
+#include <stdint.h>
+#include "enums.h"
+
+/* Timer1 ticks per edge at prescaler 1 for a wheel with an rpm_scaler of 1.0
+ * (120 edges per revolution) turning at 1 RPM: 16MHz * 60s / 120 edges.
+ * Single precision on purpose, double is 32 bits on AVR anyway.
+ */
+#define TIMER1_TICKS_PER_RPM 8000000.0f
+
+/* Lowest RPM the timer arithmetic is asked to produce */
+#define TIMER1_MIN_RPM 10
+
+/* Highest RPM representable in the status/config fields */
+#define TIMER1_MAX_RPM 65535
+
+/* Pattern ISR cost assumed until the ISR has timed itself at prescaler 1 */
+#define ISR_CYCLES_ESTIMATE 200
+
+/* Cycles from the compare match to the ISR's TCNT1 read at entry when
+ * nothing holds it off: interrupt response, vector jump and prologue
+ */
+#define ISR_ENTRY_CYCLES 30
+
+/* Cycles between the ISR's self timing sample and the end of its reti */
+#define ISR_EXIT_CYCLES 40
+
+/* Edge period headroom over the worst measured ISR cost, so the next compare
+ * match is never missed and loop() still gets some CPU
+ */
+#define ISR_HEADROOM_PERCENT 25
+
+//! RPM scaling factor of a wheel: its edges per revolution over the 120 of a 60-2
+/*!
+ * Evaluated at compile time for the Wheels[] table
+ * @param edges Number of edges in the edge array
+ * @param degrees Crank degrees the edge array covers
+ */
+constexpr float wheel_rpm_scaler(uint16_t edges, uint16_t degrees)
+{
+  return ((float)edges * 3.0f) / (float)degrees;
+}
+
+//! Converts an RPM request into Timer1 ticks per edge at prescaler 1
+static inline uint32_t rpm_to_timer_ticks(float rpm_scaler, uint32_t new_rpm)
+{
+  return (uint32_t)(TIMER1_TICKS_PER_RPM/(rpm_scaler * (float)(new_rpm < TIMER1_MIN_RPM ? TIMER1_MIN_RPM:new_rpm)));
+}
+
+//! Highest RPM a wheel can be driven at when one pattern ISR costs isr_cycles
+/*!
+ * Past this the next compare match arrives before the ISR has reloaded OCR1A
+ * and the output silently runs at the wrong frequency.
+ */
+static inline uint16_t max_rpm_for_isr_cycles(float rpm_scaler, uint16_t isr_cycles)
+{
+  uint32_t min_ticks = ((uint32_t)isr_cycles * (100 + ISR_HEADROOM_PERCENT)) / 100;
+  uint32_t max_rpm = (uint32_t)(TIMER1_TICKS_PER_RPM / (rpm_scaler * (float)min_ticks));
+  if (max_rpm > TIMER1_MAX_RPM) { max_rpm = TIMER1_MAX_RPM; }
+  return (uint16_t)max_rpm;
+}
+
+//! Gets prescaler enum and bitshift based on OC value
+static inline void get_prescaler_bits(uint32_t *potential_oc_value, uint8_t *prescaler, uint8_t *bitshift)
+{
+  if (*potential_oc_value >= 16777216)
+  {
+    *prescaler = PRESCALE_1024;
+    *bitshift = 10;
+  }
+  else if (*potential_oc_value >= 4194304)
+  {
+    *prescaler = PRESCALE_256;
+    *bitshift = 8;
+  }
+  else if (*potential_oc_value >= 524288)
+  {
+    *prescaler = PRESCALE_64;
+    *bitshift = 6;
+  }
+  else if (*potential_oc_value >= 65536)
+  {
+    *prescaler = PRESCALE_8;
+    *bitshift = 3;
+  }
+  else
+  {
+    *prescaler = PRESCALE_1;
+    *bitshift = 0;
+  }
+}
+
+#endif
@@ -0,0 +1,257 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Non-blocking I2C LCD Display Implementation
+ *
+ * See twi_lcd_display.h
+ *
+ * Part of Ardu-Stim LCD Interface Enhancement
+ */
+
+#include "twi_lcd_display.h"
+
+#if LCD_DRIVER == LCD_DRIVER_TWI
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <avr/pgmspace.h>
+
+// HD44780 commands
+#define HD_CLEAR            0x01
+#define HD_ENTRY_LEFT       0x06
+#define HD_DISPLAY_ON       0x0C
+#define HD_FUNCTION_4BIT_2L 0x28
+#define HD_SET_DDRAM        0x80
+
+// DDRAM address of the first column of each row on a 20x4
+static const uint8_t rowOffsets[LCD_ROWS] = { 0x00, 0x40, 0x14, 0x54 };
+
+// Init sequence, one step per poll()
+#define STEP_WAIT       0   // Nothing sent, just the settle time
+#define STEP_NIBBLE     1   // Upper nibble only, the controller may be in 8-bit mode
+#define STEP_COMMAND    2
+
+struct InitStep {
+    uint8_t value;
+    uint8_t type;
+    uint16_t settle_us;
+};
+
+static const InitStep initSteps[] PROGMEM = {
+    { 0x00,                 STEP_WAIT,      50000 },    // >40ms from power up, it may just have been plugged in
+    { 0x03,                 STEP_NIBBLE,    4500 },     // Datasheet 4-bit init: three 8-bit function sets
+    { 0x03,                 STEP_NIBBLE,    4500 },
+    { 0x03,                 STEP_NIBBLE,    150 },
+    { 0x02,                 STEP_NIBBLE,    150 },      // then switch to 4-bit
+    { HD_FUNCTION_4BIT_2L,  STEP_COMMAND,   50 },
+    { HD_DISPLAY_ON,        STEP_COMMAND,   50 },
+    { HD_CLEAR,             STEP_COMMAND,   2000 },
+    { HD_ENTRY_LEFT,        STEP_COMMAND,   50 },
+};
+#define INIT_STEPS (sizeof(initSteps) / sizeof(initSteps[0]))
+
+TwiLcdDisplay::TwiLcdDisplay() : state(TWI_LCD_OFFLINE), lastMode(0), initStep(0),
+                                 settling(false), settleUs(0), stepTime(0),
+                                 errorMark(0), backoffMs(LCD_REPROBE_MIN_MS), lastProbe(0) {
+}
+
+void TwiLcdDisplay::put(uint8_t value, uint8_t mode) {
+    uint8_t high = (value & 0xF0) | mode | PCF_BACKLIGHT;
+    uint8_t low = ((value << 4) & 0xF0) | mode | PCF_BACKLIGHT;
+
+    // RS has to settle before EN rises, give it a byte of its own
+    if (mode != lastMode) {
+        twi_put(mode | PCF_BACKLIGHT);
+        lastMode = mode;
+    }
+    twi_put(high | PCF_EN);
+    twi_put(high);
+    twi_put(low | PCF_EN);
+    twi_put(low);
+}
+
+bool TwiLcdDisplay::send(uint8_t value, uint8_t mode) {
+    uint32_t start = millis();
+
+    while (!twi_reserve(PCF_BYTES_PER_CHAR + 1)) {
+        twi_poll();
+        if ((millis() - start) >= LCD_PRINT_WAIT_MS) {
+            return false;
+        }
+    }
+    put(value, mode);
+    twi_commit();
+    return true;
+}
+
+void TwiLcdDisplay::command(uint8_t value, uint16_t settle_us) {
+    send(value, 0);
+    twi_flush(LCD_PRINT_WAIT_MS);
+    delayMicroseconds(settle_us);
+}
+
+void TwiLcdDisplay::startProbe() {
+    // Backlight on, everything else low. A missing backpack NACKs
+    uint8_t probe = PCF_BACKLIGHT;
+
+    errorMark = twi_errors();
+    lastMode = 0;
+    lastProbe = millis();
+    state = TWI_LCD_PROBING;
+    twi_queue(&probe, 1);
+}
+
+void TwiLcdDisplay::goOffline() {
+    state = TWI_LCD_OFFLINE;
+    lastProbe = millis();
+}
+
+void TwiLcdDisplay::start() {
+    twi_begin(LCD_I2C_ADDRESS, LCD_TWI_FREQUENCY);
+    backoffMs = LCD_REPROBE_MIN_MS;
+    startProbe();
+}
+
+bool TwiLcdDisplay::init() {
+    start();
+
+    // A NACK or the TWI watchdog ends this either way
+    while (state == TWI_LCD_PROBING || state == TWI_LCD_INIT) {
+        poll();
+    }
+    return state == TWI_LCD_ONLINE;
+}
+
+void TwiLcdDisplay::poll() {
+    // Also the hung bus watchdog
+    twi_poll();
+
+    switch (state) {
+        case TWI_LCD_ONLINE:
+            if (twi_errors() != errorMark) {
+                backoffMs = LCD_REPROBE_MIN_MS;
+                goOffline();
+            }
+            break;
+
+        case TWI_LCD_OFFLINE:
+            if (millis() - lastProbe >= backoffMs) {
+                startProbe();
+            }
+            break;
+
+        case TWI_LCD_PROBING:
+        case TWI_LCD_INIT:
+            if (twi_busy()) {
+                break;
+            }
+            if (twi_errors() != errorMark) {
+                // Still missing, or lost again half way through the init
+                if (backoffMs < LCD_REPROBE_MAX_MS / 2) backoffMs *= 2;
+                else backoffMs = LCD_REPROBE_MAX_MS;
+                goOffline();
+                break;
+            }
+            if (state == TWI_LCD_PROBING) {
+                state = TWI_LCD_INIT;
+                initStep = 0;
+                settleUs = 0;
+                settling = false;
+            }
+
+            // Settle times run from when the step left the bus
+            if (!settling) {
+                settling = true;
+                stepTime = micros();
+            }
+            if ((uint32_t)(micros() - stepTime) < settleUs) {
+                break;
+            }
+            if (initStep >= INIT_STEPS) {
+                state = TWI_LCD_ONLINE;
+                backoffMs = LCD_REPROBE_MIN_MS;
+                break;
+            }
+
+            {
+                uint8_t value = pgm_read_byte(&initSteps[initStep].value);
+                uint8_t type = pgm_read_byte(&initSteps[initStep].type);
+                settleUs = pgm_read_word(&initSteps[initStep].settle_us);
+                initStep++;
+                settling = false;
+
+                if (type == STEP_NIBBLE) {
+                    uint8_t nibble = (value << 4) | PCF_BACKLIGHT;
+                    uint8_t bytes[2] = { (uint8_t)(nibble | PCF_EN), nibble };
+                    twi_queue(bytes, sizeof(bytes));
+                } else if (type == STEP_COMMAND) {
+                    twi_reserve(PCF_BYTES_PER_CHAR + 1);
+                    put(value, 0);
+                    twi_commit();
+                }
+            }
+            break;
+    }
+}
+
+void TwiLcdDisplay::clear() {
+    if (state != TWI_LCD_ONLINE) {
+        return;
+    }
+    command(HD_CLEAR, 2000);
+}
+
+void TwiLcdDisplay::setCursor(uint8_t col, uint8_t row) {
+    if (state != TWI_LCD_ONLINE) {
+        return;
+    }
+
+    // Bounds checking for 20x4 LCD
+    if (col >= LCD_COLUMNS) col = LCD_COLUMNS - 1;
+    if (row >= LCD_ROWS) row = LCD_ROWS - 1;
+
+    send(HD_SET_DDRAM | (rowOffsets[row] + col), 0);
+}
+
+void TwiLcdDisplay::print(const char* text) {
+    if (state != TWI_LCD_ONLINE || !text) {
+        return;
+    }
+    while (*text) {
+        if (!send(*text++, PCF_RS)) {
+            return;
+        }
+    }
+}
+
+void TwiLcdDisplay::print(int value) {
+    char buf[8];
+    itoa(value, buf, 10);
+    print(buf);
+}
+
+void TwiLcdDisplay::write(uint8_t col, uint8_t row, const char* text, uint8_t len) {
+    if (state != TWI_LCD_ONLINE || !twi_reserve(LCD_RUN_BYTES(len))) {
+        return;
+    }
+
+    if (col >= LCD_COLUMNS) col = LCD_COLUMNS - 1;
+    if (row >= LCD_ROWS) row = LCD_ROWS - 1;
+
+    put(HD_SET_DDRAM | (rowOffsets[row] + col), 0);
+    while (len--) {
+        put(*text++, PCF_RS);
+    }
+    twi_commit();
+}
+
+bool TwiLcdDisplay::canWrite(uint8_t len) {
+    // Catches a hung bus even if nothing else polls it
+    twi_poll();
+    return state == TWI_LCD_ONLINE && twi_free() >= LCD_RUN_BYTES(len);
+}
+
+bool TwiLcdDisplay::isAvailable() {
+    return state == TWI_LCD_ONLINE;
+}
+
+#endif
@@ -0,0 +1,173 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Non-blocking I2C LCD Display Implementation
+ *
+ * DisplayInterface for an HD44780 behind a PCF8574 backpack, driven through
+ * the interrupt driven TWI queue in twi_master.cpp instead of Wire. write()
+ * packs the cursor move and every character of a run into one I2C
+ * transaction and returns as soon as it's queued; TWI_vect puts it on the bus.
+ *
+ * Each HD44780 byte costs 4 bus bytes (nibble with EN high, same nibble with
+ * EN low, twice). The HD44780 latches on EN's falling edge and the data is
+ * already stable when EN rises, so the separate set up byte LiquidCrystal_I2C
+ * sends per nibble is only needed where RS changes.
+ *
+ * Any NACK, bus error or timeout takes the display offline; poll() then
+ * re-probes it on a back-off schedule and runs the HD44780 init sequence one
+ * step per call once it answers again, so hot-plugging never blocks loop().
+ *
+ * Part of Ardu-Stim LCD Interface Enhancement
+ */
+#ifndef __TWI_LCD_DISPLAY_H__
+#define __TWI_LCD_DISPLAY_H__
+
+#include "display_interface.h"
+
+#if LCD_DRIVER == LCD_DRIVER_TWI
+
+#include "twi_master.h"
+
+/**
+ * PCF8574 port to HD44780 wiring of the common backpacks
+ */
+#define PCF_RS          0x01    // P0, register select (1 = data)
+#define PCF_RW          0x02    // P1, always low, write only
+#define PCF_EN          0x04    // P2, latches on the falling edge
+#define PCF_BACKLIGHT   0x08    // P3
+#define PCF_BYTES_PER_CHAR 4    // Per nibble: EN high, EN low
+
+// Bus bytes for a cursor move, len characters and the RS changes before each
+#define LCD_RUN_BYTES(len)  (((uint16_t)(len) + 1) * PCF_BYTES_PER_CHAR + 2)
+
+/**
+ * The PCF8574 is rated for 100kHz but the backpacks run fine at 400kHz with
+ * their on board pull-ups. At 400kHz a nibble takes 45us on the bus, still
+ * longer than the 37us the HD44780 needs between latched bytes.
+ * Build with -DLCD_TWI_FREQUENCY=100000 for marginal wiring
+ */
+#ifndef LCD_TWI_FREQUENCY
+#define LCD_TWI_FREQUENCY   400000
+#endif
+#define LCD_PRINT_WAIT_MS   20      // print() gives up waiting for queue room after this
+
+/**
+ * Display link states
+ */
+enum TwiLcdState {
+    TWI_LCD_OFFLINE,    // Waiting out the back-off before the next probe
+    TWI_LCD_PROBING,    // Probe byte queued, waiting for ACK or NACK
+    TWI_LCD_INIT,       // Running the init sequence, a step per poll()
+    TWI_LCD_ONLINE
+};
+
+/**
+ * Interrupt driven implementation of DisplayInterface for I2C LCD
+ * Nothing but init() and clear() waits on the bus
+ */
+class TwiLcdDisplay : public DisplayInterface {
+private:
+    uint8_t state;
+    uint8_t lastMode;       // RS level the last queued byte left on the PCF8574
+    uint8_t initStep;       // Next step of the init sequence
+    bool settling;          // Bus drained, waiting settleUs before the next step
+    uint16_t settleUs;
+    uint32_t stepTime;      // micros() the current step finished on the bus
+    uint16_t errorMark;     // twi_errors() when the link was last known good
+    uint16_t backoffMs;
+    uint32_t lastProbe;
+
+    /**
+     * Put one byte for the HD44780 into the reserved TWI batch
+     * Needs PCF_BYTES_PER_CHAR bytes reserved, one more if mode changes
+     * @param value Byte for the HD44780
+     * @param mode PCF_RS for data, 0 for a command
+     */
+    void put(uint8_t value, uint8_t mode);
+
+    /**
+     * Queue a single command or data byte, waiting up to LCD_PRINT_WAIT_MS for room
+     * @return false if it couldn't be queued
+     */
+    bool send(uint8_t value, uint8_t mode);
+
+    /**
+     * Send a command and wait for the bus to drain, for clear()
+     */
+    void command(uint8_t value, uint16_t settle_us);
+
+    /**
+     * Queue the probe byte and start waiting for its ACK
+     */
+    void startProbe();
+
+    /**
+     * Go offline, the next probe is due after the current back-off
+     */
+    void goOffline();
+
+public:
+    TwiLcdDisplay();
+
+    /**
+     * Probe the backpack and run the HD44780 4-bit init sequence, blocking
+     * @return true if the backpack ACKed, poll() keeps trying if not
+     */
+    bool init() override;
+
+    /**
+     * Queue the probe and return, poll() runs the init sequence
+     */
+    void start() override;
+
+    /**
+     * Clear display, blocks for the 2ms the controller needs
+     */
+    void clear() override;
+
+    /**
+     * Queue a cursor move
+     * @param col Column (0-19 for 20x4 LCD)
+     * @param row Row (0-3 for 20x4 LCD)
+     */
+    void setCursor(uint8_t col, uint8_t row) override;
+
+    /**
+     * Queue text, waiting briefly for room if the queue is full
+     * @param text String to display
+     */
+    void print(const char* text) override;
+
+    /**
+     * Queue an integer
+     * @param value Integer to display
+     */
+    void print(int value) override;
+
+    /**
+     * Queue a cursor move and a run of characters as one transaction
+     * without blocking. Callers check canWrite() first, runs that don't
+     * fit are dropped
+     */
+    void write(uint8_t col, uint8_t row, const char* text, uint8_t len) override;
+
+    /**
+     * Check the TWI queue has room for a cursor move and len characters
+     */
+    bool canWrite(uint8_t len) override;
+
+    /**
+     * Link state machine: error detection, back-off, probing and the
+     * step-wise re-init
+     */
+    void poll() override;
+
+    /**
+     * Check if LCD is online and initialised
+     * @return true if LCD is working
+     */
+    bool isAvailable() override;
+};
+
+#endif
+
+#endif
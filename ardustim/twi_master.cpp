@@ -0,0 +1,282 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Interrupt driven TWI (I2C) master, transmit only
+ *
+ * See twi_master.h
+ */
+
+#include "twi_master.h"
+#include "display_interface.h"
+
+#if LCD_DRIVER == LCD_DRIVER_TWI
+
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+#define TWI_QUEUE_MASK (TWI_QUEUE_SIZE - 1)
+
+volatile struct twi_stats twiStats;
+
+static uint8_t twiQueue[TWI_QUEUE_SIZE];
+static volatile uint8_t twiHead = 0;      /* Next free slot, written by twi_commit() */
+static volatile uint8_t twiTail = 0;      /* Next byte to send, written by the ISR */
+static volatile bool twiActive = false;   /* START sent, STOP not yet */
+static volatile uint8_t twiProgress = 0;  /* Bumped by every ISR, watched by twi_poll() */
+static uint8_t twiStage = 0;              /* Where twi_put() writes, published by twi_commit() */
+static uint8_t twiAddress = 0;
+static uint8_t lastProgress = 0;
+static uint32_t lastProgressTime = 0;
+static bool stopWaiting = false;          /* twi_kick() found the last STOP still pending */
+static uint32_t stopWaitTime = 0;         /* When it first did */
+
+//! Sets up the TWI peripheral as a master for one slave address
+void twi_begin(uint8_t address, uint32_t frequency)
+{
+  twiAddress = address;
+  twiHead = 0;
+  twiTail = 0;
+  twiActive = false;
+  stopWaiting = false;
+
+  /* Internal pull-ups on SDA/SCL, as Wire does */
+  PORTC |= (1 << PORTC4) | (1 << PORTC5);
+
+  TWSR = 0; /* Prescaler 1 */
+  TWBR = ((F_CPU / frequency) - 16) / 2;
+  TWCR = (1 << TWEN);
+}
+
+//! Stops the transfer in progress and drops everything queued, ISR context
+static inline void twi_abort(bool sendStop)
+{
+  twiTail = twiHead;
+  twiActive = false;
+  TWCR = sendStop ? ((1 << TWINT) | (1 << TWEN) | (1 << TWSTO)) : ((1 << TWINT) | (1 << TWEN));
+}
+
+ISR(TWI_vect)
+{
+  uint8_t status = TW_STATUS; /* Read once, it changes as soon as TWINT is cleared */
+
+  twiProgress++;
+  switch (status)
+  {
+    case TW_START:
+    case TW_REP_START:
+      TWDR = twiAddress << 1; /* SLA+W */
+      TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+      break;
+
+    case TW_MT_SLA_ACK:
+    case TW_MT_DATA_ACK:
+      if (twiTail != twiHead)
+      {
+        TWDR = twiQueue[twiTail];
+        twiTail = (twiTail + 1) & TWI_QUEUE_MASK;
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+        if (status == TW_MT_DATA_ACK) { twiStats.bytes++; }
+      }
+      else
+      {
+        /* Ring ran dry, release the bus. No interrupt follows a STOP */
+        if (status == TW_MT_DATA_ACK) { twiStats.bytes++; }
+        twiActive = false;
+        TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+      }
+      break;
+
+    case TW_MT_SLA_NACK:
+    case TW_MT_DATA_NACK:
+      twiStats.nacks++;
+      twi_abort(true);
+      break;
+
+    case TW_MT_ARB_LOST:
+      twiStats.bus_errors++;
+      twi_abort(false);
+      break;
+
+    case TW_BUS_ERROR:
+    default:
+      twiStats.bus_errors++;
+      twi_abort(true);
+      break;
+  }
+}
+
+//! Starts a transfer if the bus is idle and there's something to send
+/*!
+ * Never waits for the previous STOP: it is a few microseconds on the wire
+ * normally, but a slave holding SDA/SCL low keeps TWSTO set for good. The
+ * START is left to the next twi_poll() then, which resets the peripheral
+ * if the STOP is still pending after TWI_TIMEOUT_MS
+ */
+static void twi_kick()
+{
+  noInterrupts();
+  if (!twiActive && (twiTail != twiHead))
+  {
+    if (TWCR & (1 << TWSTO))
+    {
+      if (!stopWaiting)
+      {
+        stopWaiting = true;
+        stopWaitTime = millis();
+      }
+      interrupts();
+      return;
+    }
+    stopWaiting = false;
+    twiActive = true;
+    lastProgress = twiProgress;
+    lastProgressTime = millis();
+    TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE) | (1 << TWSTA);
+  }
+  interrupts();
+}
+
+//! Returns the free space in the queue in bytes
+uint8_t twi_free()
+{
+  return (TWI_QUEUE_SIZE - 1) - ((twiHead - twiTail) & TWI_QUEUE_MASK);
+}
+
+//! Starts a batch of len bytes, to be filled with twi_put() and sent with twi_commit()
+/*!
+ * \return false if there isn't room for all of them, nothing may be put then
+ */
+bool twi_reserve(uint8_t len)
+{
+  if (twi_free() < len) { return false; }
+  twiStage = twiHead;
+  return true;
+}
+
+//! Appends a byte to the reserved batch, the ISR can't see it yet
+void twi_put(uint8_t data)
+{
+  twiQueue[twiStage] = data;
+  twiStage = (twiStage + 1) & TWI_QUEUE_MASK;
+}
+
+//! Hands the batch to the ISR in one go and starts a transfer if the bus is idle
+void twi_commit()
+{
+  twiHead = twiStage;
+  twi_kick();
+}
+
+//! Queues bytes for the slave, all or nothing
+/*!
+ * \return false if there isn't room for all of them, nothing is queued then
+ */
+bool twi_queue(const uint8_t *data, uint8_t len)
+{
+  if (!twi_reserve(len)) { return false; }
+
+  while (len--) { twi_put(*data++); }
+  twi_commit();
+  return true;
+}
+
+//! Returns true while bytes are queued or on the wire
+bool twi_busy()
+{
+  return twiActive || (twiTail != twiHead);
+}
+
+//! Resets the peripheral and drops everything queued, counted as a timeout
+static void twi_reset()
+{
+  noInterrupts();
+  TWCR = 0; /* Disabling TWEN releases SDA/SCL and resets the state machine */
+  twiTail = twiHead;
+  twiActive = false;
+  stopWaiting = false;
+  twiStats.timeouts++;
+  TWCR = (1 << TWEN);
+  interrupts();
+}
+
+//! Bus watchdog, call regularly from the main loop
+/*!
+ * Abandons a transfer whose ISR hasn't fired for TWI_TIMEOUT_MS, or a STOP
+ * that hasn't completed for as long, and resets the peripheral so the next
+ * queued byte starts from a clean bus
+ */
+void twi_poll()
+{
+  if (!twiActive)
+  {
+    if (stopWaiting && ((millis() - stopWaitTime) >= TWI_TIMEOUT_MS) && (TWCR & (1 << TWSTO)))
+    {
+      twi_reset();
+      return;
+    }
+    twi_kick(); /* Anything queued while a NACK or a STOP was being handled */
+    return;
+  }
+
+  uint8_t progress = twiProgress;
+  uint32_t now = millis();
+  if (progress != lastProgress)
+  {
+    lastProgress = progress;
+    lastProgressTime = now;
+  }
+  else if ((now - lastProgressTime) >= TWI_TIMEOUT_MS)
+  {
+    twi_reset();
+  }
+}
+
+//! Waits for the queue to drain, for setup code only
+/*!
+ * \return false if it didn't drain within timeout_ms or a byte was NACKed
+ */
+bool twi_flush(uint16_t timeout_ms)
+{
+  uint16_t nacks = twiStats.nacks;
+  uint32_t start = millis();
+
+  while (twi_busy())
+  {
+    twi_poll();
+    if ((millis() - start) >= timeout_ms) { return false; }
+  }
+  return (twiStats.nacks == nacks);
+}
+
+//! Returns the sum of the failure counters, a change means the slave went missing
+uint16_t twi_errors()
+{
+  uint16_t errors;
+
+  noInterrupts();
+  errors = twiStats.nacks + twiStats.bus_errors + twiStats.timeouts;
+  interrupts();
+  return errors;
+}
+
+//! Sends the bus counters over serial: bytes,nacks,bus_errors,timeouts
+void twi_dump()
+{
+  struct twi_stats snap;
+
+  noInterrupts();
+  snap.bytes = twiStats.bytes;
+  snap.nacks = twiStats.nacks;
+  snap.bus_errors = twiStats.bus_errors;
+  snap.timeouts = twiStats.timeouts;
+  interrupts();
+
+  Serial.print(snap.bytes);
+  Serial.print(",");
+  Serial.print(snap.nacks);
+  Serial.print(",");
+  Serial.print(snap.bus_errors);
+  Serial.print(",");
+  Serial.println(snap.timeouts);
+}
+
+#endif
@@ -0,0 +1,46 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Interrupt driven TWI (I2C) master, transmit only
+ *
+ * A byte ring buffer for a single slave. twi_queue() appends bytes and kicks
+ * off a transfer if the bus is idle, TWI_vect then drains the ring one byte
+ * per interrupt and sends STOP when it runs dry. Nothing ever busy-waits on
+ * the bus, unlike Wire. Bytes queued together go out back to back in one
+ * transaction; twi_reserve()/twi_put()/twi_commit() build such a batch in
+ * place without a staging buffer.
+ *
+ * A NACK, bus error or lost arbitration drops whatever is queued and is
+ * counted. twi_poll() resets the peripheral if a transfer makes no progress,
+ * or the STOP before the next one doesn't complete, for TWI_TIMEOUT_MS (a
+ * slave holding SCL low would hang Wire forever).
+ */
+#ifndef __TWI_MASTER_H__
+#define __TWI_MASTER_H__
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define TWI_QUEUE_SIZE  128   /* Must be a power of 2, holds a full LCD row */
+#define TWI_TIMEOUT_MS  25    /* No ISR activity for this long while busy = hung bus */
+
+struct twi_stats {
+  uint32_t bytes;       /* Bytes ACKed by the slave */
+  uint16_t nacks;       /* Address or data NACKed, slave missing */
+  uint16_t bus_errors;  /* Illegal START/STOP or lost arbitration */
+  uint16_t timeouts;    /* Transfers or STOPs abandoned by twi_poll() */
+};
+extern volatile struct twi_stats twiStats;
+
+void twi_begin(uint8_t address, uint32_t frequency);
+bool twi_queue(const uint8_t *data, uint8_t len);
+bool twi_reserve(uint8_t len);
+void twi_put(uint8_t data);
+void twi_commit();
+uint8_t twi_free();
+bool twi_busy();
+void twi_poll();
+bool twi_flush(uint16_t timeout_ms);
+uint16_t twi_errors();
+void twi_dump();
+
+#endif
@@ -11,21 +11,54 @@
 #include "ui_controller.h"
 #include "wheel_defs.h"
 #include "storage.h"
+#include "comms.h"
+#include "wheel_gen.h"
+#include "cam_phase.h"
+#include "aux_out.h"
+#include <stdio.h>
 #include <avr/pgmspace.h>
 
 // External references to global variables and functions
 extern struct configTable config;
 extern struct status currentStatus;
-extern wheels Wheels[];
 extern void saveConfig();
 
 // Removed text constants to save flash memory - using direct strings
 
+// The editor walks gen_params as bytes with a label per field
+static_assert(sizeof(struct gen_params) == GEN_EDIT_FIELDS &&
+              STR_GEN_CAM_DEGREES - STR_GEN_TEETH == GEN_EDIT_FIELDS - 1,
+              "GEN_EDIT_FIELDS, gen_params and the STR_GEN_ labels must match");
+static_assert(STR_AUX_GEAR - STR_AUX_TACH == AUX_EDIT_FIELDS - 1 &&
+              STR_VSS_RPM - STR_VSS_OFF == MAX_VSS_MODES - 1,
+              "AUX_EDIT_FIELDS, the STR_AUX_ labels and the STR_VSS_ mode names must match");
+
+// aux_params fields, in struct order
+enum AuxField {
+    AUX_FIELD_TACH,
+    AUX_FIELD_VSS_MODE,
+    AUX_FIELD_VSS_HZ,
+    AUX_FIELD_VSS_TEETH,
+    AUX_FIELD_GEAR
+};
+
+/**
+ * Add delta to value if the result stays within 0..max
+ * @return false, value unchanged, if it doesn't
+ */
+static bool stepField(uint16_t& value, int32_t delta, uint16_t max) {
+    int32_t next = (int32_t)value + delta;
+    if (next < 0 || next > max) return false;
+    value = (uint16_t)next;
+    return true;
+}
+
 UIController::UIController() {
     buttons = nullptr;
     lcdManager = nullptr;
     currentState = UI_STATE_NORMAL;
     stateTimeout = 0;
+    editField = 0;
     initialized = false;
     
     // Initialize cached state
@@ -67,18 +100,14 @@ void UIController::update() {
     // Update state machine
     updateStateMachine();
     
-    // Process button actions based on current state
-    switch (currentState) {
-        case UI_STATE_NORMAL:
-            handleWheelSelection();
-            handleModeChange();
-            handleSave();
-            handleRPMAdjustment(); // Simplified - no separate state
-            break;
-            
-        case UI_STATE_SAVING:
-            // Saving state is handled by timeout in updateStateMachine()
-            break;
+    // Every queued event is taken, the ones that arrive while saving are dropped
+    ButtonEvent event;
+    while (buttons->nextEvent(event)) {
+        if (currentState == UI_STATE_NORMAL) {
+            handleEvent(event);
+        } else if (currentState == UI_STATE_GEN_EDIT || currentState == UI_STATE_AUX_EDIT) {
+            handleEditor(event);
+        }
     }
     
     // Update cached state if system state changed
@@ -98,144 +127,339 @@ void UIController::updateStateMachine() {
             }
             break;
             
+        case UI_STATE_GEN_EDIT:
+        case UI_STATE_AUX_EDIT:
+            if (currentTime >= stateTimeout) {
+                returnToNormal();
+            }
+            break;
+            
         default:
             // No timeout handling needed for other states
             break;
     }
 }
 
-void UIController::handleWheelSelection() {
-    if (currentState != UI_STATE_NORMAL) {
-        return;
-    }
-    
-    // Only change wheels in POT mode (other modes use buttons for RPM)
-    if (config.mode != POT_RPM) {
-        return;
+void UIController::handleEvent(const ButtonEvent& event) {
+    switch (event.type) {
+        case BUTTON_EVENT_PRESS:
+            switch (event.mask) {
+                case BUTTON_BIT(BUTTON_NEXT):
+                case BUTTON_BIT(BUTTON_PREV):
+                    // Wheels in POT mode, RPM in the others
+                    if (config.mode == POT_RPM) {
+                        handleWheelSelection(event.mask == BUTTON_BIT(BUTTON_NEXT));
+                    } else {
+                        handleRPMAdjustment(event.mask == BUTTON_BIT(BUTTON_NEXT), 0);
+                    }
+                    break;
+                case BUTTON_BIT(BUTTON_HELP):
+                    handleModeChange();
+                    break;
+                case BUTTON_BIT(BUTTON_SAVE):
+                    handleSave();
+                    break;
+                case BUTTON_BIT(BUTTON_ABT):
+                    handleDiagnostics();
+                    break;
+            }
+            break;
+            
+        case BUTTON_EVENT_REPEAT:
+            // Held NEXT/PREV only repeat on RPM, stepping through wheels stays one per press
+            if (config.mode != POT_RPM &&
+                (event.mask == BUTTON_BIT(BUTTON_NEXT) || event.mask == BUTTON_BIT(BUTTON_PREV))) {
+                handleRPMAdjustment(event.mask == BUTTON_BIT(BUTTON_NEXT), event.count);
+            }
+            break;
+            
+        case BUTTON_EVENT_CHORD:
+            handleChord(event.mask);
+            break;
     }
-    
-    bool wheelChanged = false;
-    
-    // Handle NEXT button for next wheel pattern
-    if (buttons->isPressed(BUTTON_NEXT)) {
+}
+
+void UIController::handleWheelSelection(bool forward) {
+    if (forward) {
         config.wheel = (config.wheel + 1 >= MAX_WHEELS) ? 0 : config.wheel + 1;
-        wheelChanged = true;
-        buttons->resetButton(BUTTON_NEXT);
-    }
-    
-    // Handle PREV button for previous wheel pattern
-    if (buttons->isPressed(BUTTON_PREV)) {
+    } else {
         config.wheel = (config.wheel == 0) ? MAX_WHEELS - 1 : config.wheel - 1;
-        wheelChanged = true;
-        buttons->resetButton(BUTTON_PREV);
     }
     
-    if (wheelChanged) {
-        // Force immediate display update
-        lcdManager->forceRefresh();
+    // Restart the pattern and re-derive the RPM limit for the new wheel
+    display_new_wheel();
+    // Force immediate display update
+    lcdManager->forceRefresh();
+}
+
+uint16_t UIController::getTargetRPM() {
+    switch (config.mode) {
+        case FIXED_RPM:
+            return config.fixed_rpm;
+        case LINEAR_SWEPT_RPM:
+            // In sweep mode, adjust the base RPM (could be sweep center point)
+            return currentStatus.base_rpm;
+        default:
+            return currentStatus.rpm;
     }
 }
 
-void UIController::handleRPMAdjustment() {
-    if (currentState != UI_STATE_NORMAL) {
-        return;
+void UIController::setTargetRPM(int32_t rpm) {
+    if (rpm > RPM_MAX) rpm = RPM_MAX;
+    if (rpm > currentStatus.max_rpm) rpm = currentStatus.max_rpm;
+    if (rpm < RPM_MIN) rpm = RPM_MIN;
+    
+    // Update the appropriate RPM value based on mode
+    switch (config.mode) {
+        case FIXED_RPM:
+            config.fixed_rpm = (uint16_t)rpm;
+            break;
+        case LINEAR_SWEPT_RPM:
+            currentStatus.base_rpm = (uint16_t)rpm;
+            break;
+        default:
+            currentStatus.rpm = (uint16_t)rpm;
+            break;
     }
     
+    // Force immediate display update
+    lcdManager->forceRefresh();
+}
+
+void UIController::handleRPMAdjustment(bool increase, uint8_t repeat) {
     // Skip RPM adjustment in POT mode (buttons are for wheel selection)
     if (config.mode == POT_RPM) {
         return;
     }
     
-    bool rpmChanged = false;
-    uint16_t targetRPM = 0;
+    // The press is one RPM_INCREMENT, a held button speeds up the longer it's held
+    uint8_t shift = (repeat > 0) ? (repeat - 1) / RPM_ACCEL_REPEATS : 0;
+    if (shift > RPM_ACCEL_MAX_SHIFT) shift = RPM_ACCEL_MAX_SHIFT;
+    int32_t step = (int32_t)RPM_INCREMENT << shift;
     
-    // Determine target RPM based on current mode
-    switch (config.mode) {
-        case FIXED_RPM:
-            targetRPM = config.fixed_rpm;
+    setTargetRPM((int32_t)getTargetRPM() + (increase ? step : -step));
+}
+
+void UIController::handleChord(uint8_t mask) {
+    switch (mask) {
+        case BUTTON_BIT(BUTTON_NEXT) | BUTTON_BIT(BUTTON_PREV):
+            // Next pattern in any mode, not just POT
+            handleWheelSelection(true);
             break;
-        case LINEAR_SWEPT_RPM:
-            // In sweep mode, adjust the base RPM (could be sweep center point)
-            targetRPM = currentStatus.base_rpm;
+        case BUTTON_BIT(BUTTON_HELP) | BUTTON_BIT(BUTTON_NEXT):
+            if (config.mode != POT_RPM) setTargetRPM(RPM_MAX);
             break;
-        default:
-            targetRPM = currentStatus.rpm;
+        case BUTTON_BIT(BUTTON_HELP) | BUTTON_BIT(BUTTON_PREV):
+            if (config.mode != POT_RPM) setTargetRPM(RPM_IDLE);
+            break;
+        case BUTTON_BIT(BUTTON_ABT) | BUTTON_BIT(BUTTON_NEXT):
+        case BUTTON_BIT(BUTTON_ABT) | BUTTON_BIT(BUTTON_PREV):
+            // Cam phase a step advanced / retarded, at the current slew rate
+            cam_phase_step((mask & BUTTON_BIT(BUTTON_NEXT)) ? CAM_PHASE_STEP : -CAM_PHASE_STEP);
+            showCamPhase();
+            break;
+        case BUTTON_BIT(BUTTON_SAVE) | BUTTON_BIT(BUTTON_ABT):
+            // Generated wheel editor, switching to that wheel first
+            if (config.wheel != GENERATED_WHEEL) {
+                config.wheel = GENERATED_WHEEL;
+                display_new_wheel();
+            }
+            currentState = UI_STATE_GEN_EDIT;
+            editField = 0;
+            showGenField();
+            break;
+        case BUTTON_BIT(BUTTON_HELP) | BUTTON_BIT(BUTTON_ABT):
+            // Tach and VSS editor
+            currentState = UI_STATE_AUX_EDIT;
+            editField = 0;
+            showAuxField();
             break;
     }
+}
+
+void UIController::handleEditor(const ButtonEvent& event) {
+    uint8_t fields = (currentState == UI_STATE_GEN_EDIT) ? GEN_EDIT_FIELDS : AUX_EDIT_FIELDS;
     
-    // Handle RPM increase (supports both single press and hold-to-repeat)
-    if (buttons->shouldIncreaseRPM()) {
-        int32_t newRPM = (int32_t)targetRPM + RPM_INCREMENT;
-        if (newRPM > RPM_MAX) newRPM = RPM_MAX;
-        targetRPM = (uint16_t)newRPM;
-        rpmChanged = true;
+    switch (event.type) {
+        case BUTTON_EVENT_PRESS:
+            switch (event.mask) {
+                case BUTTON_BIT(BUTTON_NEXT):
+                case BUTTON_BIT(BUTTON_PREV):
+                    adjustEditField(event.mask == BUTTON_BIT(BUTTON_NEXT), 0);
+                    break;
+                case BUTTON_BIT(BUTTON_ABT):
+                    editField = (editField + 1 >= fields) ? 0 : editField + 1;
+                    showEditField();
+                    break;
+                case BUTTON_BIT(BUTTON_SAVE):
+                    // Leaves the editor, SAVE again writes the EEPROM
+                    returnToNormal();
+                    break;
+            }
+            break;
+            
+        case BUTTON_EVENT_REPEAT:
+            if (event.mask == BUTTON_BIT(BUTTON_NEXT) || event.mask == BUTTON_BIT(BUTTON_PREV)) {
+                adjustEditField(event.mask == BUTTON_BIT(BUTTON_NEXT), event.count);
+            }
+            break;
+    }
+}
+
+void UIController::adjustEditField(bool increase, uint8_t repeat) {
+    if (currentState == UI_STATE_GEN_EDIT) {
+        adjustGenField(increase, repeat);
+    } else {
+        adjustAuxField(increase, repeat);
+    }
+}
+
+void UIController::showEditField() {
+    if (currentState == UI_STATE_GEN_EDIT) {
+        showGenField();
+    } else {
+        showAuxField();
     }
+}
+
+void UIController::adjustGenField(bool increase, uint8_t repeat) {
+    uint8_t shift = (repeat > 0) ? (repeat - 1) / RPM_ACCEL_REPEATS : 0;
+    if (shift > GEN_EDIT_MAX_SHIFT) shift = GEN_EDIT_MAX_SHIFT;
     
-    // Handle RPM decrease (supports both single press and hold-to-repeat)
-    if (buttons->shouldDecreaseRPM()) {
-        int32_t newRPM = (int32_t)targetRPM - RPM_INCREMENT;
-        if (newRPM < RPM_MIN) newRPM = RPM_MIN;
-        targetRPM = (uint16_t)newRPM;
-        rpmChanged = true;
+    // gen_params is all bytes, editField indexes it. A step that would make
+    // the wheel invalid is halved until it doesn't, down to no change
+    struct gen_params params;
+    for (uint8_t step = 1 << shift; step > 0; step >>= 1) {
+        params = genParams;
+        uint8_t* value = (uint8_t*)&params + editField;
+        int16_t next = (int16_t)*value + (increase ? step : -step);
+        if (next < 0 || next > 255) continue;
+        *value = (uint8_t)next;
+        
+        // Turning the cam on starts it one tooth wide
+        if (params.cam_tooth && params.cam_degrees == 0) {
+            params.cam_degrees = 360 / params.teeth;
+        }
+        if (gen_params_valid(&params)) {
+            genParams = params;
+            gen_forget_learned();
+            display_new_wheel();
+            break;
+        }
     }
+    showGenField();
+}
+
+void UIController::showCamPhase() {
+    char buffer[21];
+    int16_t target = cam_phase_target();
+    uint16_t tenths = (target < 0) ? -target : target;
+    uint8_t len = pool_copy(STR_CAM_PHASE, buffer, sizeof(buffer));
+    
+    snprintf_P(buffer + len, sizeof(buffer) - len, PSTR("%c%u.%u"), (target < 0) ? '-' : '+', tenths / 10, tenths % 10);
+    lcdManager->showMessage(buffer, MESSAGE_TIMEOUT_SHORT);
+}
+
+void UIController::showGenField() {
+    char buffer[21];
+    uint8_t len = pool_copy(STR_GEN_TEETH + editField, buffer, sizeof(buffer));
+    
+    snprintf_P(buffer + len, sizeof(buffer) - len, PSTR("%u"), ((uint8_t*)&genParams)[editField]);
+    lcdManager->showMessage(buffer, GEN_EDIT_TIMEOUT);
+    stateTimeout = millis() + GEN_EDIT_TIMEOUT;
+}
+
+void UIController::adjustAuxField(bool increase, uint8_t repeat) {
+    uint8_t shift = (repeat > 0) ? (repeat - 1) / RPM_ACCEL_REPEATS : 0;
+    if (shift > AUX_EDIT_MAX_SHIFT) shift = AUX_EDIT_MAX_SHIFT;
     
-    if (rpmChanged) {
-        // Update the appropriate RPM value based on mode
-        switch (config.mode) {
-            case FIXED_RPM:
-                config.fixed_rpm = targetRPM;
+    // As in the generator, a step aux_set() refuses is halved down to no change
+    for (uint16_t step = 1 << shift; step > 0; step >>= 1) {
+        struct aux_params params = auxParams;
+        int32_t delta = increase ? (int32_t)step : -(int32_t)step;
+        uint16_t value;
+        bool ok;
+        
+        switch (editField) {
+            case AUX_FIELD_TACH:
+                value = params.tach_ppr;
+                ok = stepField(value, delta, 255);
+                params.tach_ppr = value;
+                break;
+            case AUX_FIELD_VSS_MODE:
+                // One mode per press, wrapping
+                params.vss_mode = (params.vss_mode + (increase ? 1 : MAX_VSS_MODES - 1)) % MAX_VSS_MODES;
+                ok = (step == 1);
                 break;
-            case LINEAR_SWEPT_RPM:
-                currentStatus.base_rpm = targetRPM;
+            case AUX_FIELD_VSS_HZ:
+                ok = stepField(params.vss_hz, delta, AUX_VSS_HZ_MAX);
+                break;
+            case AUX_FIELD_VSS_TEETH:
+                value = params.vss_teeth;
+                ok = stepField(value, delta, 255);
+                params.vss_teeth = value;
                 break;
             default:
-                currentStatus.rpm = targetRPM;
+                ok = stepField(params.gear_ratio, delta, 0xFFFF);
                 break;
         }
-        
-        // Force immediate display update
-        lcdManager->forceRefresh();
+        if (ok && aux_set(&params)) break;
     }
+    showAuxField();
 }
 
-void UIController::handleModeChange() {
-    if (currentState != UI_STATE_NORMAL) {
-        return;
-    }
+void UIController::showAuxField() {
+    char buffer[21];
+    uint8_t len = pool_copy(STR_AUX_TACH + editField, buffer, sizeof(buffer));
     
-    if (buttons->isPressed(BUTTON_HELP)) {
-        config.mode = (config.mode + 1 >= MAX_MODES) ? 0 : config.mode + 1;
-        buttons->resetButton(BUTTON_HELP);
-        
-        // Force immediate display update
-        lcdManager->forceRefresh();
+    switch (editField) {
+        case AUX_FIELD_VSS_MODE:
+            pool_copy(STR_VSS_OFF + auxParams.vss_mode, buffer + len, sizeof(buffer) - len);
+            break;
+        case AUX_FIELD_GEAR:
+            snprintf_P(buffer + len, sizeof(buffer) - len, PSTR("%u.%02u"), auxParams.gear_ratio / 100, auxParams.gear_ratio % 100);
+            break;
+        default:
+            snprintf_P(buffer + len, sizeof(buffer) - len, PSTR("%u"),
+                       (editField == AUX_FIELD_TACH) ? auxParams.tach_ppr :
+                       (editField == AUX_FIELD_VSS_HZ) ? auxParams.vss_hz : auxParams.vss_teeth);
+            break;
     }
+    lcdManager->showMessage(buffer, GEN_EDIT_TIMEOUT);
+    stateTimeout = millis() + GEN_EDIT_TIMEOUT;
+}
+
+void UIController::handleModeChange() {
+    config.mode = (config.mode + 1 >= MAX_MODES) ? 0 : config.mode + 1;
+    
+    // Force immediate display update
+    lcdManager->forceRefresh();
+}
+
+void UIController::handleDiagnostics() {
+#if ENABLE_LOOP_PROFILER
+    lcdManager->toggleDiagnostics();
+#else
+    lcdManager->showBootTimes();
+#endif
 }
 
 void UIController::handleSave() {
-    if (currentState != UI_STATE_NORMAL) {
-        return;
-    }
+    // Enter saving state
+    currentState = UI_STATE_SAVING;
+    stateTimeout = millis() + 2000; // 2 second timeout
     
-    if (buttons->isPressed(BUTTON_SAVE)) {
-        // Enter saving state
-        currentState = UI_STATE_SAVING;
-        stateTimeout = millis() + 2000; // 2 second timeout
-        
-        // Show saving message - now can use longer message with 20x4 display
-        lcdManager->showMessage("SAVING...", MESSAGE_TIMEOUT_SHORT);
-        
-        // Perform the save operation
-        // Note: saveConfig() doesn't return error status in current implementation
-        // but we could enhance it in the future
-        saveConfig();
-        
-        // For now, always show success since saveConfig() doesn't report errors
-        // In a future enhancement, we could check EEPROM status
-        lcdManager->showMessage("SAVED", MESSAGE_TIMEOUT_SHORT);
-        
-        buttons->resetButton(BUTTON_SAVE);
-    }
+    // Show saving message - now can use longer message with 20x4 display
+    lcdManager->showMessage(STR_SAVING, MESSAGE_TIMEOUT_SHORT);
+    
+    // Perform the save operation
+    // Note: saveConfig() doesn't return error status in current implementation
+    // but we could enhance it in the future
+    saveConfig();
+    
+    // For now, always show success since saveConfig() doesn't report errors
+    // In a future enhancement, we could check EEPROM status
+    lcdManager->showMessage(STR_SAVED, MESSAGE_TIMEOUT_SHORT);
 }
 
 
@@ -22,15 +22,43 @@
  */
 enum UIState {
     UI_STATE_NORMAL = 0,        // Normal operation mode
-    UI_STATE_SAVING = 1         // Configuration save in progress
+    UI_STATE_SAVING = 1,        // Configuration save in progress
+    UI_STATE_GEN_EDIT = 2,      // Editing the generated wheel's parameters
+    UI_STATE_AUX_EDIT = 3       // Editing the tach and VSS outputs
 };
 
+/**
+ * Generated wheel editor, SAVE+ABT chord
+ * ABT steps through the gen_params fields, NEXT/PREV change the one shown
+ * (held, they speed up to 1 << GEN_EDIT_MAX_SHIFT per repeat), SAVE or
+ * GEN_EDIT_TIMEOUT without a button leaves
+ */
+#define GEN_EDIT_FIELDS         5
+#define GEN_EDIT_MAX_SHIFT      3
+#define GEN_EDIT_TIMEOUT        10000   // ms
+
+/**
+ * Tach and VSS editor, HELP+ABT chord, same buttons and timeout as the
+ * generator's. Fields in aux_params order, the 16 bit ones speed up further
+ */
+#define AUX_EDIT_FIELDS         5
+#define AUX_EDIT_MAX_SHIFT      6
+
 /**
  * RPM Adjustment Configuration
  */
 #define RPM_INCREMENT           100     // RPM increment/decrement step
 #define RPM_MIN                 10      // Minimum RPM value
 #define RPM_MAX                 9000    // Maximum RPM value
+#define RPM_IDLE                800     // HELP+PREV chord drops straight to this
+
+/**
+ * Held NEXT/PREV repeats every BUTTON_REPEAT_RATE and the step doubles every
+ * RPM_ACCEL_REPEATS repeats, up to RPM_INCREMENT << RPM_ACCEL_MAX_SHIFT.
+ * 800 to 7000 RPM takes about 0.9s of holding
+ */
+#define RPM_ACCEL_REPEATS       3
+#define RPM_ACCEL_MAX_SHIFT     5
 
 /**
  * User Interface Controller Class
@@ -42,6 +70,7 @@ private:
     LCDManager* lcdManager;
     UIState currentState;
     uint32_t stateTimeout;
+    uint8_t editField;          // gen_params or aux_params field being edited, in struct order
     bool initialized;
     
     // State tracking for change detection
@@ -50,16 +79,88 @@ private:
     uint8_t lastMode;
     
     /**
-     * Handle wheel pattern selection (NEXT/PREV buttons)
+     * Act on one button event
+     * @param event Event from ButtonManager::nextEvent()
+     */
+    void handleEvent(const ButtonEvent& event);
+    
+    /**
+     * Handle wheel pattern selection (NEXT/PREV buttons, NEXT+PREV chord)
      * Implements wraparound logic for first/last patterns
+     * @param forward true for the next pattern
      */
-    void handleWheelSelection();
+    void handleWheelSelection(bool forward);
     
     /**
-     * Handle RPM adjustment when buttons are held
+     * Handle RPM adjustment from NEXT/PREV presses and repeats
      * Manages RPM increment/decrement with bounds checking
+     * @param increase true for NEXT
+     * @param repeat Repeat number, 0 for the press itself
+     */
+    void handleRPMAdjustment(bool increase, uint8_t repeat);
+    
+    /**
+     * Handle chords, the fast actions
+     * @param mask BUTTON_BIT()s of the chord
+     */
+    void handleChord(uint8_t mask);
+    
+    /**
+     * Act on one button event in the generator or tach/VSS editor
+     * @param event Event from ButtonManager::nextEvent()
+     */
+    void handleEditor(const ButtonEvent& event);
+    
+    /**
+     * Step the edited field of the editor that's open
+     * @param increase true for NEXT
+     * @param repeat Repeat number, 0 for the press itself
+     */
+    void adjustEditField(bool increase, uint8_t repeat);
+    
+    /**
+     * Show the edited field of the editor that's open
      */
-    void handleRPMAdjustment();
+    void showEditField();
+    
+    /**
+     * Step the edited generator field, only to values gen_params_valid() takes
+     * @param increase true for NEXT
+     * @param repeat Repeat number, 0 for the press itself
+     */
+    void adjustGenField(bool increase, uint8_t repeat);
+    
+    /**
+     * Show the edited generator field and its value
+     */
+    void showGenField();
+    
+    /**
+     * Step the edited tach/VSS field, only to settings aux_set() takes
+     * @param increase true for NEXT
+     * @param repeat Repeat number, 0 for the press itself
+     */
+    void adjustAuxField(bool increase, uint8_t repeat);
+    
+    /**
+     * Show the edited tach/VSS field and its value
+     */
+    void showAuxField();
+    
+    /**
+     * Show the cam phase target after an ABT+NEXT/PREV chord
+     */
+    void showCamPhase();
+    
+    /**
+     * RPM the buttons adjust in the current mode
+     */
+    uint16_t getTargetRPM();
+    
+    /**
+     * Set the RPM the buttons adjust, clamped to RPM_MIN and the wheel's limit
+     */
+    void setTargetRPM(int32_t rpm);
     
     /**
      * Handle RPM mode cycling (HELP button)
@@ -73,6 +174,12 @@ private:
      */
     void handleSave();
     
+    /**
+     * Handle diagnostics page toggle (ABT button)
+     * Only built with the loop profiler
+     */
+    void handleDiagnostics();
+    
 
     
     /**
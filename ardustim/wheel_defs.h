@@ -22,6 +22,7 @@
  #define __WHEEL_DEFS_H__
  
  #include <avr/pgmspace.h>
+ #include "string_pool.h"
  
  /* Wheel patterns! 
   *
@@ -64,150 +65,125 @@
    */
 
   
-  /* Wheel types we know about...
-   * This enumerations is the INDEX into the Wheels[] array of structures
-   * defined in main file. That struct contains pointers to the following:
-   * wheel name in a user friendly string
-   * pointer to the wheel edge array used by the ISR
-   * RPM scaling factor (num_edges/120 for crank wheels)
-   * Number of edges in the edge array above, needed by the ISR 
+  /* Wheel registry, one line per wheel type in Wheels[] order. The order is
+   * the wheel number serial 'S'/'L' and the EEPROM use, so new wheels go on
+   * the end (GENERATED_WHEEL always follows the list). Everything else is generated from this list:
+   * the WheelType enum (the INDEX into the Wheels[] array) and in
+   * wheel_table.h the name strings and the Wheels[] table itself, whose edge
+   * count is the size of the edge array and whose RPM scaling factor is
+   * derived from that and the degrees of rotation the array covers:
+   *
+   * X(enum, edge array, friendly name for a 20x4 LCD (string_pool.h D_* tokens allowed), crank degrees)
    */
- typedef enum { 
-   DIZZY_FOUR_CYLINDER,  /* 2 evenly spaced teeth */
-   DIZZY_SIX_CYLINDER,   /* 3 evenly spaced teeth */
-   DIZZY_EIGHT_CYLINDER, /* 4 evenly spaced teeth */
-   SIXTY_MINUS_TWO,      /* 60-2 crank only */
-   SIXTY_MINUS_TWO_WITH_CAM, /* 60-2 with 2nd trigger on cam */
-   SIXTY_MINUS_TWO_WITH_HALFMOON_CAM, /* 60-2 with "half moon" trigger on cam */
-   THIRTY_SIX_MINUS_ONE, /* 36-1 crank only */
-   TWENTY_FOUR_MINUS_ONE,
-   FOUR_MINUS_ONE_WITH_CAM, /* 4-1 crank + cam */
-   EIGHT_MINUS_ONE,       /* 8-1 crank only */
-   SIX_MINUS_ONE_WITH_CAM,/* 6-1 crank + cam */
-   TWELVE_MINUS_ONE_WITH_CAM, /* 12-1 crank + cam */
-   FOURTY_MINUS_ONE,      /* Ford V-10 40-1 crank only */
-   DIZZY_FOUR_TRIGGER_RETURN,  /* dizzy 4 cylinder signal, 40deg on 50 deg off */
-   ODDFIRE_VR,            /* Oddfire V-twin */
-   OPTISPARK_LT1,         /* Optispark 360 and 8 */
-   TWELVE_MINUS_THREE,    /* 12-3 */
-   THIRTY_SIX_MINUS_TWO_TWO_TWO, /* 36-2-2-2 crank only H4 */
-   THIRTY_SIX_MINUS_TWO_TWO_TWO_H6, /* 36-2-2-2 crank only H6 */
-   THIRTY_SIX_MINUS_TWO_TWO_TWO_WITH_CAM, /* 36-2-2-2 crank and cam */
-   FOURTY_TWO_HUNDRED_WHEEL, /* 4200 wheel */
-   THIRTY_SIX_MINUS_ONE_WITH_CAM_FE3, /* Mazda F3 36-1 crank and cam */
-   SIX_G_SEVENTY_TWO_WITH_CAM, /* Mitsubishi DOHC CAS and TCDS 6G72 */
-   BUELL_ODDFIRE_CAM,     /* Buell 45 deg cam wheel */
-   GM_LS1_CRANK_AND_CAM,  /* GM LS1 24 tooth with cam */
-   GM_58x_LS_CRANK_4X_CAM, /* GM 58x LS crank 4x cam wheel */
-   LOTUS_THIRTY_SIX_MINUS_ONE_ONE_ONE_ONE, /* Lotus crank wheel 36-1-1-1-1 */
-   HONDA_RC51_WITH_CAM,   /* Honda oddfire 90 deg V-twin */
-   THIRTY_SIX_MINUS_ONE_WITH_SECOND_TRIGGER, /* From jimstim */
-   WEBER_IAW_WITH_CAM, /* From jimstim IAW weber-marelli */
-   FIAT_ONE_POINT_EIGHT_SIXTEEN_VALVE_WITH_CAM, /* Fiat 1.8 16V from jimstim */
-   THREE_SIXTY_NISSAN_CAS, /*from jimstim 360 tooth cas with 6 slots */
-   TWENTY_FOUR_MINUS_TWO_WITH_SECOND_TRIGGER, /* Mazda CAS 24-1 inner ring single pulse outer ring */
-   YAMAHA_EIGHT_TOOTH_WITH_CAM, /* 02-03 Yamaha R1, seank */
-   MITSUBISH_4g63_4_2,
-   AUDI_135_WITH_CAM,
-   HONDA_D17_NO_CAM,
-   MAZDA_323_AU,
-   DAIHATSU_3CYL,
-   MIATA_9905,
-   TWELVE_WITH_CAM, //12 evenly spaced crank teeth and a single cam tooth
-   TWENTY_FOUR_WITH_CAM, //24 evenly spaced crank teeth and a single cam tooth
-   SUBARU_SIX_SEVEN,      /* Subaru 6 crank, 7 cam */
-   GM_7X,                 /* GM 7X pattern. 6 even teeth with 1 extra uneven tooth */
-   FOUR_TWENTY_A,         /* DSM 420a */
-   FORD_ST170,            /* Ford ST170 */
-   MITSUBISHI_3A92,        /* Mitsubishi 3cylinder 3A92 */
-   TOYOTA_4AGE_CAS,           /*Toyota 4AGE CAS, 4 teeth and one cam tooth*/
-   TOYOTA_4AGZE,           /*Toyota 4AGZE, 24 teeth and one cam tooth*/
-   SUZUKI_DRZ400,         /* Suzuki DRZ-400 6 coil "tooths", 2 uneven crank tooths */
-   JEEP2000_4CYL,  /* Jeep 2.5 4cyl aka jeep2000_4cyl */
-   JEEP2000_6CYL,  /* Jeep 4.0 6cyl aka jeep2000_6cyl */
-   VIPER_96_02, // Dodge Viper 1996-2002 wheel pattern
-   THIRTY_SIX_MINUS_TWO_WITH_ONE_CAM, // 36-2 with  1 tooth cam - 2jz-gte VVTI crank pulley + non-vvti cam
-   GM_40_OSS, // GM 40 tooth wheel no skips for transmission OSS simulation
+#define WHEEL_LIST(X) \
+  X(DIZZY_FOUR_CYLINDER,                         dizzy_four_cylinder,                         "4" D_CYL_DIZZY,           360) /* 2 evenly spaced teeth */ \
+  X(DIZZY_SIX_CYLINDER,                          dizzy_six_cylinder,                          "6" D_CYL_DIZZY,           360) /* 3 evenly spaced teeth */ \
+  X(DIZZY_EIGHT_CYLINDER,                        dizzy_eight_cylinder,                        "8" D_CYL_DIZZY,           360) /* 4 evenly spaced teeth */ \
+  X(SIXTY_MINUS_TWO,                             sixty_minus_two,                             "60-2" D_CRANK,            360) /* 60-2 crank only */ \
+  X(SIXTY_MINUS_TWO_WITH_CAM,                    sixty_minus_two_with_cam,                    "60-2" D_CRANK_CAM,        720) /* 60-2 with 2nd trigger on cam */ \
+  X(SIXTY_MINUS_TWO_WITH_HALFMOON_CAM,           sixty_minus_two_with_halfmoon_cam,           "60-2 Half Moon Cam",      720) /* 60-2 with "half moon" trigger on cam */ \
+  X(THIRTY_SIX_MINUS_ONE,                        thirty_six_minus_one,                        "36-1" D_CRANK,            360) /* 36-1 crank only */ \
+  X(TWENTY_FOUR_MINUS_ONE,                       twenty_four_minus_one,                       "24-1" D_CRANK,            360) /* 24-1 crank only */ \
+  X(FOUR_MINUS_ONE_WITH_CAM,                     four_minus_one_with_cam,                     "4-1" D_CRANK_CAM,         720) /* 4-1 crank + cam */ \
+  X(EIGHT_MINUS_ONE,                             eight_minus_one,                             "8-1" D_CRANK " (R6)",     360) /* 8-1 crank only */ \
+  X(SIX_MINUS_ONE_WITH_CAM,                      six_minus_one_with_cam,                      "6-1" D_CRANK_CAM,         720) /* 6-1 crank + cam */ \
+  X(TWELVE_MINUS_ONE_WITH_CAM,                   twelve_minus_one_with_cam,                   "12-1" D_CRANK_CAM,        720) /* 12-1 crank + cam */ \
+  X(FOURTY_MINUS_ONE,                            fourty_minus_one,                            "40-1 Ford V10",           360) /* Ford V-10 40-1 crank only */ \
+  X(DIZZY_FOUR_TRIGGER_RETURN,                   dizzy_four_trigger_return,                   "4" D_CYL_DIZZY " Return", 180) /* dizzy 4 cylinder signal, 40deg on 50 deg off */ \
+  X(ODDFIRE_VR,                                  oddfire_vr,                                  "Oddfire VR 90deg",        360) /* Oddfire V-twin */ \
+  X(OPTISPARK_LT1,                               optispark_lt1,                               "GM OptiSpark LT1",        720) /* Optispark 360 and 8 */ \
+  X(TWELVE_MINUS_THREE,                          twelve_minus_three,                          "12-3 Oddball",            360) /* 12-3 */ \
+  X(THIRTY_SIX_MINUS_TWO_TWO_TWO,                thirty_six_minus_two_two_two,                D_36_2_2_2 "H4",           360) /* 36-2-2-2 crank only H4 */ \
+  X(THIRTY_SIX_MINUS_TWO_TWO_TWO_H6,             thirty_six_minus_two_two_two_h6,             D_36_2_2_2 "H6",           360) /* 36-2-2-2 crank only H6 */ \
+  X(THIRTY_SIX_MINUS_TWO_TWO_TWO_WITH_CAM,       thirty_six_minus_two_two_two_with_cam,       D_36_2_2_2 D_CAM,          720) /* 36-2-2-2 crank and cam */ \
+  X(FOURTY_TWO_HUNDRED_WHEEL,                    fourty_two_hundred_wheel,                    "GM 4200 Wheel",           360) /* 4200 wheel */ \
+  X(THIRTY_SIX_MINUS_ONE_WITH_CAM_FE3,           thirty_six_minus_one_with_cam_fe3,           D_MAZDA "FE3 36-1" D_CAM,  720) /* Mazda F3 36-1 crank and cam */ \
+  X(SIX_G_SEVENTY_TWO_WITH_CAM,                  six_g_seventy_two_with_cam,                  D_MITSUBISHI "6G72",       720) /* Mitsubishi DOHC CAS and TCDS 6G72 */ \
+  X(BUELL_ODDFIRE_CAM,                           buell_oddfire_cam,                           "Buell Oddfire Cam",       720) /* Buell 45 deg cam wheel */ \
+  X(GM_LS1_CRANK_AND_CAM,                        gm_ls1_crank_and_cam,                        "GM LS1" D_CRANK_CAM,      720) /* GM LS1 24 tooth with cam */ \
+  X(GM_58x_LS_CRANK_4X_CAM,                      GM_LS_58X_crank_and_4x_cam,                  "GM 58x+4x Cam",           720) /* GM 58x LS crank 4x cam wheel */ \
+  X(LOTUS_THIRTY_SIX_MINUS_ONE_ONE_ONE_ONE,      lotus_thirty_six_minus_one_one_one_one,      "Lotus 36-1-1-1-1",        360) /* Lotus crank wheel 36-1-1-1-1 */ \
+  X(HONDA_RC51_WITH_CAM,                         honda_rc51_with_cam,                         "Honda RC51" D_CAM,        720) /* Honda oddfire 90 deg V-twin */ \
+  X(THIRTY_SIX_MINUS_ONE_WITH_SECOND_TRIGGER,    thirty_six_minus_one_with_second_trigger,    "36-1 2nd Trigger",        720) /* From jimstim */ \
+  X(WEBER_IAW_WITH_CAM,                          weber_iaw_with_cam,                          "Weber IAW 8+2",           720) /* From jimstim IAW weber-marelli */ \
+  X(FIAT_ONE_POINT_EIGHT_SIXTEEN_VALVE_WITH_CAM, fiat_one_point_eight_sixteen_valve_with_cam, "Fiat 1.8 16V",            720) /* Fiat 1.8 16V from jimstim */ \
+  X(THREE_SIXTY_NISSAN_CAS,                      three_sixty_nissan_cas,                      "Nissan 360 CAS",          720) /* from jimstim 360 tooth cas with 6 slots */ \
+  X(TWENTY_FOUR_MINUS_TWO_WITH_SECOND_TRIGGER,   twenty_four_minus_two_with_second_trigger,   D_MAZDA "CAS 24-2",        720) /* Mazda CAS 24-1 inner ring single pulse outer ring */ \
+  X(YAMAHA_EIGHT_TOOTH_WITH_CAM,                 yamaha_eight_tooth_with_cam,                 "Yamaha R1 8T" D_CAM,      720) /* 02-03 Yamaha R1, seank */ \
+  X(MITSUBISH_4g63_4_2,                          mitsubishi_4g63_4_2,                         D_MITSUBISHI "4G63",       720) /* Mitsubishi 4g63 aka 4/2 crank and cam */ \
+  X(AUDI_135_WITH_CAM,                           audi_135_with_cam,                           "Audi 135T" D_CAM,         720) /* Audi 135 tooth crank and cam */ \
+  X(HONDA_D17_NO_CAM,                            honda_d17_no_cam,                            "Honda D17 12+1",          720) /* Honda D17 12+1 crank */ \
+  X(DAIHATSU_3CYL,                               daihatsu_3cyl,                               "Daihatsu 3+1",            720) /* Daihatsu 3 cylinder, 3 teeth plus 1 */ \
+  X(MIATA_9905,                                  miata_9905,                                  "Miata 99-05",             720) /* Mazda Miata 1999-2005 */ \
+  X(TWELVE_WITH_CAM,                             twelve_with_cam,                             "12/1" D_CRANK_CAM,        720) /* 12 evenly spaced crank teeth and a single cam tooth */ \
+  X(TWENTY_FOUR_WITH_CAM,                        twenty_four_with_cam,                        "24/1" D_CRANK_CAM,        720) /* 24 evenly spaced crank teeth and a single cam tooth */ \
+  X(SUBARU_SIX_SEVEN,                            subaru_six_seven,                            "Subaru 6/7",              720) /* Subaru 6 crank, 7 cam */ \
+  X(GM_7X,                                       gm_seven_x,                                  "GM 7X",                   360) /* GM 7X pattern. 6 even teeth with 1 extra uneven tooth */ \
+  X(FOUR_TWENTY_A,                               four_twenty_a,                               "DSM 420a",                720) /* DSM 420a */ \
+  X(FORD_ST170,                                  ford_st170,                                  "Ford ST170",              720) /* Ford ST170 */ \
+  X(MITSUBISHI_3A92,                             mitsubishi_3A92,                             D_MITSUBISHI "3A92",       720) /* Mitsubishi 3 cylinder 3A92 */ \
+  X(TOYOTA_4AGE_CAS,                             toyota_4AGE_CAS,                             D_TOYOTA "E",              720) /* Toyota 4AGE CAS, 4 teeth and one cam tooth */ \
+  X(TOYOTA_4AGZE,                                toyota_4AGZE,                                D_TOYOTA "ZE",             720) /* Toyota 4AGZE, 24 teeth and one cam tooth */ \
+  X(SUZUKI_DRZ400,                               suzuki_DRZ400,                               "Suzuki DRZ400",           360) /* Suzuki DRZ-400 6 coil "tooths", 2 uneven crank tooths */ \
+  X(JEEP2000_4CYL,                               jeep_2000_4cyl,                              "Jeep 2000 4Cyl",          720) /* Jeep 2.5 4cyl aka jeep2000_4cyl */ \
+  X(VIPER_96_02,                                 viper9602wheel,                              "Viper V10 96-02",         720) /* Dodge Viper 1996-2002 wheel pattern */ \
+  X(THIRTY_SIX_MINUS_TWO_WITH_ONE_CAM,           thirty_six_minus_two_with_second_trigger,    "36-2+1T Cam",             720) /* 36-2 with 1 tooth cam - 2jz-gte VVTI crank pulley + non-vvti cam */ \
+  X(GM_40_OSS,                                   GM40toothOSS,                                "GM 40T Trans OSS",        360) /* GM 40 tooth wheel no skips for transmission OSS simulation */ \
+  X(MAZDA_323_AU,                                mazda_323_au,                                D_MAZDA "323 AU",          360) /* Mazda 323 AU CAS, 4 crank teeth 72/108 deg apart */ \
+  X(CHRYSLER_NGC_THIRTY_SIX_PLUS_TWO_MINUS_TWO_WITH_NGC4_CAM, chrysler_ngc_thirty_six_plus_two_minus_two_with_ngc4_cam, "Chrysler NGC4 36+2-2", 720) /* Chrysler NGC 36+2-2 crank with NGC 4 cylinder cam pattern */ \
+  X(CHRYSLER_NGC_THIRTY_SIX_MINUS_TWO_PLUS_TWO_WITH_NGC6_CAM, chrysler_ngc_thirty_six_minus_two_plus_two_with_ngc6_cam, "Chrysler NGC6 36-2+2", 720) /* Chrysler NGC 36-2+2 crank with NGC 6 cylinder cam pattern */ \
+  X(CHRYSLER_NGC_THIRTY_SIX_MINUS_TWO_PLUS_TWO_WITH_NGC8_CAM, chrysler_ngc_thirty_six_minus_two_plus_two_with_ngc8_cam, "Chrysler NGC8 36-2+2", 720) /* Chrysler NGC 36-2+2 crank with NGC 8 cylinder cam pattern */ \
+  X(GM_FOUR_TOOTH_WITH_CAM,                      gm_four_tooth_with_cam,                      "GM 4T" D_CRANK_CAM,       720) /* GM 4 even crank with 1 tooth cam */ \
+  X(GM_SIX_TOOTH_WITH_CAM,                       gm_six_tooth_with_cam,                       "GM 6T" D_CRANK_CAM,       720) /* GM 6 even crank with 1 tooth cam */ \
+  X(GM_EIGHT_TOOTH_WITH_CAM,                     gm_eight_tooth_with_cam,                     "GM 8T" D_CRANK_CAM,       720) /* GM 8 even crank with 1 tooth cam */ \
+  X(VOLVO_D12ACD_WITH_CAM,                       volvo_d12acd_with_cam,                       "Volvo D12ACD" D_CAM,      720) /* Volvo Diesel d12[acd] with 7 tooth cam */ \
+  X(MAZDA_THIRTY_SIX_MINUS_TWO_TWO_TWO_WITH_SIX_TOOTH_CAM, mazda_thirty_six_minus_two_two_two_with_six_tooth_cam, D_MAZDA D_36_2_2_2 "6Cam", 720) /* Mazda 36-2-2-2 with 6 tooth cam */ \
+  X(JEEP2000_6CYL,                               jeep_2000_6cyl,                              "Jeep 2000 6Cyl",          720) /* Jeep 4.0 6cyl aka jeep2000_6cyl */ \
+  X(BMW_N20,                                     bmw_n20,                                     "BMW N20",                 720) /* BMW N20 58x crank and custom cam wheels */
 
+#define WHEEL_ENUM(id, pattern, name, degrees) id,
+ typedef enum { 
+   WHEEL_LIST(WHEEL_ENUM)
+   GENERATED_WHEEL, /* N-M built in RAM from genParams, see wheel_gen.h */
    MAX_WHEELS,
  }WheelType;
+#undef WHEEL_ENUM
 
-/* Name strings for EACH wheel type, optimized for 20x4 LCD display */
- const char dizzy_four_cylinder_friendly_name[] PROGMEM = "4 Cyl Dizzy";
- const char dizzy_six_cylinder_friendly_name[] PROGMEM = "6 Cyl Dizzy";
- const char dizzy_eight_cylinder_friendly_name[] PROGMEM = "8 Cyl Dizzy";
- const char sixty_minus_two_friendly_name[] PROGMEM = "60-2 Crank";
- const char sixty_minus_two_with_cam_friendly_name[] PROGMEM = "60-2 Crank+Cam";
- const char sixty_minus_two_with_halfmoon_cam_friendly_name[] PROGMEM = "60-2 Half Moon Cam";
- const char thirty_six_minus_one_friendly_name[] PROGMEM = "36-1 Crank";
- const char twenty_four_minus_one_friendly_name[] PROGMEM = "24-1 Crank";
- const char four_minus_one_with_cam_friendly_name[] PROGMEM = "4-1 Crank+Cam";
- const char eight_minus_one_friendly_name[] PROGMEM = "8-1 Crank (R6)";
- const char six_minus_one_with_cam_friendly_name[] PROGMEM = "6-1 Crank+Cam";
- const char twelve_minus_one_with_cam_friendly_name[] PROGMEM = "12-1 Crank+Cam";
- const char fourty_minus_one_friendly_name[] PROGMEM = "40-1 Ford V10";
- const char dizzy_four_trigger_return_friendly_name[] PROGMEM = "4 Cyl Dizzy Return";
- const char oddfire_vr_friendly_name[] PROGMEM = "Oddfire VR 90deg";
- const char optispark_lt1_friendly_name[] PROGMEM = "GM OptiSpark LT1";
- const char twelve_minus_three_friendly_name[] PROGMEM = "12-3 Oddball";
- const char thirty_six_minus_two_two_two_friendly_name[] PROGMEM = "36-2-2-2 H4";
- const char thirty_six_minus_two_two_two_h6_friendly_name[] PROGMEM = "36-2-2-2 H6";
- const char thirty_six_minus_two_two_two_with_cam_friendly_name[] PROGMEM = "36-2-2-2 +Cam";
- const char fourty_two_hundred_wheel_friendly_name[] PROGMEM = "GM 4200 Wheel";
- const char thirty_six_minus_one_with_cam_fe3_friendly_name[] PROGMEM = "Mazda FE3 36-1+Cam";
- const char six_g_seventy_two_with_cam_friendly_name[] PROGMEM = "Mitsubishi 6G72";
- const char buell_oddfire_cam_friendly_name[] PROGMEM = "Buell Oddfire Cam";
- const char gm_ls1_crank_and_cam_friendly_name[] PROGMEM = "GM LS1 Crank+Cam";
- const char gm_ls_58X_crank_and_4x_cam_friendly_name[] PROGMEM = "GM 58x+4x Cam";
- const char lotus_thirty_six_minus_one_one_one_one_friendly_name[] PROGMEM = "Lotus 36-1-1-1-1";
- const char honda_rc51_with_cam_friendly_name[] PROGMEM = "Honda RC51+Cam";
- const char thirty_six_minus_one_with_second_trigger_friendly_name[] PROGMEM = "36-1 2nd Trigger";
- const char weber_iaw_with_cam_friendly_name[] PROGMEM = "Weber IAW 8+2";
- const char fiat_one_point_eight_sixteen_valve_with_cam_friendly_name[] PROGMEM = "Fiat 1.8 16V";
- const char three_sixty_nissan_cas_friendly_name[] PROGMEM = "Nissan 360 CAS";
- const char twenty_four_minus_two_with_second_trigger_friendly_name[] PROGMEM = "Mazda CAS 24-2";
- const char yamaha_eight_tooth_with_cam_friendly_name[] PROGMEM = "Yamaha R1 8T+Cam";
- const char mitsubishi_4g63_4_2_friendly_name[] PROGMEM = "Mitsubishi 4G63";
- const char audi_135_with_cam_friendly_name[] PROGMEM = "Audi 135T+Cam";
- const char honda_d17_no_cam_friendly_name[] PROGMEM = "Honda D17 12+1";
- const char mazda_323_au_friendly_name[] PROGMEM = "Mazda 323 AU";
- const char daihatsu_3cyl_friendly_name[] PROGMEM = "Daihatsu 3+1";
- const char miata_9905_friendly_name[] PROGMEM = "Miata 99-05";
- const char twelve_with_cam_friendly_name[] PROGMEM = "12/1 Crank+Cam";
- const char twenty_four_with_cam_friendly_name[] PROGMEM = "24/1 Crank+Cam";
- const char subaru_six_seven_name_friendly_name[] PROGMEM = "Subaru 6/7";
- const char gm_seven_x_friendly_name[] PROGMEM = "GM 7X";
- const char four_twenty_a_friendly_name[] PROGMEM = "DSM 420a";
- const char ford_st170_friendly_name[] PROGMEM = "Ford ST170";
- const char mitsubishi_3A92_friendly_name[] PROGMEM = "Mitsubishi 3A92";
- const char Toyota_4AGE_CAS_friendly_name[] PROGMEM = "Toyota 4AGE";
- const char Toyota_4AGZE_friendly_name[] PROGMEM = "Toyota 4AGZE";
- const char Suzuki_DRZ400_friendly_name[] PROGMEM = "Suzuki DRZ400";
- const char Jeep_2000_4cyl_friendly_name[] PROGMEM = "Jeep 2000 4Cyl";
- const char VIPER9602_friendly_name[] PROGMEM = "Viper V10 96-02";
- const char thirty_six_minus_two_with_second_trigger_friendly_name[] PROGMEM = "36-2+1T Cam";
- const char GM_40_Tooth_Trans_OSS_friendly_name[] PROGMEM = "GM 40T Trans OSS";
+/* Longest friendly name, one line of the 20x4 LCD */
+#define WHEEL_NAME_MAX 20
+
+/* One wheel's edge array, WHEEL_EDGES(edge array, { edges... }), read as
+ * <edge array>_edges::edges. Only wheel_table.h reads it, at compile time to
+ * pack it. The member is declared but never defined, so anything that would
+ * need the raw table in memory at run time fails to link instead of quietly
+ * copying it into RAM.
+ */
+#if __cplusplus >= 201703L
+#error "C++17 makes static constexpr members definitions, the raw edge arrays would be emitted"
+#endif
+#define WHEEL_EDGES(pattern, ...) \
+  struct pattern##_edges { static constexpr unsigned char edges[] = __VA_ARGS__; };
 
  /* Very simple 50% duty cycle */
- const unsigned char dizzy_four_cylinder[] PROGMEM = 
+ WHEEL_EDGES(dizzy_four_cylinder,
    { /* dizzy 4 cylinder */
      1,0,1,0 /* two pulses per crank revolution (one per cylinder) */
-   };
+   });
    
  /* Very simple 50% duty cycle */
- const unsigned char dizzy_six_cylinder[] PROGMEM = 
+ WHEEL_EDGES(dizzy_six_cylinder,
    { /* dizzy 6 cylinder */
      1,0,1,0,1,0 /* three pulses per crank revolution (one per cylinder) */
-   };
+   });
    
  /* Very simple 50% duty cycle */
- const unsigned char dizzy_eight_cylinder[] PROGMEM = 
+ WHEEL_EDGES(dizzy_eight_cylinder,
    { /* dizzy 8 cyl */
      1,0,1,0,1,0,1,0 /* four pulses per crank revolution (one per cylinder) */
-   };
+   });
    
  /* Standard bosch 60-2 pattern, 50% duty cyctle during normal teeth */
- const unsigned char sixty_minus_two[] PROGMEM = 
+ WHEEL_EDGES(sixty_minus_two,
    { /* 60-2 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 1-5 */ 
      1,0,1,0,1,0,1,0,1,0,  /* teeth 6-10 */
@@ -221,11 +197,11 @@
      1,0,1,0,1,0,1,0,1,0,  /* teeth 46-50 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 51-55 */
      1,0,1,0,1,0,0,0,0,0   /* teeth 56-58 and 59-60 MISSING */
-   };
+   });
  
  /* Bosch 60-2 pattern with 2nd trigger on rotation 2, 
   * 50% duty cyctle during normal teeth */
- const unsigned char sixty_minus_two_with_cam[] PROGMEM = 
+ WHEEL_EDGES(sixty_minus_two_with_cam,
    { /* 60-2 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 1-5 */ 
      1,0,1,0,1,0,1,0,1,0,  /* teeth 6-10 */
@@ -251,11 +227,11 @@
      1,0,1,0,1,0,1,0,1,0,  /* teeth 46-50 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 51-55 */
      1,0,1,0,1,0,0,0,0,0   /* teeth 56-58 and 59-60 MISSING */
-   };
+   });
  
  /* 60-2 pattern with half moon cam trigger (cam input is high for one rotation and low for second rotation),
   * 50% duty cyctle during normal teeth */
- const unsigned char sixty_minus_two_with_halfmoon_cam[] PROGMEM = 
+ WHEEL_EDGES(sixty_minus_two_with_halfmoon_cam,
    { /* 60-2 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 1-5 */ 
      1,0,1,0,1,0,1,0,1,0,  /* teeth 6-10 */
@@ -281,10 +257,10 @@
      1,0,1,0,1,0,1,0,1,0,  /* teeth 46-50 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 51-55 */
      1,0,1,0,1,0,0,0,0,0   /* teeth 56-58 and 59-60 MISSING */
-   };
+   });
  
  /* Standard ford/mazda and aftermarket 36-1 pattern, 50% duty cyctle during normal teeth */  
- const unsigned char thirty_six_minus_one[] PROGMEM = 
+ WHEEL_EDGES(thirty_six_minus_one,
    { /* 36-1 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 1-5 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 6-10 */
@@ -294,10 +270,10 @@
      1,0,1,0,1,0,1,0,1,0,  /* teeth 26-30 */
      1,0,1,0,1,0,1,0,1,0,  /* teeth 31-35 */
      0,0                   /* MISSING 36th tooth  */
-   }; 
+   }); 
    
   /* Standard ford/mazda and aftermarket 36-1 pattern, 50% duty cyctle during normal teeth */  
- const unsigned char twenty_four_minus_one[] PROGMEM = 
+ WHEEL_EDGES(twenty_four_minus_one,
    { /* 36-1 */
      1,0,1,0,1,0,  /* teeth 1-3 */
      1,0,1,0,1,0,  /* teeth 4-6 */
@@ -307,34 +283,34 @@
      1,0,1,0,1,0,  /* teeth 16-18 */
      1,0,1,0,1,0,  /* teeth 19-21 */
      1,0,1,0,0,0,  /* teeth 22-21 */
-   }; 
+   }); 
    
  /* 4-1 crank signal 50% duty cycle with Cam tooth enabled during the second rotation prior to tooth 2 */
- const unsigned char four_minus_one_with_cam[] PROGMEM = 
+ WHEEL_EDGES(four_minus_one_with_cam,
    { /* 4-1 with cam */
      0,1,0,1,0,1,0,0,  /* Teeth 1-3, then MISSING */
      0,1,2,1,0,1,0,0   /* Tooth 5, 2nd trigger on cam between 5 and 6 
 						  then 6 and 7 and MISSING 8th */
-   };
+   });
    
  /* Yamaha R6 crank trigger 8 teeth missing one, (22.5deg low, 22.5deg high) 50% duty cycle during normal teeth */
- const unsigned char eight_minus_one[] PROGMEM = 
+ WHEEL_EDGES(eight_minus_one,
    { /* 8-1 */
      0,1,0,1,0,1,0,1,  /* Teeth 1-4 */
      0,1,0,1,0,1,0,0   /* Teeth 5-7, then MISSING */
-   };
+   });
   
   /* 40deg low, 20 deg high per tooth, cam signal on second rotation during 40deg low portion of 3rd tooth */
- const unsigned char six_minus_one_with_cam[] PROGMEM = 
+ WHEEL_EDGES(six_minus_one_with_cam,
    { /* 6-1 with cam */
      0,0,1,0,0,1,0,0,1,  /* Teeth 1-3 */
      0,0,1,0,0,1,0,0,0,  /* Teeth 4 and 5 and MISSING 6th */
      0,0,1,0,0,1,2,2,1,  /* 2nd rev teeth 7 and 8, then 2nd trigger on cam between 8 and 9 */
      0,0,1,0,0,1,0,0,0   /* teeth 10 and 11 then missing 12th */
-   };
+   });
   
   /* 25 deg low, 5 deg high, #12 is missing,  cam is high for 25 deg on second crank rotation just after tooth 21 (9) */
- const unsigned char twelve_minus_one_with_cam[] PROGMEM = 
+ WHEEL_EDGES(twelve_minus_one_with_cam,
    { /* 12-1 with cam */
      0,0,0,0,0,1,0,0,0,0,0,1, /* Teeth 1 and 2 */
      0,0,0,0,0,1,0,0,0,0,0,1, /* Teeth 3 and 4 */
@@ -350,10 +326,10 @@
 	   0,0,0,0,0,1,2,2,2,2,2,1, /* Tooth 21 and 22,  2nd trigger on cam between teeth 21 and 22 for 25 deg */
 	   0,0,0,0,0,1,0,0,0,0,0,0  /* Totth 23 and MISSING 24th */
      //0,0,0,0,0,1,0,0,0,0,0,1  /* Totth 23 and WITHOUT MISSING 24th */
-   };
+   });
    
   /* Ford V10 version of EDIS with 40 teeth instead of 36, 50% duty cycle during normal teeth.. */
- const unsigned char fourty_minus_one[] PROGMEM = 
+ WHEEL_EDGES(fourty_minus_one,
    { /* 40-1 */
      0,1,0,1,0,1,0,1,0,1,  /* Teeth 1-5 */
      0,1,0,1,0,1,0,1,0,1,  /* Teeth 6-10 */ 
@@ -363,23 +339,23 @@
      0,1,0,1,0,1,0,1,0,1,  /* Teeth 26-30 */ 
      0,1,0,1,0,1,0,1,0,1,  /* Teeth 31-35 */ 
      0,1,0,1,0,1,0,1,0,0   /* Teeth 36-39 and MISSING 40th tooth */ 
-   };
+   });
   
   /* 50deg off, 40 deg on dissy style signal */
-  const unsigned char dizzy_four_trigger_return[] PROGMEM = 
+  WHEEL_EDGES(dizzy_four_trigger_return,
     { /* dizzy trigger return */
       0,0,0,0,0,1,1,1,1l  /* Simple off/on signal, 50deg off, 40 deg on */
-    };
+    });
    
   /* Oddfire V twin  135/225 split */
-  const unsigned char oddfire_vr[] PROGMEM = 
+  WHEEL_EDGES(oddfire_vr,
     { /* Oddfire VR */
       1,0,0,0,0,0,0,0,0,1,0,0, /* Tooth 1 and 2 at 0 deg and 135 deg, then 225 off */
       0,0,0,0,0,0,0,0,0,0,0,0 
-    };
+    });
   
   /* GM LT1 360 and 8 wheel, see http://powerefi.com/files/opti-LT1-count.JPG */
-  const unsigned char optispark_lt1[] PROGMEM = 
+  WHEEL_EDGES(optispark_lt1,
     { /* Optispark 360 outside teeth, 8 varying inside teeth */
     /* 1   2   3   4   5   6   7   8   9   10  11  12  13  14  15  16  17  18  19  20  21  22  23  24  25  26  27  28  29  30 */
       0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,
@@ -418,9 +394,9 @@
       2,3,2,3,2,3,2,3,2,3,0,1,0,1,0,1,0,1,0,1,
       0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,
       0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,2,3,2,3  /* 331-360 */
-  };
+  });
   
-  const unsigned char twelve_minus_three[] PROGMEM = 
+  WHEEL_EDGES(twelve_minus_three,
     { /* 12-3, http://www.msextra.com/doc/triggers/12_3_wheel_133.jpg */
       1,0,0,0,1,0,0,0,  /* Teeth 1-2 */
       1,0,0,0,1,0,0,0,  /* Teeth 3-4 */
@@ -428,9 +404,9 @@
       1,0,0,0,1,0,0,0,  /* Teeth 7-8 */
       1,0,0,0,0,0,0,0,  /* Tooth 9 and MISSING 10th */
       0,0,0,0,0,0,0,0   /* MISSING Teeth 11-12 */
-    };
+    });
   
-  const unsigned char thirty_six_minus_two_two_two[] PROGMEM = 
+  WHEEL_EDGES(thirty_six_minus_two_two_two,
     {
       //H4 version
       1,0,1,0,1,0,1,0,1,0,
@@ -441,9 +417,9 @@
       1,0,1,0,1,0,1,0,1,0,
       1,0,0,0,0,0,1,0,1,0,
       1,0 
-    };
+    });
   
-  const unsigned char thirty_six_minus_two_two_two_h6[] PROGMEM = 
+  WHEEL_EDGES(thirty_six_minus_two_two_two_h6,
     {
       //H6 version
       1,0,1,0,1,0,1,0,1,0,
@@ -454,9 +430,9 @@
       1,0,1,0,1,0,1,0,1,0,
       1,0,0,0,0,0,1,0,0,0,
       0,0 
-    };
+    });
   
-  const unsigned char thirty_six_minus_two_two_two_with_cam[] PROGMEM = 
+  WHEEL_EDGES(thirty_six_minus_two_two_two_with_cam,
     { /* 36-2-2-2 H4 with cam  */
       1,0,0,2,0,0,1,0,0,0, /* Tooth one, missing teeth 2,3 and 5, 2nd trigger during teeth 2 and 3 */
       0,0,1,0,1,0,1,0,1,0, /* Missing tooth 6, then 7-10 */
@@ -474,10 +450,10 @@
       1,0,1,0,1,0,1,0,1,0, /* Teeth 26-30 */ 
       1,0,1,0,1,0,1,0,1,0, /* Teeth 31-35 */ 
       1,0                  /* 36th Tooth */
-    };
+    });
    
   
-  const unsigned char fourty_two_hundred_wheel[] PROGMEM = 
+  WHEEL_EDGES(fourty_two_hundred_wheel,
     { /* 4200 wheel http://msextra.com/doc/triggers/4200_timing.pdf */
 		/* 55 deg high, 5 deg low, 55 deg high, 5 deg low,
 		 * 5 deg high, 5 deg low, 45 deg high, 5 deg low,
@@ -491,10 +467,10 @@
 	  1,1,1,1,1,1,1,1,1,1,
 	  1,0,1,1,1,1,1,1,1,1,
 	  1,0
-  };
+  });
 
  /* Mazda F3 36-1 with cam */
- const unsigned char thirty_six_minus_one_with_cam_fe3[] PROGMEM = 
+ WHEEL_EDGES(thirty_six_minus_one_with_cam_fe3,
    { /* 36-1 with cam, 3 cam teeth, 2 180deg from each other */
      1,0,1,0,1,0,1,0,1,0,1,0, /* 0-55 deg */
      1,0,1,0,1,0,3,2,3,0,1,0, /* 60-115 deg  cam tooth at 90 deg crank for 15 crank degrees */
@@ -508,10 +484,10 @@
      1,0,1,0,1,0,1,0,1,0,1,0, /* 540-595 deg */
      1,0,1,0,1,0,1,0,1,0,1,0, /* 600-655 deg */
      1,0,1,0,1,0,1,0,1,0,0,0  /* 660-715 deg Crank missing tooth at end */
-   }; 
+   }); 
   
   /* Mitsubishi 6g72 crank/cam */
-  const unsigned char six_g_seventy_two_with_cam[] PROGMEM = 
+  WHEEL_EDGES(six_g_seventy_two_with_cam,
     { /* Mitsubishi 6g72 */
 	  /* Crank signal's are 50 deg wide, and one per cylinder
 	   * Cam signals have 3 40 deg wide teeh and one 85 deg wide tooth
@@ -535,9 +511,9 @@
       1,1,1,1,1,1,1,1,1,0,
       0,0,0,0,0,0,0,0,0,0,
       0,2,2,3
-    };
+    });
    
-  const unsigned char buell_oddfire_cam[] PROGMEM = 
+  WHEEL_EDGES(buell_oddfire_cam,
     { /* Buell oddfire cam wheel */
 	  /* Wheel is a cam wheel (degress are in crank degrees 
 	   * 36 deg high, 54 deg low,
@@ -556,9 +532,9 @@
 	  0,0,0,0,0,1,1,1,1,0, /* Tail of 54 deg space, 36 deg tooth, begin of 54 deg space */
 	  0,0,0,0,0,1,1,1,1,0, /* Tail of 54 deg space, last 36 deg tooth, begin of 99 deg space */
 	  0,0,0,0,0,0,0,0,0,0  /* Tail of 99 deg space */
-    };
+    });
   
-  const unsigned char gm_ls1_crank_and_cam[] PROGMEM = 
+  WHEEL_EDGES(gm_ls1_crank_and_cam,
     { /* GM LS1 24 tooth crank snd 1 tooth cam */
 	  /* 12 deg low, 3 deg high, 3 deg low,
 	   * 12 deg high, 3deg low, 12 deg high,
@@ -615,10 +591,10 @@
       2,2,2,2,2,2,2,2,2,2,2,2,3,3,3,2,2,2,2,2,
       2,2,2,2,2,2,2,3,3,3,2,2,2,2,2,2,2,2,2,2,
       2,2,3,3,3,2,2,2,2,2,2,2,2,2,2,2,2,3,3,3,
-    };
+    });
 
  //Added by Dale Follett of Twisted Builds LLC for GM gen4 LS 58x 4x crank cam simulation.
- const unsigned char GM_LS_58X_crank_and_4x_cam[] PROGMEM = 
+ WHEEL_EDGES(GM_LS_58X_crank_and_4x_cam,
     { //58x LS crank 4x LS cam
       1,0,1,0,3,2,3,2,3,2, //1-5
       3,2,3,2,3,2,1,0,1,0, //6-10
@@ -644,12 +620,12 @@
       1,0,1,0,1,0,1,0,1,0, //106-110
       1,0,1,0,1,0,1,0,1,0, //111-115
       1,0,1,0,1,0,0,0,0,0, //116-120
-    };
+    });
   
  /* Lotus 36-1-1-1-1 wheel, missing teeth at
   * 14, 17, 32 and 36
   */
- const unsigned char lotus_thirty_six_minus_one_one_one_one[] PROGMEM = 
+ WHEEL_EDGES(lotus_thirty_six_minus_one_one_one_one,
    { /* 36-1-1-1-1 */
      1,0,1,0,1,0,1,0,1,0, /* teeth 1-5 */
      1,0,1,0,1,0,1,0,1,0, /* teeth 6-10 */
@@ -659,8 +635,8 @@
      1,0,1,0,1,0,1,0,1,0, /* teeth 26-30 */
      1,0,0,0,1,0,1,0,1,0, /* teeth 31, MISSING 32, 33-35 */
      0,0                  /* MISSING 36th tooth */
-   }; 
- const unsigned char honda_rc51_with_cam[] PROGMEM = 
+   }); 
+ WHEEL_EDGES(honda_rc51_with_cam,
    { /* Honda RC51 oddfire 90deg Vtwin with cam */
       0,1,0,1,0,1,0,1,0,1, /* teeth 1-5 */
       0,3,0,1,0,1,0,1,0,1, /* teeth 6-10, cam triggers on tooth 6 */
@@ -668,10 +644,10 @@
       0,1,0,1,0,1,0,3,0,1, /* 2nd rotation, teeth 1-5 (13-17), cam trigger on tooth 4(16)*/
       0,3,0,1,0,1,0,1,0,1, /* teeth 6-10 (18-22), cam trigger on tooth 18 */
       0,1,0,1              /* teeth 11-12, (23-24) */
-   };
+   });
 
  /* 36-1 with second trigger pulse across teeth 33-34 on first rotation */
- const unsigned char thirty_six_minus_one_with_second_trigger[] PROGMEM = 
+ WHEEL_EDGES(thirty_six_minus_one_with_second_trigger,
    { /* 36-1 */
      1,0,1,0,1,0,1,0,1,0, /* Teeth 1-5 */
      1,0,1,0,1,0,1,0,1,0, /* Teeth 6-10  */
@@ -689,9 +665,9 @@
      1,0,1,0,1,0,1,0,1,0, /* Teeth 26-30 */
      1,0,1,0,1,0,1,0,1,0, /* Teeth 31-35 */
      0,0                  /* 36th MISSING tooth */
-   }; 
+   }); 
    
- const unsigned char weber_iaw_with_cam[] PROGMEM =
+ WHEEL_EDGES(weber_iaw_with_cam,
    { /*Weber marelli (Cosworth/Lancia) from jimstim
 	   80 deg low, 10 deg high, Tooth 1
 	   20 deg low, 45 deg cam pulse, 15 deg low, 10 deg high, Cam tooth 1 and crank tooth 2
@@ -705,9 +681,9 @@
 	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,2,2,2,2,0,0,0,0,0,0,0,0,1,1, /* Teeth 3 and 4 & cam2 */
 	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1, /* Teeth 5 and 6 */
 	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1  /* Teeth 7 and 8 */
-   };
+   });
 
- const unsigned char fiat_one_point_eight_sixteen_valve_with_cam[] PROGMEM =
+ WHEEL_EDGES(fiat_one_point_eight_sixteen_valve_with_cam,
    {
      /* Starting from TDC #1 
       * Cam is high for 40 deg, low for 20, high 170deg, low for 170, high for 20, 
@@ -738,9 +714,9 @@
      2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,2,2,2,2,2,2,2,
      2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
      2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2
-   };
+   });
 
- const unsigned char three_sixty_nissan_cas[] PROGMEM = 
+ WHEEL_EDGES(three_sixty_nissan_cas,
  /* This version has the 360 teeth on the cam
    {
      1,2,0,2,0,2,0,2,0,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3,1,3, // 1-40 deg
@@ -784,26 +760,26 @@
      2,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1, /* 601-640 deg */
      0,1,0,1,0,1,0,1,0,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3, /* 641-680 deg */
      2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3,2,3, /* 681-720 deg */
-   };
+   });
 
- const unsigned char twenty_four_minus_two_with_second_trigger[] PROGMEM = 
+ WHEEL_EDGES(twenty_four_minus_two_with_second_trigger,
    {
 	 /* See http://postimg.org/image/pcwkrxktx/, 24-2 inner ring, single outer pulse */
 	 1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,3,2,2,2,2,2, /* 11 teeth then outer and missing */
 	 3,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,1,0,0,0,0,0, /* 11 more teeth then missing */
-   };
+   });
 
  /* eight tooth with 1 tooth cam */
- const unsigned char yamaha_eight_tooth_with_cam[] PROGMEM = 
+ WHEEL_EDGES(yamaha_eight_tooth_with_cam,
    { /* Yamaha R1 (02-03) 8 tooth crank with 1 tooth cam */
      0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1, /* Teeth 1-4, 11.25 deg per step */
      0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1, /* teeth 5-8 */
      0,2,2,3,2,0,0,1,0,0,0,1,0,0,0,1, /* Cam tooth on 9 */
      0,0,0,1,0,0,0,1,0,0,0,1,0,0,0,1  /* Teeth 13-16 */
-   };
+   });
 
  /* Mitsubish 4g63 aka 4/2 crank and cam */
- const unsigned char mitsubishi_4g63_4_2[] PROGMEM = 
+ WHEEL_EDGES(mitsubishi_4g63_4_2,
    { //Split into 5 degree blocks (12 per line)
       2,2,2,2,2,2,2,2,2,2,2,0,
       0,0,0,0,0,0,0,0,0,1,1,1, //Start edge 6
@@ -817,10 +793,10 @@
       0,0,0,0,0,0,0,0,0,0,0,0,
       0,0,0,0,0,0,0,0,2,3,3,3,
       3,3,3,3,3,3,3,3,3,3,3,2
-   };
+   });
    
  /* Mitsubish 4g63 aka 4/2 crank and cam */
- const unsigned char audi_135_with_cam[] PROGMEM = 
+ WHEEL_EDGES(audi_135_with_cam,
    { //0 - 180 degrees
      3,3,2,2,3,3,2,2,3,3,2,0,1,1,0,0,1,1,
      0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0,0,
@@ -889,10 +865,10 @@
      1,1,0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,
      0,0,1,1,0,0,1,1,0,0,1,1,0,0,1,1,0,2,
      
-   }; 
+   }); 
 
   /* Honda D17 12+1. 5 degree per entry*/
- const unsigned char honda_d17_no_cam[] PROGMEM = 
+ WHEEL_EDGES(honda_d17_no_cam,
    { //0 - 360 degrees
      1,0,0,0,0,0,1,0,0,0,0,0,
      1,0,0,0,0,0,1,0,0,0,0,0,
@@ -909,17 +885,17 @@
      1,0,0,0,0,0,1,0,0,0,0,0,
      1,0,0,0,0,0,1,0,1,0,0,0
      
-   }; 
+   }); 
 
     /*
      * http://imgur.com/a/ynLWp
      */
-   const unsigned char mazda_323_au[] PROGMEM = 
+   WHEEL_EDGES(mazda_323_au,
    {
      0,0,0,0,0,2,0,0,1,0,0,0,
      0,0,1,0,0,0,0,0,2,0,2,1, 
      0,0,0,0,0,1
-   };
+   });
 
    /*
      * http://www.msextra.com/doc/triggers/daihatsu-trigs.txt
@@ -928,7 +904,7 @@
      * 5 degree per entry
      * 
      */
-   const unsigned char daihatsu_3cyl[] PROGMEM = 
+   WHEEL_EDGES(daihatsu_3cyl,
    { //0 - 360 degrees
      1,1,0,0,0,0,1,1,0,0,0,0, //0-60. Primary pulse plus the additional 1 at 15 crank degrees / 30 cam degrees
      0,0,0,0,0,0,0,0,0,0,0,0, //60-120
@@ -944,10 +920,10 @@
      0,0,0,0,0,0,0,0,0,0,0,0, //540-600
      0,0,0,0,0,0,0,0,0,0,0,0, //600-660
      0,0,0,0,0,0,0,0,0,0,0,0  //660-720
-   };
+   });
 
     /* Mitsubish 4g63 aka 4/2 crank and cam */
- const unsigned char miata_9905[] PROGMEM = 
+ WHEEL_EDGES(miata_9905,
    { //Split into 5 degree blocks (12 per line)
       0,0,0,0,0,0,2,2,0,0,0,0, //Single cam tooth
       0,0,0,0,0,0,0,1,1,0,0,0, //Pulse at 100*
@@ -961,10 +937,10 @@
       0,0,0,0,0,0,0,0,0,0,0,0, //No pulse
       0,0,0,0,0,0,0,1,1,0,0,0, //Pulse at 640
       0,0,0,0,0,0,0,0,0,1,1,0  //Pulse at 710
-   };
+   });
 
    /* 25 deg low, 5 deg high, #12 is missing,  cam is high for 25 deg on second crank rotation just after tooth 21 (9) */
- const unsigned char twelve_with_cam[] PROGMEM = 
+ WHEEL_EDGES(twelve_with_cam,
    { /* 12-1 with cam */
      0,0,0,0,0,1,0,0,0,0,0,1, /* Teeth 1 and 2 */
      0,0,0,0,0,1,0,0,0,0,0,1, /* Teeth 3 and 4 */
@@ -978,10 +954,10 @@
      0,0,0,0,0,1,0,0,0,0,0,1, /* Teeth 19 and 20 */
      0,0,0,0,0,1,2,2,2,2,2,1, /* Tooth 21 and 22,  2nd trigger on cam between teeth 21 and 22 for 25 deg */
      0,0,0,0,0,1,0,0,0,0,0,1  /* Totth 23 and 24th */
-   };
+   });
 
  /* 25 deg low, 5 deg high, #12 is missing,  cam is high for 25 deg on second crank rotation just after tooth 21 (9) */
- const unsigned char twenty_four_with_cam[] PROGMEM = 
+ WHEEL_EDGES(twenty_four_with_cam,
    { /* 24/1 with cam */
      0,0,1,0,0,1,0,0,1,0,0,1, /* Teeth 1 and 2 */
      0,0,1,0,0,1,0,0,1,0,0,1, /* Teeth 3 and 4 */
@@ -995,9 +971,9 @@
      0,0,1,0,0,1,0,0,1,0,0,1, /* Teeth 19 and 20 */
      0,0,1,0,0,1,2,2,3,2,2,1, /* Tooth 21 and 22,  2nd trigger on cam between teeth 21 and 22 for 25 deg */
      0,0,1,0,0,1,0,0,1,0,0,1  /* Totth 23 and 24th */
-   };
+   });
 
-  const unsigned char subaru_six_seven[] PROGMEM =
+  WHEEL_EDGES(subaru_six_seven,
    { /* 6/7 */
     /* Cyl 1 TDC */
       0,0,0,0,0,2,2,2,0,0, 0,2,2,2,0,0,0,2,2,2, /* 00-19 degrees - cam 1-2-3: 5* ATDC */
@@ -1042,11 +1018,11 @@
       0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0, /* 660 degrees */
       0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0, /* 680 degrees */
       0,0,0,0,0,0,0,0,0,0, 1,1,1,0,0,0,0,0,0,0  /* 700 degrees - crank 6: 170* ATDC (710*) */
-    };
+    });
     
  /* GM 7X for 6 cylinder engines */  
  /* https://speeduino.com/forum/download/file.php?id=4743 */
- const unsigned char gm_seven_x[] PROGMEM = 
+ WHEEL_EDGES(gm_seven_x,
    { /* Every number represents 2 degrees */
      0,0,0,0,0,0,0,0,0,0,  /* Degrees 0-20 */
      0,0,0,0,0,0,0,0,0,0,  /* Degrees 20-40 */
@@ -1066,11 +1042,11 @@
      0,0,0,0,0,0,0,0,0,0,  /* Degrees 300-320 */
      0,0,0,0,0,0,0,0,0,0,  /* Degrees 320-340 */
      0,1,1,0,0,0,0,0,0,0  /* Degrees 340-360. Tooth #6 at 342* for 4* duration */
-   }; 
+   }); 
 
   /* DSM 420a Eclipse */
   /* https://github.com/noisymime/speeduino/issues/133 */
-  const unsigned char four_twenty_a[] PROGMEM = 
+  WHEEL_EDGES(four_twenty_a,
    { /* Every number represents 5 degrees */
       0,0,0,0,0,0,0,0,0,0,0,2,
       2,2,2,2,2,2,2,2,2,3,3,2,
@@ -1084,9 +1060,9 @@
       2,2,2,2,2,2,2,2,2,2,2,3,
       3,3,3,3,3,1,1,1,1,1,1,0,
       0,1,1,0,0,1,1,0,0,1,1,0
-   }; 
+   }); 
 
-   const unsigned char ford_st170[] PROGMEM = 
+   WHEEL_EDGES(ford_st170,
    {
       0,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,
       1,1,1,1,1,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,3,3,3,3,3,2,2,2,2,2,3,
@@ -1106,9 +1082,9 @@
       0,1,1,1,1,1,0,0,0,0,0,1,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,3,2,2,2,
       2,3,3,3,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,
       0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0
-   };
+   });
 
-  const unsigned char mitsubishi_3A92 [] PROGMEM =
+  WHEEL_EDGES(mitsubishi_3A92,
   {
     1,0,1,0,1,0,1,0,1,0,
     1,0,1,0,1,0,1,0,1,0,
@@ -1125,11 +1101,11 @@
     1,0,1,0,1,0,1,0,1,0,
     1,0,1,0,1,0,1,0,1,0,
     0,0,0,0
-  };
+  });
 
    /* 4AGE CAS inside dizzy, 4 pulses 2 per crank revolution one cam pulse at 5 Deg  */
 
-	 const unsigned char toyota_4AGE_CAS[] PROGMEM = 
+	 WHEEL_EDGES(toyota_4AGE_CAS, 
 	  {
       1,1,2,2,0,0,0,0,0,0,0,0, /*5 deg per */
       0,0,0,0,0,0,0,0,0,0,0,0,
@@ -1143,10 +1119,10 @@
       1,1,0,0,0,0,0,0,0,0,0,0,
       0,0,0,0,0,0,0,0,0,0,0,0,
       0,0,0,0,0,0,0,0,0,0,0,0,
-	};
+	});
   /* 4AGZE inside dizzy, 24 pulses 12 per crank revolution one cam pulse at 5 Deg  */
 
-	 const unsigned char toyota_4AGZE[] PROGMEM = 
+	 WHEEL_EDGES(toyota_4AGZE, 
    { 1,1,2,0,0,0,0,0,0,0,0,0,
      1,1,0,0,0,0,0,0,0,0,0,0,
      1,1,0,0,0,0,0,0,0,0,0,0,
@@ -1159,18 +1135,18 @@
      1,1,0,0,0,0,0,0,0,0,0,0,
      1,1,0,0,0,0,0,0,0,0,0,0,
      1,1,0,0,0,0,0,0,0,0,0,0
-  };
+  });
 
-  const unsigned char suzuki_DRZ400[] PROGMEM ={
+  WHEEL_EDGES(suzuki_DRZ400,{
       1,1,1,1,1,1,2,2,2,2,0,0,
       3,3,3,3,3,3,2,2,0,0,0,0,
       1,1,1,1,1,1,0,0,0,0,0,0,
       1,1,1,1,1,1,0,0,0,0,0,0,
       1,1,1,1,1,1,0,0,0,0,0,0,
       1,1,1,1,1,1,0,0,0,0,0,0
-  };
+  });
 
-  const unsigned char jeep_2000_4cyl[] PROGMEM = 
+  WHEEL_EDGES(jeep_2000_4cyl,
     { /* Every number represents 2 degrees. */
       0,0,0,0,0,0,0,0,0,0,  /* Degrees 0-20. */
       0,0,0,0,0,0,0,0,0,0,  /* Degrees 20-40. */
@@ -1208,9 +1184,9 @@
       0,0,0,0,0,0,1,0,0,0,  /* Degrees 660-680. Tooth #14 at 674* for 2* duration. */
       0,0,0,0,0,0,1,0,0,0,  /* Degrees 680-700. Tooth #15 at 694* for 2* duration. */
       0,0,0,0,0,0,1,0,0,0  /* Degrees 700-720. Tooth #16 at 714* for 2* duration. */
-   };
+   });
 
-   const unsigned char viper9602wheel[] PROGMEM = 
+   WHEEL_EDGES(viper9602wheel,
    // Viper pattern has 10 total crank teeth that are on shortly in pairs. Cam is high for 360* of crank then low for the next 360* of crank
    // This pattern was added by Dale Follett of Twisted Builds LLC going off a supplied oscilloscope image of the wheel pattern. Due to this
    // There is no guarentees on this wheel pattern as of 3/24/2024 and this pattern should be used at your own risk. However it should be correct.
@@ -1242,10 +1218,10 @@
       0,0,0,0,0,0,0,0,0,0, //46-50
       0,0,1,1,0,0,0,0,1,1, //51-55
       0,0,0,0,0,0,0,0,0,0, //56-60
-   };
+   });
 
  /* 36-2 with second trigger pulse across teeth 33-34 on first rotation */
- const unsigned char thirty_six_minus_two_with_second_trigger[] PROGMEM =
+ WHEEL_EDGES(thirty_six_minus_two_with_second_trigger,
    { /* 36-2 + single tooth cam */
      1,0,1,0,1,0,1,0,1,0, /* Teeth 1-5 */
      1,0,1,0,3,2,3,2,1,0, /* Teeth 6-10, cam in here somewhere - length/position not accurate to actual engine*/
@@ -1263,11 +1239,11 @@
      1,0,1,0,1,0,1,0,1,0, /* Teeth 26-30 */
      1,0,1,0,1,0,1,0,0,0, /* Teeth 31-34, 35th tooth missing  */
      0,0                  /* 36th MISSING tooth */
-   };
+   });
 
    // GM 40 tooth OSS wheel for transmission simulation. Simple on/off 40 teeth for 360* of rotation with no missing teeth.
    //Added by Dale Follett of Twisted Builds LLC 02-23-2025 for transmission controller simulation.
-  const unsigned char GM40toothOSS[] PROGMEM = 
+  WHEEL_EDGES(GM40toothOSS,
    {
       1,0,1,0,1,0,1,0,1,0, // Teeth 0-5
       1,0,1,0,1,0,1,0,1,0, // Teeth 6-10
@@ -1277,6 +1253,254 @@
       1,0,1,0,1,0,1,0,1,0, // Teeth 26-30
       1,0,1,0,1,0,1,0,1,0, // Teeth 31-35
       1,0,1,0,1,0,1,0,1,0, // Teeth 36-40
-   };
+   });
+
+ WHEEL_EDGES(chrysler_ngc_thirty_six_plus_two_minus_two_with_ngc4_cam,
+   { /* 36+2-2 NGC-4 needs 1 deg resolution, Chrysler NGC engines used in Chrysler/Dodge/Jeep
+      * cam edges are at 26,62,98,134,170,314,350,368,422,458,494,530,674 and 710 dev
+    * crank is 36 teeth with two sets of two missing teeth ~180 degrees apart
+    * The sets of missing teeth have different polarity to distinguish position
+    */
+    /* Crankshaft degrees
+     1   3   5   7   9  11  13  15  17  19  21  23  25  27  29  31  33  35  37  39  41 */
+   0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3, /* degrees */
+   2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1, /* 41-80 */
+   0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3, /* 81-120 */
+   2,2,2,2,2,3,3,3,3,3,2,2,2,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1, /* 121-160 */
+   0,0,0,0,0,1,1,1,1,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2, /* 161-200 */
+   2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3, /* 201-240 */
+   2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3, /* 241-280 */
+   2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,0,0,1,1,1,1,1, /* 281-320 */
+   0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,3,2,2,2,2,2,3,3,3,3,3, /* 321-360 */
+   2,2,2,2,2,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,3,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1, /* 361-400 */
+   0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3, /* 401-440 */
+   2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1, /* 441-480 */
+   0,0,0,0,0,1,1,1,1,1,0,0,0,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3, /* 481-520 */
+   2,2,2,2,2,3,3,3,3,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* 521-560 */
+   0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1, /* 561-600 */
+   0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1, /* 601-640 */
+   0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,2,2,3,3,3,3,3, /* 641-680 */
+   2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,3,2,2,2,2,2,3,3,3,3,1,0,0,0,0,0,1,1,1,1,1  /* 681-720 */
+   });
+
+ WHEEL_EDGES(chrysler_ngc_thirty_six_minus_two_plus_two_with_ngc6_cam,
+ { /*
+   Crank is same as NGC 4 pattern except cylinder 1 TDC is 180 degrees off, hence 36-2+2
+ 
+   Cam information has been determined from:
+   https://rotkee.com/en/wavebase/good-timing-ckp-cmp-signal-dodge-charger-lx-ld-2006-2010?brand=167
+   https://rotkee.com/en/wavebase/good-timing-ckp-cmp-signal-jeep-liberty-kj-2002-2007?brand=180
+   https://rotkee.com/en/wavebase/good-timing-ckp-cmp-signal-dodge-caravan-2008-2020?brand=167
+   Cam cylinder 1 has been determined from https://youtu.be/CVXKXmCudAs?t=893
+ 
+   Cam has 6 groups consisting of 1-3 teeth. Each group starting 120 degrees apart.
+   The number of teeth per group form the pattern 3-1-2-3-2-1 of which any 2 values can be used to determine position.
+   Each tooth is ~10 degrees wide and is spaced ~21 degrees from the other teeth.
+   */
+   2,2,0,0,0,0,0,0,0,0,0,0,0,2,2,2,2,2,2,2,2,2,2,0,0,1,1,1,1,1,0,0,0,0,2,3,
+   3,3,3,3,2,2,2,2,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,
+   0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,
+   1,1,0,0,2,2,2,3,3,3,3,3,2,2,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,
+   0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,1,
+   1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,2,2,2,3,3,3,3,3,2,2,0,0,0,1,1,1,1,1,0,0,
+   0,2,2,3,3,3,3,3,2,2,2,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,
+   1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,2,2,2,3,3,3,3,3,
+   2,2,0,0,0,0,0,0,0,0,0,0,0,2,2,2,2,2,2,2,2,2,2,0,0,1,1,1,1,1,0,0,0,0,2,3,
+   3,3,3,3,2,2,2,2,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,
+   0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,
+   1,1,0,0,2,2,2,3,3,3,3,3,2,2,0,0,0,1,1,1,1,1,0,0,0,2,2,3,3,3,3,3,2,2,2,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,
+   0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,1,
+   1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,2,2,2,3,3,3,3,3,2,2,0,0,0,1,1,1,1,1,0,0,
+   0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,
+   1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,2,2,2,3,3,3,3,3
+ });
+
+ WHEEL_EDGES(chrysler_ngc_thirty_six_minus_two_plus_two_with_ngc8_cam,
+ { /*
+   Crank is same as NGC 4 pattern except cylinder 1 TDC is 180 degrees off, hence 36-2+2
+   
+   Cam information has been determined from:
+   https://rotkee.com/en/wavebase/good-timing-ckp-cmp-in-cylinder-pressure-dodge-ram-3-dr-dh-d1-dc-dm-2001-2009?brand=167
+   https://rotkee.com/en/wavebase/good-timing-ckp-cmp-signal-dodge-durango-2-2003-2008?brand=167
+   https://rotkee.com/en/wavebase/good-timing-ckp-cmp-signal-dodge-ram-3-dr-dh-d1-dc-dm-2001-2009?engine=2299
+ 
+   Cam has 8 groups consisting of 1-3 teeth. Each group starting 90 degrees apart.
+   The number of teeth per group form the pattern 1-2-3-2-2-1-3-1 of which any 2 values can be used to determine position.
+   Each tooth is ~8 degrees wide and is spaced ~21 degrees from the other teeth.
+   */
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,
+   1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,
+   0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,
+   1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1,
+   0,0,0,0,0,1,1,1,3,3,3,3,3,3,3,3,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,1,
+   1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,
+   0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1,0,0,0,0,0,1,1,1,3,3,2,2,2,2,2,3,1,1,
+   1,1,0,0,0,0,0,1,1,1,1,3,2,2,2,2,2,3,3,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1,
+   0,0,0,0,0,0,0,0,2,2,2,2,2,2,2,2,0,0,0,0,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,
+   1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,
+   0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1,0,0,0,0,0,1,1,1,3,3,2,2,2,2,2,3,1,1,
+   1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1,
+   0,0,0,0,0,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,0,0,0,0,0,1,
+   1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,
+   0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1,0,0,0,0,0,1,1,1,3,3,2,2,2,2,2,3,1,1,
+   1,1,0,0,0,0,0,1,1,1,1,3,2,2,2,2,2,3,3,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,
+   0,1,1,1,1,1,0,0,0,0,0,1,1,1,1,1,0,0,0,0,0,1,1,3,3,3,2,2,2,2,2,1,1,1,1,1
+ });
+
+ /* 50% dutycle, 4 tooth + 1 cam */
+ WHEEL_EDGES(gm_four_tooth_with_cam,
+   { /* 4 cylinder with 1 cam pulse for 360 crank degrees */
+     1,0,1,0,3,2,3,2 /* two pulses per crank revolution (one per cylinder) */
+   });
+
+ /* 50% dutycle, 6 tooth + 1 cam */
+ WHEEL_EDGES(gm_six_tooth_with_cam,
+   { /* 6 cylinder with 1 cam pulse for 360 crank degrees */
+     1,0,1,0,1,0,3,2,3,2,3,2 /* three pulses per crank revolution (one per cylinder) */
+   });
+
+ /*  50% dutycle, 8 tooth + 1 cam */
+ WHEEL_EDGES(gm_eight_tooth_with_cam,
+   { /* 8 cylinder with 1 cam pulse for 360 crank degrees  */
+     1,0,1,0,1,0,1,0,3,2,3,2,3,2,3,2 /* four pulses per crank revolution (one per cylinder) */
+   });
+
+ WHEEL_EDGES(volvo_d12acd_with_cam,
+   { /* Volvo 6 cylinder dieslet  17-1-17-1-17-1 (60 overall teeth) */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 1-4 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 5-8 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 9-12 */
+   2,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 13-16 */
+   0,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1, /* Teeth 17-20 1 normal, 1 long (3 teeth wide) */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 21-24 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 25-28 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 29-32 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 33-36 */
+   0,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1, /* Teeth 37-40 1 normal, 1 long (3 teeth wide) */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 41-44 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 45-48 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 49-52 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 53-56 */
+   0,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1, /* Teeth 57-60 1 normal, 1 long (3 teeth wide) */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 1-4 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 5-8 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 9-12 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 13-16 */
+   0,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1, /* Teeth 17-20 1 normal, 1 long (3 teeth wide) */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 21-24 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 25-28 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 29-32 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 33-36 */
+   0,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1, /* Teeth 37-40 1 normal, 1 long (3 teeth wide) */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 41-44 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 45-48 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 49-52 */
+   0,1,1,1,0,1,1,1,0,1,1,1,0,1,1,1, /* Teeth 53-56 */
+   0,1,1,1,2,1,1,1,1,1,1,1,1,1,1,1, /* Teeth 57-60 1 normal, 1 long (3 teeth wide) */
+   });
+
+ WHEEL_EDGES(mazda_thirty_six_minus_two_two_two_with_six_tooth_cam,
+   { /* Mazda 36-2-2-2 with 6 tooth cam */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 1-3*/
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 4-6*/
+     1,1,0,0,0, 1,3,2,2,2, 3,3,2,2,2, /* Teeth 7-9 , second trigger on tooth 9 */ 
+     3,1,0,0,0, 1,1,0,0,0, 0,0,0,0,0, /* Teeth 10,11, missing 12 */
+     0,0,0,0,0, 1,3,2,2,2, 2,2,2,2,2, /* Missing 13, 14, Missing 15 , second trigger on missing tooth 15 */
+     2,0,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Missing 16, 17-18m 2nd trigger ends on tooth 16 */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 19-21 */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 22-24 */
+     1,1,0,0,0, 1,3,2,2,2, 3,3,2,2,2, /* Teeth 25-27, second trigger on tooth 26-27 */
+     3,1,0,0,0, 1,1,0,0,0, 0,0,0,0,0, /* Teeth 28-29, missing 30 */
+     0,0,0,0,0, 1,3,2,2,2, 3,3,2,2,2, /* Missing 31, Tooth 32, 33, 2nd trigger within tooth 32 */
+     3,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 34-36, 2nd trigger ends just after tooth 32 starts*/
+     /* SECOND ROTATION */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 1-3 */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 4-6 */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 7-9 */
+     1,1,0,0,0, 1,1,0,0,0, 0,0,0,0,0, /* Teeth 10,11, missing 12 */
+     0,0,0,0,0, 1,3,2,2,2, 2,2,2,2,2, /* Missing 13, 14, Missing 15 , second trigger on 14-15 */
+     2,0,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Missing 16, 17-18 */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 19-21 */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 22-24 */
+     1,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 25-27 */
+     1,1,0,0,0, 1,1,0,0,0, 0,0,0,0,0, /* Teeth 28-29, missing 30 */
+     0,0,0,0,0, 1,3,2,2,2, 3,3,2,2,2, /* Missing 31,Tooth 32-33, 2nd trigger  on 32-33*/
+     3,1,0,0,0, 1,1,0,0,0, 1,1,0,0,0, /* Teeth 34-36, 2nd trigger ends jsut after tooth 34 starts */
+});
+
+  WHEEL_EDGES(jeep_2000_6cyl,
+   { /* Every number represents 2 degrees. */
+     0,0,0,0,0,0,0,0,0,0,  /* Degrees 0-20. */
+     0,0,0,0,0,0,0,0,0,0,  /* Degrees 20-40. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 40-60. Tooth #1 at 54* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 60-80. Tooth #2 at 74* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 80-100. Tooth #3 at 94* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 100-120. Tooth #4 at 114* for 2* duration. */
+     0,0,0,0,0,0,0,0,0,0,  /* Degrees 120-140. */
+     0,0,0,2,2,2,2,2,2,2,  /* Degrees 140-160. Camshaft is active from 146* to 506* (total = 360*). */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 160-180. Tooth #5 at 174* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 180-200. Tooth #6 at 194* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 200-220. Tooth #7 at 214* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 220-240. Tooth #8 at 234* for 2* duration. */
+     2,2,2,2,2,2,2,2,2,2,  /* Degrees 240-260. */
+     2,2,2,2,2,2,2,2,2,2,  /* Degrees 260-280. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 280-300. Tooth #9 at 294* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 300-320. Tooth #9 at 314* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 320-340. Tooth #9 at 334* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 340-360. Tooth #9 at 354* for 2* duration. */
+     2,2,2,2,2,2,2,2,2,2,  /* Degrees 360-380. */
+     2,2,2,2,2,2,2,2,2,2,  /* Degrees 380-400. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 400-420. Tooth #10 at 414* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 420-440. Tooth #11 at 434* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 440-460. Tooth #12 at 454* for 2* duration. */
+     2,2,2,2,2,2,2,3,2,2,  /* Degrees 460-480. Tooth #13 at 474* for 2* duration. */
+     2,2,2,2,2,2,2,2,2,2,  /* Degrees 480-500. */
+     2,2,2,0,0,0,0,0,0,0,  /* Degrees 500-520. Camshaft is down at 506. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 520-540. Tooth #14 at 534* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 540-560. Tooth #15 at 554* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 560-580. Tooth #16 at 574* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 580-600. Tooth #17 at 594* for 2* duration. */
+     0,0,0,0,0,0,0,0,0,0,  /* Degrees 600-620. */
+     0,0,0,0,0,0,0,0,0,0,  /* Degrees 620-640. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 640-660. Tooth #18 at 654* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 660-680. Tooth #19 at 674* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0,  /* Degrees 680-700. Tooth #20 at 694* for 2* duration. */
+     0,0,0,0,0,0,0,1,0,0  /* Degrees 700-720. Tooth #21 at 714* for 2* duration. */
+   });
+
+   WHEEL_EDGES(bmw_n20,
+   { 
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 1-5 (TDC Cylinder 1, first tooth after missing)
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 6-10
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 11-15
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 16-20, both camshaft signals high
+     7,6,7,6,7,6,1,0,1,0, //Crank teeth 21-25, both camshaft signals high until last two teeth, then low
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 26-30
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 31-35
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 36-40
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 41-45
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 46-50, both camshaft signals high for 180* (30 teeth)
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 51-55
+     7,6,7,6,7,6,6,6,6,6, //Crank teeth 56-60 - last two teeth missing
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 1-5
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 6-10
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 11-15
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 16-20 cam signals low
+     1,0,1,0,7,6,7,6,7,6, //Crank teeth 21-25 cam signals low then back high
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 26-30
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 31-35
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 36-40
+     7,6,7,6,7,6,7,6,7,6, //Crank teeth 41-45
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 46-50
+     1,0,1,0,1,0,1,0,1,0, //Crank teeth 51-55
+     1,0,1,0,1,0,0,0,0,0, //Crank teeth 56-60 - last two teeth missing
+   });
 
 #endif
\ No newline at end of file
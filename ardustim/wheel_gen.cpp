@@ -0,0 +1,160 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Parametric N-M missing tooth wheel
+ *
+ * See wheel_gen.h
+ */
+
+#include "wheel_gen.h"
+#include "timer_math.h"
+#include <avr/pgmspace.h>
+#include <stdio.h>
+
+struct gen_params genParams;
+uint8_t gen_edges[GEN_MAX_EDGES];
+#if ENABLE_LEARN
+struct gen_learned genLearned;
+#endif
+
+void gen_defaults(struct gen_params *params)
+{
+  params->teeth = 36;
+  params->missing = 1;
+  params->duty = 50;
+  params->cam_tooth = 0;
+  params->cam_degrees = 0;
+}
+
+//! Crank revolutions the pattern covers
+static uint8_t gen_revs(const struct gen_params *params)
+{
+  return params->cam_tooth ? 2 : 1;
+}
+
+bool gen_params_valid(const struct gen_params *params)
+{
+  if (params->teeth < 2 || params->missing >= params->teeth) { return false; }
+  if (params->duty < 1 || params->duty > 99) { return false; }
+  if (params->cam_tooth > params->teeth) { return false; }
+  if (params->cam_tooth && params->cam_degrees == 0) { return false; }
+  /* Two slices per tooth at the least */
+  return ((uint16_t)params->teeth * 2 * gen_revs(params)) <= GEN_MAX_EDGES;
+}
+
+void gen_layout(uint8_t *slices, uint8_t *high)
+{
+  uint16_t budget = GEN_MAX_EDGES / ((uint16_t)genParams.teeth * gen_revs(&genParams));
+  uint16_t best_err = 0xFFFF;
+  uint8_t best_slices = 2;
+
+  if (budget > GEN_MAX_SLICES) { budget = GEN_MAX_SLICES; }
+  *slices = 2;
+  *high = 1;
+
+  /* Fewest slices that get closest to the duty, each one costs max RPM */
+  for (uint8_t s = 2; s <= budget; s++)
+  {
+    uint8_t h = ((uint16_t)genParams.duty * s + 50) / 100;
+    if (h < 1) { h = 1; }
+    if (h > s - 1) { h = s - 1; }
+
+    /* |h/s - duty/100| compared across slice counts as err/s */
+    int16_t diff = (int16_t)(100 * h) - (int16_t)genParams.duty * s;
+    uint16_t err = (diff < 0) ? -diff : diff;
+    if ((uint32_t)err * best_slices < (uint32_t)best_err * s)
+    {
+      best_err = err;
+      best_slices = s;
+      *slices = s;
+      *high = h;
+    }
+  }
+}
+
+float gen_rpm_scaler()
+{
+  uint8_t slices, high;
+  uint8_t revs = gen_revs(&genParams);
+
+#if ENABLE_LEARN
+  if (genLearned.edges) { return wheel_rpm_scaler(genLearned.edges, genLearned.degrees); }
+#endif
+  gen_layout(&slices, &high);
+  return wheel_rpm_scaler((uint16_t)genParams.teeth * slices * revs, 360 * revs);
+}
+
+void gen_render(wheels *wheel)
+{
+  uint8_t slices, high;
+  uint8_t revs = gen_revs(&genParams);
+  uint8_t present = genParams.teeth - genParams.missing;
+  uint16_t edges = 0;
+
+#if ENABLE_LEARN
+  if (genLearned.edges)
+  {
+    /* learn_task() filled gen_edges[] in */
+    wheel->edge_states_ptr = gen_edges;
+    wheel->wheel_max_edges = genLearned.edges;
+    wheel->wheel_degrees = genLearned.degrees;
+    wheel->rpm_scaler = wheel_rpm_scaler(genLearned.edges, genLearned.degrees);
+    return;
+  }
+#endif
+  gen_layout(&slices, &high);
+  for (uint8_t rev = 0; rev < revs; rev++)
+  {
+    for (uint8_t tooth = 0; tooth < genParams.teeth; tooth++)
+    {
+      for (uint8_t slice = 0; slice < slices; slice++)
+      {
+        gen_edges[edges++] = ((tooth < present) && (slice < high)) ? 1 : 0;
+      }
+    }
+  }
+
+  /* The cam pulse is in the second revolution and may run on past the end */
+  if (genParams.cam_tooth)
+  {
+    uint16_t cam_edge = ((uint16_t)genParams.teeth + genParams.cam_tooth - 1) * slices;
+    uint16_t cam_len = ((uint32_t)genParams.cam_degrees * genParams.teeth * slices + 180) / 360;
+
+    if (cam_len < 1) { cam_len = 1; }
+    if (cam_len >= edges) { cam_len = edges - 1; }
+    while (cam_len--)
+    {
+      gen_edges[cam_edge] |= 2;
+      if (++cam_edge == edges) { cam_edge = 0; }
+    }
+  }
+
+  wheel->edge_states_ptr = gen_edges;
+  wheel->wheel_max_edges = edges;
+  wheel->wheel_degrees = 360 * revs;
+  wheel->rpm_scaler = wheel_rpm_scaler(edges, wheel->wheel_degrees);
+}
+
+uint8_t gen_name(char *buf, uint8_t size)
+{
+  int len;
+
+#if ENABLE_LEARN
+  if (genLearned.edges)
+  {
+    const char *cam = genLearned.cam ? " Cam" : "";
+    if (genLearned.units == 0) { len = snprintf_P(buf, size, PSTR("Learned %uT%s"), genLearned.teeth, cam); }
+    else if (genLearned.units == genLearned.teeth) { len = snprintf_P(buf, size, PSTR("Learned %u%s"), genLearned.teeth, cam); }
+    else { len = snprintf_P(buf, size, PSTR("Learned %u-%u%s"), genLearned.units, genLearned.units - genLearned.teeth, cam); }
+    return (len < size) ? len : size - 1;
+  }
+#endif
+  if (genParams.cam_tooth)
+  {
+    len = snprintf_P(buf, size, PSTR("Gen %u-%u Cam@%u %u%%"), genParams.teeth, genParams.missing, genParams.cam_tooth, genParams.duty);
+  }
+  else
+  {
+    len = snprintf_P(buf, size, PSTR("Gen %u-%u %u%%"), genParams.teeth, genParams.missing, genParams.duty);
+  }
+  return (len < size) ? len : size - 1;
+}
@@ -0,0 +1,104 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Parametric N-M missing tooth wheel
+ *
+ * GENERATED_WHEEL, the entry after the WHEEL_LIST wheels, has no table in
+ * flash. Its pattern is N tooth positions per crank revolution with the last
+ * M removed (the gap is just before tooth 1), a tooth duty cycle, and
+ * optionally a single cam pulse on the second revolution starting at a given
+ * tooth, in which case the pattern covers 720 degrees.
+ *
+ * gen_render() builds the edges into gen_edges[] in RAM, one byte per edge,
+ * whenever the parameters or the wheel change. Each tooth is split into
+ * slices, an edge per slice, enough of them to get the duty cycle within
+ * GEN_MAX_SLICES of the buffer. The pattern ISR then reads one RAM byte per
+ * edge, cheaper than the packed flash read of the table wheels, and the
+ * GPIOR0 flag that picks between the two is a single skip instruction.
+ *
+ * Learn mode (learn.h) writes a recorded wheel into gen_edges[] instead and
+ * describes it in genLearned, gen_render() then leaves it as it is until
+ * new parameters are set.
+ */
+#ifndef __WHEEL_GEN_H__
+#define __WHEEL_GEN_H__
+
+#include <stdint.h>
+#include <avr/io.h>
+#include "globals.h"
+#include "wheel_pack.h"
+#include "learn.h"
+
+#ifndef GEN_MAX_EDGES
+#define GEN_MAX_EDGES   240   /* RAM for the edges, a 60 tooth wheel with cam at 50% duty */
+#endif
+#define GEN_MAX_SLICES  8     /* Edges per tooth, 12.5% duty steps */
+#define GEN_ACTIVE_BIT  0     /* GPIOR0 bit, set while GENERATED_WHEEL is the active wheel */
+
+/* Generator parameters, saved with the config */
+struct gen_params
+{
+  uint8_t teeth;        //N, tooth positions per crank revolution, missing ones included
+  uint8_t missing;      //M, the last M positions have no tooth
+  uint8_t duty;         //Tooth high time, percent of the tooth pitch
+  uint8_t cam_tooth;    //Tooth (1 = first after the gap) the cam pulse starts on, 0 = no cam (360 degrees)
+  uint8_t cam_degrees;  //Cam pulse width in crank degrees
+};
+extern struct gen_params genParams;
+
+extern uint8_t gen_edges[GEN_MAX_EDGES];
+
+#if ENABLE_LEARN
+/* A learned wheel in gen_edges[] in place of genParams, not saved */
+struct gen_learned
+{
+  uint16_t edges;       //0 = none, gen_render() builds genParams
+  uint16_t degrees;
+  uint8_t teeth;        //Crank teeth per crank period
+  uint8_t units;        //Tooth positions per crank period, 0 if the teeth aren't on a single pitch
+  bool cam;
+};
+extern struct gen_learned genLearned;
+#endif
+
+//! Drops a learned wheel, genParams describe the generated wheel again
+static inline void gen_forget_learned()
+{
+#if ENABLE_LEARN
+  genLearned.edges = 0;
+#endif
+}
+
+//! Sets the parameters for a fresh EEPROM, 36-1 at 50% without cam
+void gen_defaults(struct gen_params *params);
+
+//! True if params describe a wheel that fits gen_edges[]
+bool gen_params_valid(const struct gen_params *params);
+
+//! Edges per tooth and how many of them are high for genParams
+/*!
+ * @param slices Set to the edges per tooth, 2..GEN_MAX_SLICES
+ * @param high Set to the high edges, 1..slices-1
+ */
+void gen_layout(uint8_t *slices, uint8_t *high);
+
+//! RPM scaler of genParams without rendering it, for serial 'M'
+float gen_rpm_scaler();
+
+//! Builds genParams into gen_edges[] and fills wheel in for the pattern ISR
+/*!
+ * Called by load_wheel() with interrupts off, the ISR must not be reading
+ * gen_edges[] while it's rewritten
+ */
+void gen_render(wheels *wheel);
+
+//! Copies the generated wheel's name, e.g. "Gen 36-1 Cam@1 50%" or "Learned 60-2 Cam"
+uint8_t gen_name(char *buf, uint8_t size);
+
+//! Output states of edge of the active wheel, generated or from its flash table
+static inline uint8_t active_edge_state(uint16_t edge)
+{
+  if (GPIOR0 & (1 << GEN_ACTIVE_BIT)) { return gen_edges[edge]; }
+  return wheel_edge_state(activeWheel.edge_states_ptr, edge);
+}
+
+#endif
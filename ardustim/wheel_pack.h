@@ -0,0 +1,60 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Nibble packed wheel edge storage
+ *
+ * An edge only drives three outputs (crank, cam1, cam2, see wheel_defs.h)
+ * so Wheels[] stores two edges per flash byte, even edge in the low nibble.
+ * The edge arrays in wheel_defs.h stay one readable value per edge; they are
+ * constexpr members that are never defined (WHEEL_EDGES()), only read by
+ * pack_edges() at compile time, so they take no flash or RAM of their own
+ * and a run time use fails to link.
+ *
+ * The pattern ISR reads the packed table straight from flash with
+ * wheel_edge_state(), the longest wheels (720 edges) wouldn't fit in RAM
+ * unpacked.
+ */
+#ifndef __WHEEL_PACK_H__
+#define __WHEEL_PACK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+/* Packed bytes of one edge array */
+template<size_t N> struct packed_edges {
+  unsigned char bytes[(N + 1) / 2];
+};
+
+/* 0..M-1 as a parameter pack, C++11 has no std::index_sequence */
+template<size_t... I> struct edge_seq {};
+template<size_t M, size_t... I> struct make_edge_seq : make_edge_seq<M - 1, M - 1, I...> {};
+template<size_t... I> struct make_edge_seq<0, I...> { typedef edge_seq<I...> type; };
+
+template<size_t N, size_t... I>
+constexpr packed_edges<N> pack_edges(const unsigned char (&edges)[N], edge_seq<I...>)
+{
+  return {{ (unsigned char)((edges[2 * I] & 0x0F) | (((2 * I + 1 < N) ? edges[2 * I + 1] : 0) << 4))... }};
+}
+
+//! Packs an edge array two edges per byte, at compile time
+template<size_t N>
+constexpr packed_edges<N> pack_edges(const unsigned char (&edges)[N])
+{
+  return pack_edges(edges, typename make_edge_seq<(N + 1) / 2>::type());
+}
+
+//! True if every edge in [lo, hi) fits its nibble, split in halves to stay clear of the constexpr depth limit
+constexpr bool edges_fit_nibble(const unsigned char *edges, size_t lo, size_t hi)
+{
+  return (hi - lo == 1) ? (edges[lo] < 0x10) :
+         (edges_fit_nibble(edges, lo, lo + (hi - lo) / 2) && edges_fit_nibble(edges, lo + (hi - lo) / 2, hi));
+}
+
+//! Output states of edge in a packed table in flash
+static inline uint8_t wheel_edge_state(const unsigned char *packed, uint16_t edge)
+{
+  uint8_t states = pgm_read_byte(&packed[edge >> 1]);
+  return (edge & 1) ? (states >> 4) : (states & 0x0F);
+}
+
+#endif
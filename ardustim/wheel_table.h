@@ -0,0 +1,53 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Wheel table
+ *
+ * The Wheels[] array tying each wheel type in wheel_defs.h to its name, edge
+ * array and timing parameters, generated from WHEEL_LIST and kept in flash.
+ * Edge arrays are stored nibble packed (wheel_pack.h).
+ * The pattern ISR works from a RAM copy of the selected wheel, activeWheel.
+ * Defines storage, so it's included exactly once by ardustim.ino (and by the
+ * host side tools that replay the timer math).
+ */
+#ifndef __WHEEL_TABLE_H__
+#define __WHEEL_TABLE_H__
+
+#include "globals.h"
+#include "wheel_defs.h"
+#include "timer_math.h"
+#include "wheel_pack.h"
+
+/* Name strings, <edge array>_name */
+#define WHEEL_NAME(id, pattern, name, degrees) static const char pattern##_name[] PROGMEM = name;
+WHEEL_LIST(WHEEL_NAME)
+#undef WHEEL_NAME
+
+/* Packed edge tables, <edge array>_packed */
+#define WHEEL_PACKED(id, pattern, name, degrees) \
+  constexpr packed_edges<sizeof(pattern##_edges::edges)> pattern##_packed PROGMEM = pack_edges(pattern##_edges::edges);
+WHEEL_LIST(WHEEL_PACKED)
+#undef WHEEL_PACKED
+
+/* Consistency checks, the rest is correct by construction */
+#define WHEEL_CHECK(id, pattern, name, degrees) \
+  static_assert(sizeof(pattern##_edges::edges) <= 0xFFFF, #pattern " has more edges than wheel_max_edges holds"); \
+  static_assert(((degrees) == 180) || ((degrees) == 360) || ((degrees) == 720), #id " covers an odd number of degrees"); \
+  static_assert(sizeof(name) <= WHEEL_NAME_MAX + 1, #id " name is wider than the LCD"); \
+  static_assert(edges_fit_nibble(pattern##_edges::edges, 0, sizeof(pattern##_edges::edges)), #pattern " has an edge value that doesn't pack into 4 bits");
+WHEEL_LIST(WHEEL_CHECK)
+#undef WHEEL_CHECK
+static_assert(MAX_WHEELS <= 255, "config.wheel is a byte");
+
+/* GENERATED_WHEEL has no edge table, load_wheel() has gen_render() fill it in */
+static const char generated_wheel_name[] PROGMEM = "N-M Generator";
+
+const wheels Wheels[MAX_WHEELS] PROGMEM = {
+   /* Pointer to friendly name string, pointer to packed edge array, RPM Scaler, Number of edges in the array, degrees of rotation the edges cover */
+#define WHEEL_ENTRY(id, pattern, name, degrees) \
+  { pattern##_name, pattern##_packed.bytes, wheel_rpm_scaler(sizeof(pattern##_edges::edges), degrees), sizeof(pattern##_edges::edges), degrees },
+  WHEEL_LIST(WHEEL_ENTRY)
+#undef WHEEL_ENTRY
+  { generated_wheel_name, NULL, 0, 0, 360 },
+};
+
+#endif
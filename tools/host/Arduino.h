@@ -0,0 +1,31 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * Host build shim for Arduino.h
+ *
+ * Just enough of the Arduino core for the host side tools to compile the
+ * firmware's data and math headers (globals.h, wheel_defs.h, timer_math.h).
+ * The timing functions are only declared, a tool that compiles firmware code
+ * calling them supplies its own (usually a simulated clock).
+ */
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+
+// Flash is no concern here, keep wheel names plain so decoder_name reads as is
+#ifndef ENABLE_STRING_DICT
+#define ENABLE_STRING_DICT 0
+#endif
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint16_t us);
+char *itoa(int value, char *buf, int radix);
+
+#endif
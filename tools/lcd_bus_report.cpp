@@ -0,0 +1,356 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * LCD bus cost report
+ *
+ * Runs the firmware's TwiLcdDisplay (ardustim/twi_lcd_display.cpp) against a
+ * mock of twi_master.cpp that records every transaction instead of touching
+ * hardware, and compares the bus cost of typical screen updates with what
+ * LiquidCrystal_I2C on Wire spends on the same characters.
+ *
+ * Every recorded byte is also fed through a model of the PCF8574 pins and the
+ * HD44780 controller: nibbles are latched on EN's falling edge, RS must be
+ * stable before EN rises and nothing may be latched while the previous
+ * instruction is still executing. The decoded display must match what was
+ * written, so the report doubles as a check of the packed encoding; the exit
+ * status is non-zero if anything doesn't.
+ *
+ * Finally the display is unplugged and plugged back in: the driver must go
+ * offline, re-probe on the doubling back-off schedule and re-initialise the
+ * (power cycled) controller by itself.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Itools/host -Iardustim tools/lcd_bus_report.cpp ardustim/twi_lcd_display.cpp -o lcd_bus_report
+ *   ./lcd_bus_report
+ * Add -DLCD_TWI_FREQUENCY=100000 to the build to see the driver at 100kHz.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "twi_lcd_display.h"
+
+#define WIRE_FREQUENCY      100000.0  /* Wire's default */
+#define LCDI2C_TX_PER_BYTE  6         /* 3 transmissions per nibble: set up, EN high, EN low */
+#define LCDI2C_DELAY_US     51        /* pulseEnable(): 1us EN high, 50us after EN low */
+#define HD_EXEC_US          37        /* Most instructions and data writes */
+#define HD_CLEAR_US         1520
+
+/* Simulated clock, advanced by bus traffic and the driver's delays. Reading
+ * it costs a microsecond so the driver's wait loops make progress */
+static double nowUs = 0;
+
+uint32_t millis() { nowUs += 1; return (uint32_t)(nowUs / 1000.0); }
+uint32_t micros() { nowUs += 1; return (uint32_t)nowUs; }
+void delay(uint32_t ms) { nowUs += ms * 1000.0; }
+void delayMicroseconds(uint16_t us) { nowUs += us; }
+char *itoa(int value, char *buf, int radix) { (void)radix; sprintf(buf, "%d", value); return buf; }
+
+/*
+ * HD44780 behind a PCF8574
+ */
+struct hd44780 {
+  bool fourBit;
+  bool highNext;        /* 4-bit mode: next latch is the high nibble */
+  uint8_t partial;
+  uint8_t addr;
+  char ddram[128];
+  uint8_t pins;         /* Last PCF8574 output */
+  double busyUntil;
+  unsigned rsViolations;
+  unsigned holdViolations;
+  unsigned busyViolations;
+};
+
+static struct hd44780 hd;
+
+static void hd_reset()
+{
+  memset(&hd, 0, sizeof(hd));
+  memset(hd.ddram, ' ', sizeof(hd.ddram));
+}
+
+static void hd_execute(uint8_t value, bool data)
+{
+  double exec = HD_EXEC_US;
+
+  if (data)
+  {
+    hd.ddram[hd.addr] = (char)value;
+    /* Two line mode: 0x00-0x27 and 0x40-0x67 */
+    hd.addr = (hd.addr == 0x27) ? 0x40 : (hd.addr == 0x67) ? 0x00 : hd.addr + 1;
+  }
+  else if (value & 0x80)
+  {
+    hd.addr = value & 0x7F;
+  }
+  else if (value == 0x01)
+  {
+    memset(hd.ddram, ' ', sizeof(hd.ddram));
+    hd.addr = 0;
+    exec = HD_CLEAR_US;
+  }
+  else if ((value & 0xF0) == 0x20)
+  {
+    hd.fourBit = !(value & 0x10);
+  }
+  hd.busyUntil = nowUs + exec;
+}
+
+/* One byte written to the PCF8574, its outputs change at the ACK (nowUs) */
+static void hd_pins(uint8_t pins)
+{
+  uint8_t prev = hd.pins;
+  hd.pins = pins;
+
+  if (!(prev & PCF_EN) && (pins & PCF_EN) && ((prev ^ pins) & PCF_RS)) { hd.rsViolations++; }
+  if (!((prev & PCF_EN) && !(pins & PCF_EN))) { return; }
+
+  /* Falling edge: latch what was set up while EN was high */
+  if ((prev ^ pins) & 0xF1) { hd.holdViolations++; }
+  if (nowUs < hd.busyUntil) { hd.busyViolations++; }
+
+  uint8_t nibble = prev >> 4;
+  bool data = prev & PCF_RS;
+  if (!hd.fourBit)
+  {
+    hd_execute(nibble << 4, data);
+    hd.highNext = true;
+  }
+  else if (hd.highNext)
+  {
+    hd.partial = nibble << 4;
+    hd.highNext = false;
+  }
+  else
+  {
+    hd_execute(hd.partial | nibble, data);
+    hd.highNext = true;
+  }
+}
+
+static const uint8_t rowOffsets[LCD_ROWS] = { 0x00, 0x40, 0x14, 0x54 };
+
+static bool hd_row_matches(uint8_t row, const char *expected)
+{
+  return memcmp(&hd.ddram[rowOffsets[row]], expected, LCD_COLUMNS) == 0;
+}
+
+/*
+ * twi_master.cpp mock, every commit is one transaction put on the bus at once
+ */
+volatile struct twi_stats twiStats;
+
+static double busBitUs = 0;
+static uint8_t stage[TWI_QUEUE_SIZE];
+static uint8_t stageLen = 0;
+static uint8_t stageMax = 0;
+static unsigned transactions = 0;
+static unsigned busBytes = 0;     /* Address bytes included */
+static bool present = true;       /* false: the backpack NACKs its address */
+
+static void bus_send(const uint8_t *data, uint8_t len)
+{
+  transactions++;
+  busBytes += len + 1;
+  nowUs += busBitUs * 10;         /* START, SLA+W, ACK */
+  if (!present)
+  {
+    twiStats.nacks++;
+    nowUs += busBitUs;
+    return;
+  }
+  for (uint8_t x = 0; x < len; x++)
+  {
+    nowUs += busBitUs * 9;
+    hd_pins(data[x]);
+  }
+  nowUs += busBitUs;              /* STOP */
+}
+
+void twi_begin(uint8_t address, uint32_t frequency) { (void)address; busBitUs = 1e6 / frequency; }
+uint8_t twi_free() { return TWI_QUEUE_SIZE - 1; }
+bool twi_reserve(uint8_t len) { stageLen = 0; stageMax = len; return len < TWI_QUEUE_SIZE; }
+void twi_put(uint8_t data) { if (stageLen < stageMax) { stage[stageLen++] = data; } }
+void twi_commit() { bus_send(stage, stageLen); stageLen = 0; }
+bool twi_queue(const uint8_t *data, uint8_t len) { bus_send(data, len); return true; }
+bool twi_busy() { return false; }
+void twi_poll() {}
+bool twi_flush(uint16_t timeout_ms) { (void)timeout_ms; return true; }
+uint16_t twi_errors() { return twiStats.nacks + twiStats.bus_errors + twiStats.timeouts; }
+void twi_dump() {}
+
+/*
+ * Report
+ */
+struct scenario {
+  const char *name;
+  uint8_t row;
+  uint8_t col;
+  const char *text;
+};
+
+static const struct scenario scenarios[] = {
+  { "1 char",       1, 6,  "7" },
+  { "RPM field",    1, 6,  "2500" },
+  { "wheel name",   0, 6,  "60-2 Tooth W" },
+  { "full row",     3, 0,  "Ready   Max: 12345  " },
+};
+#define SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+/* LiquidCrystal_I2C: every PCF8574 byte is its own Wire transmission */
+static void lcdi2c_cost(unsigned chars, unsigned *bytes, double *us)
+{
+  unsigned tx = (chars + 1) * LCDI2C_TX_PER_BYTE; /* cursor move + characters */
+  double bitUs = 1e6 / WIRE_FREQUENCY;
+
+  *bytes = tx * 2;
+  *us = tx * (20 * bitUs) + (chars + 1) * 2 * LCDI2C_DELAY_US;
+}
+
+/* Unplug for unplugMs, then plug a power cycled display back in */
+static bool hotplug(TwiLcdDisplay *lcd, uint32_t unplugMs)
+{
+  const char *text = "Back again          ";
+  uint32_t probes[16];
+  unsigned count = 0;
+  bool ok = true;
+
+  present = false;
+  lcd->write(0, 2, "lost", 4);
+  lcd->poll();
+  if (lcd->isAvailable())
+  {
+    fprintf(stderr, "hot-plug: still online after a NACK\n");
+    return false;
+  }
+
+  /* 1ms per loop pass */
+  double start = nowUs;
+  while (nowUs - start < unplugMs * 1000.0)
+  {
+    unsigned before = transactions;
+    lcd->poll();
+    if (transactions != before && count < 16) { probes[count++] = (uint32_t)((nowUs - start) / 1000.0); }
+    nowUs += 1000;
+  }
+
+  printf("hot-plug: probes at");
+  for (unsigned x = 0; x < count; x++) { printf(" %ums", probes[x]); }
+  printf("\n");
+  for (unsigned x = 1; x < count; x++)
+  {
+    uint32_t gap = probes[x] - probes[x - 1];
+    uint32_t expect = LCD_REPROBE_MIN_MS << x;
+    if (expect > LCD_REPROBE_MAX_MS) { expect = LCD_REPROBE_MAX_MS; }
+    if (gap < expect || gap > expect + 2)
+    {
+      fprintf(stderr, "hot-plug: probe %u after %ums, expected %ums\n", x, gap, expect);
+      ok = false;
+    }
+  }
+
+  present = true;
+  hd_reset();
+  start = nowUs;
+  while (!lcd->isAvailable() && nowUs - start < (LCD_REPROBE_MAX_MS + 1000) * 1000.0)
+  {
+    lcd->poll();
+    nowUs += 100;
+  }
+  if (!lcd->isAvailable())
+  {
+    fprintf(stderr, "hot-plug: not back online after re-plugging\n");
+    return false;
+  }
+  printf("hot-plug: back online %.0fms after re-plugging\n", (nowUs - start) / 1000.0);
+
+  nowUs = hd.busyUntil;
+  lcd->write(0, 2, text, LCD_COLUMNS);
+  if (!hd_row_matches(2, text))
+  {
+    fprintf(stderr, "hot-plug: row 2 decoded as '%.20s' after re-init\n", &hd.ddram[rowOffsets[2]]);
+    ok = false;
+  }
+  return ok;
+}
+
+int main()
+{
+  TwiLcdDisplay lcd;
+  char expected[LCD_ROWS][LCD_COLUMNS];
+  bool ok = true;
+
+  hd_reset();
+  if (!lcd.init())
+  {
+    fprintf(stderr, "init failed\n");
+    return 1;
+  }
+  if (!hd.fourBit)
+  {
+    fprintf(stderr, "init left the HD44780 in 8-bit mode\n");
+    ok = false;
+  }
+  memset(expected, ' ', sizeof(expected));
+
+  printf("TWI driver at %.0fkHz vs LiquidCrystal_I2C on Wire at %.0fkHz\n", LCD_TWI_FREQUENCY / 1000.0, WIRE_FREQUENCY / 1000.0);
+  printf("update,chars,lcdi2c_bytes,lcdi2c_us,twi_bytes,twi_transactions,twi_us,byte_ratio,speedup\n");
+
+  for (unsigned s = 0; s < SCENARIOS; s++)
+  {
+    const struct scenario *sc = &scenarios[s];
+    uint8_t len = strlen(sc->text);
+    unsigned oldBytes;
+    double oldUs;
+
+    /* Leave the controller idle so only this update is timed */
+    nowUs = hd.busyUntil;
+    transactions = 0;
+    busBytes = 0;
+    double start = nowUs;
+
+    if (!lcd.canWrite(len))
+    {
+      fprintf(stderr, "%s: canWrite(%u) refused an empty queue\n", sc->name, len);
+      ok = false;
+      continue;
+    }
+    lcd.write(sc->col, sc->row, sc->text, len);
+    memcpy(&expected[sc->row][sc->col], sc->text, len);
+
+    double newUs = nowUs - start;
+    lcdi2c_cost(len, &oldBytes, &oldUs);
+    printf("%s,%u,%u,%.0f,%u,%u,%.0f,%.1f,%.1f\n", sc->name, len, oldBytes, oldUs, busBytes, transactions,
+      newUs, (double)oldBytes / busBytes, oldUs / newUs);
+
+    if (transactions != 1)
+    {
+      fprintf(stderr, "%s: took %u transactions\n", sc->name, transactions);
+      ok = false;
+    }
+  }
+
+  for (uint8_t row = 0; row < LCD_ROWS; row++)
+  {
+    if (!hd_row_matches(row, expected[row]))
+    {
+      fprintf(stderr, "row %u decoded as '%.20s', expected '%.20s'\n", row, &hd.ddram[rowOffsets[row]], expected[row]);
+      ok = false;
+    }
+  }
+  if (hd.rsViolations || hd.holdViolations || hd.busyViolations)
+  {
+    fprintf(stderr, "timing: %u RS set up, %u data hold, %u busy violations\n", hd.rsViolations, hd.holdViolations, hd.busyViolations);
+    ok = false;
+  }
+
+  if (!hotplug(&lcd, 20000)) { ok = false; }
+  if (hd.rsViolations || hd.holdViolations || hd.busyViolations)
+  {
+    fprintf(stderr, "hot-plug timing: %u RS set up, %u data hold, %u busy violations\n", hd.rsViolations, hd.holdViolations, hd.busyViolations);
+    ok = false;
+  }
+
+  printf("verify: %s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
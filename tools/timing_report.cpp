@@ -0,0 +1,309 @@
+/* vim: set syntax=c expandtab sw=2 softtabstop=2 autoindent smartindent smarttab : */
+/*
+ * RPM quantization report
+ *
+ * Replays the firmware's reset_new_OCR1A()/get_prescaler_bits() arithmetic
+ * (timer_math.h) for every wheel in Wheels[] across an RPM range and reports
+ * the RPM the Timer1 compare value actually produces, its error in ppm, the
+ * prescaler chosen and the tooth period resolution. A per wheel worst case
+ * summary shows which patterns hold a speed tolerance before flashing.
+ *
+ * Two "what if" columns show how much better the timer could do:
+ *   ppm_fixed  - scaler derived from the edge count, compare value rounded
+ *                rather than truncated and the CTC "+1 tick" accounted for
+ *   ppm_dither - ppm_fixed plus 8 bit fractional dithering of OCR1A
+ *
+ * isr_max_rpm is the firmware's own per wheel limit (max_rpm_for_isr_cycles())
+ * for an ISR cost given with --isr-cycles, e.g. as reported by serial 'i'.
+ *
+ * RPMs below TIMER1_MIN_RPM are floored by the firmware on purpose, they're
+ * flagged as clamped in the table and left out of the summary.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++11 -O2 -Itools/host -Iardustim tools/timing_report.cpp -o timing_report
+ *   ./timing_report --csv --step 100 > timing.csv
+ *   ./timing_report --json --summary
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "globals.h"
+#include "enums.h"
+#include "timer_math.h"
+#include "wheel_defs.h"
+#include "wheel_table.h"
+
+#define CPU_HZ 16000000.0
+
+enum { FORMAT_CSV, FORMAT_JSON };
+
+struct options {
+  int format;
+  uint32_t from;
+  uint32_t to;
+  uint32_t step;
+  double tol_ppm;
+  bool summary_only;
+  uint16_t isr_cycles;
+};
+
+struct sample {
+  uint32_t rpm;
+  bool clamped;           /* below TIMER1_MIN_RPM, the firmware floors it */
+  uint32_t ticks;         /* rpm_to_timer_ticks() result, prescaler 1 */
+  uint8_t prescaler;      /* PRESCALE_x enum */
+  uint8_t bitshift;
+  uint32_t ocr;           /* compare value before the uint16_t cast */
+  bool ocr_overflow;      /* ocr didn't fit in OCR1A */
+  double achieved_rpm;
+  double ppm;
+  double tick_us;         /* one timer count at the chosen prescaler */
+  double step_ppm;        /* RPM change caused by one count of OCR1A */
+  double ppm_fixed;
+  double ppm_dither;
+};
+
+struct summary {
+  double worst_ppm;
+  uint32_t worst_rpm;
+  uint8_t worst_prescaler;
+  uint32_t max_rpm_in_tol;  /* highest RPM up to which every RPM meets tol */
+  bool in_tol_so_far;
+  double worst_fixed_ppm;
+  double worst_dither_ppm;
+};
+
+static const uint16_t prescaler_divisor[] = { 0, 1, 8, 64, 256, 1024 };
+
+/* Edges the ISR walks per crank revolution, it wraps at wheel_max_edges */
+static double edges_per_rev(const wheels *w)
+{
+  return (double)w->wheel_max_edges * 360.0 / (double)w->wheel_degrees;
+}
+
+static double rpm_from_period(const wheels *w, double period_cycles)
+{
+  return (CPU_HZ * 60.0) / (period_cycles * edges_per_rev(w));
+}
+
+static double ppm_error(double achieved, uint32_t rpm)
+{
+  return (achieved - (double)rpm) / (double)rpm * 1e6;
+}
+
+static void evaluate(const wheels *w, uint32_t rpm, struct sample *s)
+{
+  uint32_t tmp;
+  uint8_t prescaler;
+  uint8_t bitshift;
+
+  /* Same steps as reset_new_OCR1A() */
+  tmp = rpm_to_timer_ticks(w->rpm_scaler, rpm);
+  s->ticks = tmp;
+  get_prescaler_bits(&tmp, &prescaler, &bitshift);
+  s->prescaler = prescaler;
+  s->bitshift = bitshift;
+  s->ocr = tmp >> bitshift;
+  s->ocr_overflow = (s->ocr > 0xFFFF);
+
+  /* CTC mode: the period is OCR1A + 1 timer counts */
+  uint16_t ocr1a = (uint16_t)s->ocr;
+  double period = (double)((uint32_t)ocr1a + 1) * (double)(1UL << bitshift);
+  s->rpm = rpm;
+  s->clamped = (rpm < TIMER1_MIN_RPM);
+  s->achieved_rpm = rpm_from_period(w, period);
+  s->ppm = ppm_error(s->achieved_rpm, rpm);
+  s->tick_us = (double)(1UL << bitshift) / (CPU_HZ / 1e6);
+  s->step_ppm = 1e6 / ((double)ocr1a + 1.0);
+
+  /* What if: exact period from the edge count, rounded, CTC corrected */
+  double ideal = (CPU_HZ * 60.0) / ((double)rpm * edges_per_rev(w));
+  uint32_t ideal_ticks = (ideal > 4294967295.0) ? 0xFFFFFFFFUL : (uint32_t)ideal;
+  get_prescaler_bits(&ideal_ticks, &prescaler, &bitshift);
+  double counts = ideal / (double)(1UL << bitshift);
+  if (counts > 65536.0) { counts = 65536.0; } /* Slowest the timer can go */
+  double fixed_counts = floor(counts + 0.5);
+  if (fixed_counts < 1.0) { fixed_counts = 1.0; }
+  s->ppm_fixed = ppm_error(rpm_from_period(w, fixed_counts * (1UL << bitshift)), rpm);
+  double dither_counts = floor(counts * 256.0 + 0.5) / 256.0;
+  if (dither_counts < 1.0) { dither_counts = 1.0; }
+  s->ppm_dither = ppm_error(rpm_from_period(w, dither_counts * (1UL << bitshift)), rpm);
+}
+
+static void usage(const char *prog)
+{
+  fprintf(stderr,
+    "usage: %s [--csv|--json] [--from RPM] [--to RPM] [--step RPM]\n"
+    "          [--tol-ppm PPM] [--isr-cycles N] [--summary]\n"
+    "  --from/--to  RPM range, default 1-20000\n"
+    "  --step       RPM step of the emitted table, default 100 (the summary\n"
+    "               always covers every RPM in the range)\n"
+    "  --tol-ppm    speed tolerance for the summary, default 1000 (0.1%%)\n"
+    "  --isr-cycles pattern ISR cost for isr_max_rpm, default %u\n"
+    "  --summary    only emit the per wheel summary\n", prog, ISR_CYCLES_ESTIMATE);
+}
+
+static bool parse_args(int argc, char **argv, struct options *opt)
+{
+  opt->format = FORMAT_CSV;
+  opt->from = 1;
+  opt->to = 20000;
+  opt->step = 100;
+  opt->tol_ppm = 1000.0;
+  opt->summary_only = false;
+  opt->isr_cycles = ISR_CYCLES_ESTIMATE;
+
+  for (int i = 1; i < argc; i++)
+  {
+    const char *a = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (!strcmp(a, "--csv")) { opt->format = FORMAT_CSV; }
+    else if (!strcmp(a, "--json")) { opt->format = FORMAT_JSON; }
+    else if (!strcmp(a, "--summary")) { opt->summary_only = true; }
+    else if (!strcmp(a, "--from") && has_value) { opt->from = strtoul(argv[++i], NULL, 10); }
+    else if (!strcmp(a, "--to") && has_value) { opt->to = strtoul(argv[++i], NULL, 10); }
+    else if (!strcmp(a, "--step") && has_value) { opt->step = strtoul(argv[++i], NULL, 10); }
+    else if (!strcmp(a, "--tol-ppm") && has_value) { opt->tol_ppm = strtod(argv[++i], NULL); }
+    else if (!strcmp(a, "--isr-cycles") && has_value) { opt->isr_cycles = (uint16_t)strtoul(argv[++i], NULL, 10); }
+    else { return false; }
+  }
+  if (opt->from < 1) { opt->from = 1; }
+  if (opt->step < 1) { opt->step = 1; }
+  if (opt->isr_cycles < 1) { opt->isr_cycles = 1; }
+  return (opt->from <= opt->to);
+}
+
+static void print_row(const struct options *opt, uint8_t wheel, const char *name, const struct sample *s, bool first)
+{
+  if (opt->format == FORMAT_CSV)
+  {
+    printf("%u,\"%s\",%u,%u,%.3f,%.1f,%u,%u,%u,%.4f,%.1f,%.1f,%.1f\n",
+      wheel, name, s->rpm, s->clamped ? 1 : 0, s->achieved_rpm, s->ppm, prescaler_divisor[s->prescaler],
+      (unsigned)(uint16_t)s->ocr, s->ocr_overflow ? 1 : 0, s->tick_us, s->step_ppm,
+      s->ppm_fixed, s->ppm_dither);
+  }
+  else
+  {
+    printf("%s\n    {\"wheel\":%u,\"name\":\"%s\",\"rpm\":%u,\"clamped\":%s,\"achieved_rpm\":%.3f,\"ppm\":%.1f,"
+      "\"prescaler\":%u,\"ocr1a\":%u,\"ocr_overflow\":%s,\"tick_us\":%.4f,\"step_ppm\":%.1f,"
+      "\"ppm_fixed\":%.1f,\"ppm_dither\":%.1f}",
+      first ? "" : ",", wheel, name, s->rpm, s->clamped ? "true" : "false", s->achieved_rpm, s->ppm,
+      prescaler_divisor[s->prescaler], (unsigned)(uint16_t)s->ocr,
+      s->ocr_overflow ? "true" : "false", s->tick_us, s->step_ppm, s->ppm_fixed, s->ppm_dither);
+  }
+}
+
+static void print_summary(const struct options *opt, uint8_t wheel, const char *name, const wheels *w, const struct summary *sum, bool first)
+{
+  bool pass = fabs(sum->worst_ppm) <= opt->tol_ppm;
+  double geom_scaler = edges_per_rev(w) / 120.0;
+  uint16_t isr_max_rpm = max_rpm_for_isr_cycles(w->rpm_scaler, opt->isr_cycles);
+
+  if (opt->format == FORMAT_CSV)
+  {
+    printf("%u,\"%s\",%u,%u,%.5f,%.5f,%.1f,%u,%u,%u,%s,%.1f,%.1f,%u\n",
+      wheel, name, w->wheel_max_edges, w->wheel_degrees, w->rpm_scaler, geom_scaler,
+      sum->worst_ppm, sum->worst_rpm, prescaler_divisor[sum->worst_prescaler],
+      sum->max_rpm_in_tol, pass ? "PASS" : "FAIL", sum->worst_fixed_ppm, sum->worst_dither_ppm,
+      isr_max_rpm);
+  }
+  else
+  {
+    printf("%s\n    {\"wheel\":%u,\"name\":\"%s\",\"edges\":%u,\"degrees\":%u,\"rpm_scaler\":%.5f,"
+      "\"geometric_scaler\":%.5f,\"worst_ppm\":%.1f,\"worst_rpm\":%u,\"worst_prescaler\":%u,"
+      "\"max_rpm_in_tol\":%u,\"pass\":%s,\"worst_ppm_fixed\":%.1f,\"worst_ppm_dither\":%.1f,\"isr_max_rpm\":%u}",
+      first ? "" : ",", wheel, name, w->wheel_max_edges, w->wheel_degrees, w->rpm_scaler,
+      geom_scaler, sum->worst_ppm, sum->worst_rpm, prescaler_divisor[sum->worst_prescaler],
+      sum->max_rpm_in_tol, pass ? "true" : "false", sum->worst_fixed_ppm, sum->worst_dither_ppm,
+      isr_max_rpm);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  struct options opt;
+  static struct summary sums[MAX_WHEELS];
+  char name[64];
+
+  if (!parse_args(argc, argv, &opt))
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  if (opt.format == FORMAT_JSON)
+  {
+    printf("{\n  \"tol_ppm\":%.1f,\"from\":%u,\"to\":%u,\"step\":%u,\"isr_cycles\":%u,", opt.tol_ppm, opt.from, opt.to, opt.step, opt.isr_cycles);
+    if (!opt.summary_only) { printf("\n  \"rows\":["); }
+  }
+  else if (!opt.summary_only)
+  {
+    printf("wheel,name,rpm,clamped,achieved_rpm,ppm,prescaler,ocr1a,ocr_overflow,tick_us,step_ppm,ppm_fixed,ppm_dither\n");
+  }
+
+  bool first_row = true;
+  for (uint8_t x = 0; x < MAX_WHEELS; x++)
+  {
+    const wheels *w = &Wheels[x];
+    struct summary *sum = &sums[x];
+    memset(sum, 0, sizeof(*sum));
+    sum->in_tol_so_far = true;
+    if (w->edge_states_ptr == NULL) { continue; } /* Hole in the table */
+
+    strncpy_P(name, w->decoder_name, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+
+    for (uint32_t rpm = opt.from; rpm <= opt.to; rpm++)
+    {
+      struct sample s;
+      evaluate(w, rpm, &s);
+
+      if (s.clamped) { /* Not a quantization error, skip it in the summary */ }
+      else if (fabs(s.ppm) > fabs(sum->worst_ppm) || sum->worst_rpm == 0)
+      {
+        sum->worst_ppm = s.ppm;
+        sum->worst_rpm = rpm;
+        sum->worst_prescaler = s.prescaler;
+      }
+      if (!s.clamped && fabs(s.ppm_fixed) > fabs(sum->worst_fixed_ppm)) { sum->worst_fixed_ppm = s.ppm_fixed; }
+      if (!s.clamped && fabs(s.ppm_dither) > fabs(sum->worst_dither_ppm)) { sum->worst_dither_ppm = s.ppm_dither; }
+      if (!s.clamped && sum->in_tol_so_far)
+      {
+        if (fabs(s.ppm) <= opt.tol_ppm) { sum->max_rpm_in_tol = rpm; }
+        else { sum->in_tol_so_far = false; }
+      }
+
+      if (!opt.summary_only && ((rpm - opt.from) % opt.step == 0 || rpm == opt.to))
+      {
+        print_row(&opt, x, name, &s, first_row);
+        first_row = false;
+      }
+    }
+  }
+
+  if (opt.format == FORMAT_JSON)
+  {
+    if (!opt.summary_only) { printf("\n  ],"); }
+    printf("\n  \"summary\":[");
+  }
+  else
+  {
+    if (!opt.summary_only) { printf("\n"); }
+    printf("wheel,name,edges,degrees,rpm_scaler,geometric_scaler,worst_ppm,worst_rpm,worst_prescaler,max_rpm_in_tol,result,worst_ppm_fixed,worst_ppm_dither,isr_max_rpm\n");
+  }
+
+  bool first_sum = true;
+  for (uint8_t x = 0; x < MAX_WHEELS; x++)
+  {
+    if (Wheels[x].edge_states_ptr == NULL) { continue; }
+    strncpy_P(name, Wheels[x].decoder_name, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    print_summary(&opt, x, name, &Wheels[x], &sums[x], first_sum);
+    first_sum = false;
+  }
+
+  if (opt.format == FORMAT_JSON) { printf("\n  ]\n}\n"); }
+  return 0;
+}